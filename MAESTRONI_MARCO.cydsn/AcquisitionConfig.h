@@ -0,0 +1,322 @@
+/**
+*   \file AcquisitionConfig.h
+*   \brief Compile-time configuration of the acquisition firmware.
+*
+*   Every option can be overridden from the compiler command line.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __ACQUISITION_CONFIG_H
+    #define __ACQUISITION_CONFIG_H
+
+    /**
+    *   \brief The main loop polls STATUS_REG until a new sample is flagged.
+    */
+    #define ACQ_MODE_POLLING        0
+
+    /**
+    *   \brief The main loop sleeps until the LIS3DH data-ready signal (INT1).
+    *
+    *   Requires INT1 of the LIS3DH wired to a digital input pin connected to
+    *   an isr component named isr_DataReady (rising edge) in TopDesign.
+    */
+    #define ACQ_MODE_DATA_READY     1
+
+    /**
+    *   \brief The LIS3DH buffers samples in its FIFO (stream mode) and the
+    *   main loop drains them in one burst when the watermark raises INT1.
+    *
+    *   Uses the same INT1 pin and isr_DataReady component as
+    *   ACQ_MODE_DATA_READY.
+    */
+    #define ACQ_MODE_FIFO           2
+
+    /**
+    *   \brief Selected acquisition mode.
+    */
+    #ifndef ACQ_MODE
+        #define ACQ_MODE ACQ_MODE_POLLING
+    #endif
+
+    /**
+    *   \brief Duty-cycled acquisition for battery operation.
+    *
+    *   Between the INT1 interrupts the CPU sleeps with the millisecond
+    *   tick stopped (Power.h), so that it only wakes up for the samples,
+    *   the push button and the periodic frames; the LIS3DH runs in
+    *   low-power mode where ACQ_LOW_POWER_PRECISION_MG allows. Requires
+    *   ACQ_MODE_DATA_READY or ACQ_MODE_FIFO.
+    */
+    #ifndef ACQ_LOW_POWER
+        #define ACQ_LOW_POWER 0
+    #endif
+
+    /**
+    *   \brief Coarsest resolution (mg/digit) the application accepts.
+    *
+    *   With ACQ_LOW_POWER the LIS3DH is set to low-power (8-bit) mode if
+    *   its low-power sensitivity at ACQ_FULL_SCALE_G is not coarser:
+    *   16 mg/digit allows it at +-2 g only.
+    */
+    #ifndef ACQ_LOW_POWER_PRECISION_MG
+        #define ACQ_LOW_POWER_PRECISION_MG 16
+    #endif
+
+    /**
+    *   \brief Longest sleep (ms) with ACQ_LOW_POWER, so that the periodic
+    *   tasks (health frames) still run at the lowest data rates.
+    */
+    #ifndef ACQ_LOW_POWER_MAX_SLEEP_MS
+        #define ACQ_LOW_POWER_MAX_SLEEP_MS 1000
+    #endif
+
+    /**
+    *   \brief FIFO watermark (1 ... 31 samples) used by ACQ_MODE_FIFO.
+    */
+    #ifndef ACQ_FIFO_WATERMARK
+        #define ACQ_FIFO_WATERMARK 16
+    #endif
+
+    /**
+    *   \brief Read the next sample with the interrupt-driven I2C transfer
+    *   while the previous one is converted and sent over UART.
+    *
+    *   Used by ACQ_MODE_POLLING and ACQ_MODE_DATA_READY.
+    */
+    #ifndef ACQ_I2C_ASYNC
+        #define ACQ_I2C_ASYNC 0
+    #endif
+
+    /**
+    *   \brief I2C bus speed profile in kHz (100 or 400).
+    *
+    *   It must match the Data rate of the I2C_Master component in TopDesign.
+    */
+    #ifndef ACQ_I2C_SPEED_KHZ
+        #define ACQ_I2C_SPEED_KHZ 100
+    #endif
+
+    /**
+    *   \brief UART_Debug baud rate, as set in TopDesign.
+    */
+    #ifndef ACQ_UART_BAUD_RATE
+        #define ACQ_UART_BAUD_RATE 38400
+    #endif
+
+    /**
+    *   \brief Send the frames with a DMA channel feeding the UART_Debug TX
+    *   FIFO instead of copying them with UART_Debug_PutArray.
+    *
+    *   Requires in TopDesign a DMA component named DMA_UartTx (1 byte per
+    *   burst, hardware request on level) with its drq input connected to
+    *   the tx_interrupt output of UART_Debug (interrupt on "TX FIFO not
+    *   full", TX buffer size 4) and its nrq output connected to an isr
+    *   component named isr_UartTxDone.
+    */
+    #ifndef ACQ_UART_DMA
+        #define ACQ_UART_DMA 0
+    #endif
+
+    /**
+    *   \brief Pre-allocated frames of the UART transmit ring (2 ... 32).
+    */
+    #ifndef ACQ_UART_TX_FRAMES
+        #define ACQ_UART_TX_FRAMES 8
+    #endif
+
+    /**
+    *   \brief 8-byte frame: 0xA0, X, Y, Z in m/s^2 x 1000 (int16), 0xC0.
+    */
+    #define ACQ_PACKET_FORMAT_V1    1
+
+    /**
+    *   \brief 12-byte frame with sequence number, timestamp, raw 12-bit
+    *   outputs, ODR code and CRC-8 (Packet.h).
+    */
+    #define ACQ_PACKET_FORMAT_V2    2
+
+    /**
+    *   \brief ACQ_PACKET_BATCH_SIZE samples per frame, with one header,
+    *   count and CRC-8 (Packet.h).
+    */
+    #define ACQ_PACKET_FORMAT_BATCH 3
+
+    /**
+    *   \brief Batch frames of the output words as read, with no shift and
+    *   no packing, and a descriptor frame of the range and sensitivity at
+    *   every data rate change and every ACQ_DESCRIPTOR_PERIOD_MS (Packet.h).
+    *
+    *   The conversion is left to the host decoder, which keeps the full
+    *   words; 6 bytes per sample instead of 4.5, decoded by the host tools
+    *   only.
+    */
+    #define ACQ_PACKET_FORMAT_RAW   4
+
+    /**
+    *   \brief Selected frame format.
+    *
+    *   Each format but ACQ_PACKET_FORMAT_RAW has its own Bridge Control
+    *   Panel configuration in BRIDGE_CONTROL_PANEL_CONFIG_FILES.
+    */
+    #ifndef ACQ_PACKET_FORMAT
+        #define ACQ_PACKET_FORMAT ACQ_PACKET_FORMAT_V2
+    #endif
+
+    /**
+    *   \brief The frames are sent as they are built: the receiver finds
+    *   them by their first byte (and last byte in version 1).
+    */
+    #define ACQ_FRAMING_NONE        0
+
+    /**
+    *   \brief The frames are COBS-encoded and delimited by 0x00 (Cobs.h),
+    *   so that the receiver resynchronises at the next frame after a
+    *   lost or corrupted byte, whatever bytes the payloads hold.
+    *
+    *   Decoded by the host tools only (PacketDecode --cobs, PacketRecord
+    *   --cobs), not by the Bridge Control Panel.
+    */
+    #define ACQ_FRAMING_COBS        1
+
+    /**
+    *   \brief Selected framing of the frames on the UART.
+    */
+    #ifndef ACQ_FRAMING
+        #define ACQ_FRAMING ACQ_FRAMING_NONE
+    #endif
+
+    /**
+    *   \brief Samples per frame (1 ... 32) in ACQ_PACKET_FORMAT_BATCH and
+    *   ACQ_PACKET_FORMAT_RAW.
+    *
+    *   Matched to the FIFO watermark by default, so that a FIFO drain
+    *   is sent as one frame. Without ACQ_UART_DMA, in ACQ_MODE_POLLING and
+    *   ACQ_MODE_DATA_READY, the batches are made shorter so that a frame
+    *   is sent within one sample period at ACQ_UART_BAUD_RATE: sending
+    *   blocks the loop, and the samples it misses are lost.
+    */
+    #ifndef ACQ_PACKET_BATCH_SIZE
+        #define ACQ_PACKET_BATCH_SIZE ACQ_FIFO_WATERMARK
+    #endif
+
+    /**
+    *   \brief Longest time (ms) spanned by the samples of a batch.
+    *
+    *   At low data rates the batches are shorter, so that the samples
+    *   are not delayed by seconds.
+    */
+    #ifndef ACQ_PACKET_BATCH_MAX_MS
+        #define ACQ_PACKET_BATCH_MAX_MS 100
+    #endif
+
+    /**
+    *   \brief Period (ms) of the descriptor frames in ACQ_PACKET_FORMAT_RAW,
+    *   so that a receiver started during the acquisition can convert the
+    *   samples; one is also sent at every data rate change.
+    */
+    #ifndef ACQ_DESCRIPTOR_PERIOD_MS
+        #define ACQ_DESCRIPTOR_PERIOD_MS 1000
+    #endif
+
+    /**
+    *   \brief Full-scale range in g (2, 4, 8 or 16).
+    *
+    *   Only ACQ_PACKET_FORMAT_RAW tells the receiver the range: the other
+    *   formats are scaled for +-2 g, and the version 1 frames saturate
+    *   above it.
+    */
+    #ifndef ACQ_FULL_SCALE_G
+        #define ACQ_FULL_SCALE_G 2
+    #endif
+
+    /**
+    *   \brief Use the high-resolution (12-bit) mode at the rates that are
+    *   not low-power only; 0 selects the normal (10-bit) mode.
+    */
+    #ifndef ACQ_HIGH_RESOLUTION
+        #define ACQ_HIGH_RESOLUTION 1
+    #endif
+
+    /**
+    *   \brief Highest data rate (Hz) selectable with the push button.
+    */
+    #ifndef ACQ_ODR_MAX_HZ
+        #define ACQ_ODR_MAX_HZ 200
+    #endif
+
+    /**
+    *   \brief Time (ms) the push button must read released for a press
+    *   to end: the bounces of the contacts in between are ignored.
+    */
+    #ifndef ACQ_BUTTON_DEBOUNCE_MS
+        #define ACQ_BUTTON_DEBOUNCE_MS 20
+    #endif
+
+    /**
+    *   \brief Time (ms) the push button must be held for a long press,
+    *   which steps back to the previous data rate.
+    */
+    #ifndef ACQ_BUTTON_LONG_PRESS_MS
+        #define ACQ_BUTTON_LONG_PRESS_MS 800
+    #endif
+
+    /**
+    *   \brief Report achieved samples/s and I2C bus utilisation over UART
+    *   once per second instead of running silently.
+    */
+    #ifndef ACQ_BENCHMARK
+        #define ACQ_BENCHMARK 0
+    #endif
+
+    /**
+    *   \brief Period (ms) of the health frames carrying the overrun and
+    *   stale read counters (Health.h); 0 sends none.
+    *
+    *   Without ACQ_UART_DMA, and out of ACQ_MODE_FIFO, the frames are
+    *   deferred at the data rates where one does not go out within a
+    *   sample period: 100 Hz and above at 38400 baud.
+    */
+    #ifndef ACQ_HEALTH_PERIOD_MS
+        #define ACQ_HEALTH_PERIOD_MS 1000
+    #endif
+
+    /**
+    *   \brief Time the stages of the main loop with the CPU cycle counter
+    *   and send their minimum, average and maximum in a profile frame
+    *   (Profile.h).
+    *
+    *   When set to 0 the profiling macros expand to nothing.
+    */
+    #ifndef ACQ_PROFILE
+        #define ACQ_PROFILE 0
+    #endif
+
+    /**
+    *   \brief Period (ms) of the profile frames sent with ACQ_PROFILE.
+    */
+    #ifndef ACQ_PROFILE_PERIOD_MS
+        #define ACQ_PROFILE_PERIOD_MS 1000
+    #endif
+
+    /**
+    *   \brief Enable the accounting of I2C transactions.
+    *
+    *   When set to 0 the record macro of I2C_BusStats.h expands to nothing,
+    *   so that the interface functions do not pay for the counters.
+    */
+    #ifndef I2C_BUS_STATS_ENABLED
+        #define I2C_BUS_STATS_ENABLED ACQ_BENCHMARK
+    #endif
+
+    #if ACQ_LOW_POWER && ACQ_MODE == ACQ_MODE_POLLING
+        #error "ACQ_LOW_POWER requires ACQ_MODE_DATA_READY or ACQ_MODE_FIFO"
+    #endif
+
+    #if (ACQ_PACKET_FORMAT == ACQ_PACKET_FORMAT_V2 || ACQ_PACKET_FORMAT == ACQ_PACKET_FORMAT_BATCH) && \
+        ACQ_FULL_SCALE_G != 2
+        #error "The version 2 and batch frames carry no range: use ACQ_PACKET_FORMAT_RAW above +-2 g"
+    #endif
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,87 @@
+/*
+* MARCO MAESTRONI
+*
+* Acquisition throughput benchmark
+*/
+
+#include "Benchmark.h"
+#include "I2C_BusStats.h"
+#include "Transmit.h"
+#include "UartTx.h"
+#include "Timebase.h"
+#include "stdio.h"
+
+#define BENCHMARK_WINDOW_MS 1000
+
+#define FIRST_SAMPLE_WAITING  0
+#define FIRST_SAMPLE_MEASURED 1
+#define FIRST_SAMPLE_REPORTED 2
+
+static uint32_t window_start;
+static uint32_t samples;
+
+// Boot time to the first sample sent, reported once
+static uint32_t first_sample_ms;
+static uint8_t first_sample_state;
+
+void Benchmark_Start(void)
+{
+    window_start = Timebase_GetMs();
+    samples = 0;
+    I2C_BusStats_Reset();
+    Transmit_ResetStats();
+}
+
+void Benchmark_SamplesSent(uint8_t count)
+{
+    samples += count;
+    if (count && first_sample_state == FIRST_SAMPLE_WAITING)
+    {
+        first_sample_ms = Timebase_GetMs();
+        first_sample_state = FIRST_SAMPLE_MEASURED;
+    }
+}
+
+void Benchmark_Task(void)
+{
+    char message[128];
+    I2C_BusStats stats;
+    Transmit_Stats transmit;
+    uint32_t elapsed = Timebase_GetMs() - window_start;
+
+    if (first_sample_state == FIRST_SAMPLE_MEASURED)
+    {
+        sprintf(message, "BOOT first sample %lu ms after startup\r\n",
+                (unsigned long)first_sample_ms);
+        UartTx_PutString(message);
+        first_sample_state = FIRST_SAMPLE_REPORTED;
+    }
+
+    if (elapsed < BENCHMARK_WINDOW_MS)
+    {
+        return;
+    }
+
+    I2C_BusStats_Get(&stats);
+    Transmit_GetStats(&transmit);
+    // Bus utilisation in tenths of percent: cycles / (kHz * ms) * 1000
+    uint32_t utilisation = I2C_BusStats_Cycles(&stats) /
+                           ((uint32_t)ACQ_I2C_SPEED_KHZ * elapsed / 1000);
+    // CPU time spent framing and queueing the samples, in tenths of percent
+    uint32_t transmit_load = transmit.cycles / (Timebase_CyclesPerMs() * elapsed / 1000);
+
+    sprintf(message, "BENCH %lu samples/s, UART %lu B/s (%lu payload), TX CPU %lu.%lu%%, I2C %lu.%lu%% at %d kHz\r\n",
+            (unsigned long)(samples * 1000 / elapsed),
+            (unsigned long)(transmit.bytes * 1000 / elapsed),
+            (unsigned long)(transmit.samples * TRANSMIT_PAYLOAD_NIBBLES * 500 / elapsed),
+            (unsigned long)(transmit_load / 10),
+            (unsigned long)(transmit_load % 10),
+            (unsigned long)(utilisation / 10),
+            (unsigned long)(utilisation % 10),
+            ACQ_I2C_SPEED_KHZ);
+    UartTx_PutString(message);
+
+    Benchmark_Start();
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,40 @@
+/**
+*   \file Benchmark.h
+*   \brief Acquisition throughput benchmark.
+*
+*   When ACQ_BENCHMARK is enabled the achieved samples/s, the UART bytes/s
+*   (all and sample payload only), the CPU time spent in the transmit
+*   path and the I2C bus utilisation are reported over UART once per
+*   second. The time from
+*   startup (Timebase_Start) to the first sample sent is reported once.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __BENCHMARK_H
+    #define __BENCHMARK_H
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief Reset the counters and start a new measurement window.
+    */
+    void Benchmark_Start(void);
+
+    /**
+    *   \brief Account samples sent over UART.
+    *
+    *   The first call with count > 0 also time-stamps the first sample.
+    *   \param count Number of samples.
+    */
+    void Benchmark_SamplesSent(uint8_t count);
+
+    /**
+    *   \brief Report the last window once it is one second old.
+    *
+    *   To be called at every main loop pass.
+    */
+    void Benchmark_Task(void);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,121 @@
+/*
+* MARCO MAESTRONI
+*
+* Debounced push button events, from the interrupts to the main loop
+*/
+
+#include "Button.h"
+#include "AcquisitionConfig.h"
+#include "Timebase.h"
+#include "Hal.h"
+
+static volatile uint8_t queue[BUTTON_QUEUE_LENGTH];
+// Written by the tick interrupt only
+static volatile uint8_t head;
+// Written by the main loop only
+static volatile uint8_t tail;
+static volatile uint32_t dropped;
+
+// Set by the edge interrupt, taken by the tick interrupt
+static volatile uint8_t edge;
+// Set while a press is being debounced
+static volatile uint8_t tracking;
+
+// Only used in the tick interrupt
+static uint32_t press_ms;
+static uint32_t released_ms;
+static uint8_t pressed_seen;
+static uint8_t long_sent;
+
+static void Button_Push(Button_Event event)
+{
+    uint8_t next = (uint8_t)((head + 1) & (BUTTON_QUEUE_LENGTH - 1));
+
+    if (next == tail)
+    {
+        dropped++;
+        return;
+    }
+    // The slot is written before the head moves past it
+    queue[head] = (uint8_t)event;
+    head = next;
+}
+
+static void Button_Edge(void)
+{
+    edge = 1;
+}
+
+static void Button_Tick(void)
+{
+    if (edge)
+    {
+        edge = 0;
+        // The bounces of a press being debounced are ignored
+        if (!tracking)
+        {
+            tracking = 1;
+            press_ms = 0;
+            released_ms = 0;
+            pressed_seen = 0;
+            long_sent = 0;
+        }
+    }
+    if (!tracking)
+    {
+        return;
+    }
+
+    press_ms++;
+    if (Hal_ButtonPressed())
+    {
+        released_ms = 0;
+        pressed_seen = 1;
+        if (!long_sent && press_ms >= ACQ_BUTTON_LONG_PRESS_MS)
+        {
+            Button_Push(BUTTON_EVENT_LONG_PRESS);
+            long_sent = 1;
+        }
+    }
+    else if (++released_ms >= ACQ_BUTTON_DEBOUNCE_MS)
+    {
+        // A glitch never read as pressed is not a press
+        if (pressed_seen && !long_sent)
+        {
+            Button_Push(BUTTON_EVENT_PRESS);
+        }
+        tracking = 0;
+    }
+}
+
+void Button_Start(void)
+{
+    Timebase_SetTickHandler(Button_Tick);
+    Hal_ButtonStart(Button_Edge);
+}
+
+Button_Event Button_GetEvent(void)
+{
+    Button_Event event;
+
+    if (tail == head)
+    {
+        return BUTTON_EVENT_NONE;
+    }
+    event = (Button_Event)queue[tail];
+    // The slot is read before it is given back to the producer
+    tail = (uint8_t)((tail + 1) & (BUTTON_QUEUE_LENGTH - 1));
+    return event;
+}
+
+uint8_t Button_Busy(void)
+{
+    return edge || tracking;
+}
+
+uint32_t Button_Dropped(void)
+{
+    return dropped;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,69 @@
+/**
+*   \file Button.h
+*   \brief Debounced push button events.
+*
+*   The edge interrupt of the push button only flags that the button
+*   moved and wakes up the core. From the next millisecond tick the pin is
+*   sampled in the tick interrupt: the press ends once the pin has been
+*   released for ACQ_BUTTON_DEBOUNCE_MS, so the bounces of the contacts
+*   are not counted as presses. A press held for ACQ_BUTTON_LONG_PRESS_MS
+*   is reported as a long press as soon as that time is reached, and not
+*   again when released.
+*
+*   The events go through a single-producer, single-consumer ring: only
+*   the tick interrupt writes the head, only the main loop (Button_GetEvent)
+*   writes the tail, so neither side has to mask the interrupts. If the
+*   main loop falls BUTTON_QUEUE_LENGTH - 1 events behind, the newest
+*   events are dropped.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __BUTTON_H
+    #define __BUTTON_H
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief Slots of the event ring (a power of 2), one always empty.
+    */
+    #define BUTTON_QUEUE_LENGTH 8
+
+    /**
+    *   \brief Events of the push button.
+    */
+    typedef enum {
+        BUTTON_EVENT_NONE,          ///< No event in the ring
+        BUTTON_EVENT_PRESS,         ///< Pressed and released within ACQ_BUTTON_LONG_PRESS_MS
+        BUTTON_EVENT_LONG_PRESS     ///< Held for ACQ_BUTTON_LONG_PRESS_MS
+    } Button_Event;
+
+    /**
+    *   \brief Start the button interrupt and the sampling on the millisecond tick.
+    *
+    *   To be called after Timebase_Start.
+    */
+    void Button_Start(void);
+
+    /**
+    *   \brief Take the oldest event out of the ring.
+    *   \retval BUTTON_EVENT_NONE if the ring is empty.
+    */
+    Button_Event Button_GetEvent(void);
+
+    /**
+    *   \brief Check if a press is being debounced.
+    *
+    *   The pin is sampled on the millisecond tick: the tick must not be
+    *   stopped (Power_Sleep) while this returns true.
+    *   \retval Returns true (>0) from the edge interrupt to the end of the press.
+    */
+    uint8_t Button_Busy(void);
+
+    /**
+    *   \brief Number of events dropped because the ring was full.
+    */
+    uint32_t Button_Dropped(void);
+
+#endif
+/* [] END OF FILE */
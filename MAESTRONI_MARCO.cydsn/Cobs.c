@@ -0,0 +1,44 @@
+/*
+* MARCO MAESTRONI
+*
+* Consistent Overhead Byte Stuffing, in place
+*/
+
+#include "Cobs.h"
+
+uint16_t Cobs_Encode(uint8_t* buffer, uint16_t length)
+{
+    const uint8_t* in = buffer + COBS_OFFSET;
+    const uint8_t* end = in + length;
+    // The code byte of a group is written once the group is complete: it
+    // goes where the first byte of the group was, already copied
+    uint8_t* code = buffer;
+    uint8_t* out = buffer + 1;
+    uint8_t run = 1;
+
+    while (in < end)
+    {
+        if (*in == COBS_DELIMITER)
+        {
+            *code = run;
+            code = out++;
+            run = 1;
+        }
+        else
+        {
+            *out++ = *in;
+            if (++run == 0xFF && in + 1 < end)
+            {
+                *code = run;
+                code = out++;
+                run = 1;
+            }
+        }
+        in++;
+    }
+    *code = run;
+    *out++ = COBS_DELIMITER;
+    return (uint16_t)(out - buffer);
+}
+
+/* [] END OF FILE */
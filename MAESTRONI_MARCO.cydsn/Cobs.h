@@ -0,0 +1,54 @@
+/**
+*   \file Cobs.h
+*   \brief Consistent Overhead Byte Stuffing of the serial frames.
+*
+*   COBS removes the 0x00 bytes from a frame, at the cost of one byte
+*   per 254 bytes of frame, so that 0x00 can delimit the frames on the
+*   line: whatever the payload holds, a receiver that lost or received
+*   a wrong byte is in step again at the next delimiter.
+*
+*   The encoding is done in place, in the buffer the frame was built in,
+*   so that no copy of the frame is needed: the frame is written from
+*   COBS_OFFSET bytes into the buffer and its encoding, delimiter
+*   included, starts at the beginning of the buffer.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __COBS_H
+    #define __COBS_H
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief Delimiter of the encoded frames.
+    */
+    #define COBS_DELIMITER 0x00
+
+    /**
+    *   \brief Bytes before the frame in the buffer to be encoded in place.
+    */
+    #define COBS_OFFSET 1
+
+    /**
+    *   \brief Longest frame that can be encoded in place.
+    */
+    #define COBS_MAX_LENGTH 254
+
+    /**
+    *   \brief Bytes of the encoding of a frame of length bytes, delimiter included.
+    */
+    #define COBS_ENCODED_LENGTH(length) ((length) + (length) / 254 + 2)
+
+    /**
+    *   \brief Encode a frame in place and append the delimiter.
+    *
+    *   \param buffer Buffer of COBS_ENCODED_LENGTH(length) bytes, with the
+    *   frame at buffer + COBS_OFFSET.
+    *   \param length Bytes of the frame, up to COBS_MAX_LENGTH.
+    *   \retval Bytes of the encoding from the start of buffer, delimiter included.
+    */
+    uint16_t Cobs_Encode(uint8_t* buffer, uint16_t length);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,204 @@
+/*
+* MARCO MAESTRONI
+*
+* Wear-levelled configuration store in the internal EEPROM
+*/
+
+#include "ConfigStore.h"
+#include "Crc8.h"
+
+/*
+* Record layout, one EEPROM row:
+*   [0]      magic
+*   [1]      layout version
+*   [2..5]   sequence number, little endian, +1 at every save
+*   [6]      CTRL_REG1
+*   [7..14]  reserved (0)
+*   [15]     CRC-8 of bytes 0 ... 14
+*/
+#define RECORD_MAGIC         0xC5
+#define RECORD_MAGIC_POS     0
+#define RECORD_VERSION_POS   1
+#define RECORD_SEQUENCE_POS  2
+#define RECORD_CTRL_REG1_POS 6
+#define RECORD_CRC_POS       (EEPROM_PERIPHERAL_ROW_SIZE - 1)
+
+// Newest record in the EEPROM
+static ConfigStore_Config stored;
+static uint8_t stored_valid;
+static uint8_t stored_row;
+static uint32_t stored_sequence;
+
+// Configuration waiting for the write in progress to complete
+static ConfigStore_Config pending;
+static uint8_t pending_valid;
+
+// Record being written
+static ConfigStore_Config writing;
+static uint8_t writing_row;
+static uint8_t write_in_progress;
+
+static uint8_t ConfigEqual(const ConfigStore_Config* a, const ConfigStore_Config* b)
+{
+    return a->ctrl_reg1 == b->ctrl_reg1;
+}
+
+static void EncodeRecord(const ConfigStore_Config* config, uint32_t sequence, uint8_t* row)
+{
+    uint8_t i;
+    for (i = 0; i < EEPROM_PERIPHERAL_ROW_SIZE; i++)
+    {
+        row[i] = 0;
+    }
+    row[RECORD_MAGIC_POS] = RECORD_MAGIC;
+    row[RECORD_VERSION_POS] = CONFIG_STORE_VERSION;
+    row[RECORD_SEQUENCE_POS] = (uint8_t)sequence;
+    row[RECORD_SEQUENCE_POS + 1] = (uint8_t)(sequence >> 8);
+    row[RECORD_SEQUENCE_POS + 2] = (uint8_t)(sequence >> 16);
+    row[RECORD_SEQUENCE_POS + 3] = (uint8_t)(sequence >> 24);
+    row[RECORD_CTRL_REG1_POS] = config->ctrl_reg1;
+    row[RECORD_CRC_POS] = Crc8_Update(CRC8_INIT, row, RECORD_CRC_POS);
+}
+
+static uint8_t DecodeRecord(const uint8_t* row, ConfigStore_Config* config, uint32_t* sequence)
+{
+    if (row[RECORD_MAGIC_POS] != RECORD_MAGIC ||
+        row[RECORD_VERSION_POS] != CONFIG_STORE_VERSION ||
+        row[RECORD_CRC_POS] != Crc8_Update(CRC8_INIT, row, RECORD_CRC_POS))
+    {
+        return 0;
+    }
+    *sequence = (uint32_t)row[RECORD_SEQUENCE_POS] |
+                ((uint32_t)row[RECORD_SEQUENCE_POS + 1] << 8) |
+                ((uint32_t)row[RECORD_SEQUENCE_POS + 2] << 16) |
+                ((uint32_t)row[RECORD_SEQUENCE_POS + 3] << 24);
+    config->ctrl_reg1 = row[RECORD_CTRL_REG1_POS];
+    return 1;
+}
+
+ErrorCode ConfigStore_Start(ConfigStore_Config* config)
+{
+    uint8_t row[EEPROM_PERIPHERAL_ROW_SIZE];
+    ConfigStore_Config candidate;
+    uint32_t sequence;
+    uint8_t i;
+
+    stored_valid = 0;
+    pending_valid = 0;
+    write_in_progress = 0;
+    // With no valid record the first save goes to the first row
+    stored_row = CONFIG_STORE_ROW_COUNT - 1;
+    stored_sequence = 0;
+
+    EEPROM_Peripheral_Start();
+
+    for (i = 0; i < CONFIG_STORE_ROW_COUNT; i++)
+    {
+        if (EEPROM_Peripheral_ReadRow(CONFIG_STORE_FIRST_ROW + i, row) != NO_ERROR ||
+            !DecodeRecord(row, &candidate, &sequence))
+        {
+            continue;
+        }
+        // Newest record, the sequence number can wrap around
+        if (!stored_valid || (int32_t)(sequence - stored_sequence) > 0)
+        {
+            stored = candidate;
+            stored_valid = 1;
+            stored_row = i;
+            stored_sequence = sequence;
+        }
+    }
+
+    if (!stored_valid)
+    {
+        return ERROR;
+    }
+    *config = stored;
+    return NO_ERROR;
+}
+
+uint8_t ConfigStore_LegacyStartupRegister(void)
+{
+    uint8_t row[EEPROM_PERIPHERAL_ROW_SIZE];
+
+    if (EEPROM_Peripheral_ReadRow(CONFIG_STORE_FIRST_ROW, row) != NO_ERROR)
+    {
+        return 0;
+    }
+    return row[EEPROM_STARTUP_ADDRESS % EEPROM_PERIPHERAL_ROW_SIZE];
+}
+
+ErrorCode ConfigStore_Save(const ConfigStore_Config* config)
+{
+    // Compare with the last configuration that will reach the EEPROM
+    const ConfigStore_Config* last = pending_valid ? &pending :
+                                     write_in_progress ? &writing : &stored;
+
+    if ((pending_valid || write_in_progress || stored_valid) && ConfigEqual(config, last))
+    {
+        return NO_ERROR;
+    }
+    pending = *config;
+    pending_valid = 1;
+    ConfigStore_Task();
+    return NO_ERROR;
+}
+
+void ConfigStore_Task(void)
+{
+    uint8_t row[EEPROM_PERIPHERAL_ROW_SIZE];
+
+    if (write_in_progress)
+    {
+        EEPROM_WriteStatus status = EEPROM_Peripheral_WritePoll();
+        if (status == EEPROM_WRITE_BUSY)
+        {
+            return;
+        }
+        write_in_progress = 0;
+        // The sequence number is consumed even if the write failed: the
+        // next attempt goes to the following row
+        stored_row = writing_row;
+        stored_sequence++;
+        if (status == EEPROM_WRITE_DONE)
+        {
+            stored = writing;
+            stored_valid = 1;
+        }
+        else if (!pending_valid)
+        {
+            pending = writing;
+            pending_valid = 1;
+        }
+    }
+
+    if (!pending_valid)
+    {
+        return;
+    }
+    pending_valid = 0;
+    if (stored_valid && ConfigEqual(&pending, &stored))
+    {
+        return;
+    }
+
+    writing = pending;
+    writing_row = (stored_row + 1) % CONFIG_STORE_ROW_COUNT;
+    EncodeRecord(&writing, stored_sequence + 1, row);
+    if (EEPROM_Peripheral_StartWriteRow(CONFIG_STORE_FIRST_ROW + writing_row, row) == NO_ERROR)
+    {
+        write_in_progress = 1;
+    }
+    else
+    {
+        // Retried at the next pass
+        pending_valid = 1;
+    }
+}
+
+uint8_t ConfigStore_Busy(void)
+{
+    return pending_valid || write_in_progress;
+}
+
+/* [] END OF FILE */
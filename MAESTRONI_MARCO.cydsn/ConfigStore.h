@@ -0,0 +1,94 @@
+/**
+*   \file ConfigStore.h
+*   \brief Wear-levelled configuration store in the internal EEPROM.
+*
+*   The configuration is saved as a versioned record with a CRC, one per
+*   EEPROM row. Every save goes to the row after the newest one, so that
+*   the writes are spread over CONFIG_STORE_ROW_COUNT rows, and a save of
+*   the configuration already stored does not write at all. At startup
+*   the newest valid record is recovered: a record torn by a power loss
+*   fails the CRC and the previous one is used.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __CONFIGSTORE_H
+    #define __CONFIGSTORE_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+    #include "EEPROM_Interface.h"
+
+    /**
+    *   \brief EEPROM "startup" register: first byte of the store.
+    */
+    #define EEPROM_STARTUP_ADDRESS 0x00
+
+    /**
+    *   \brief First EEPROM row used by the store.
+    */
+    #define CONFIG_STORE_FIRST_ROW (EEPROM_STARTUP_ADDRESS / EEPROM_PERIPHERAL_ROW_SIZE)
+
+    /**
+    *   \brief Number of EEPROM rows the records rotate over.
+    */
+    #ifndef CONFIG_STORE_ROW_COUNT
+        #define CONFIG_STORE_ROW_COUNT 8
+    #endif
+
+    /**
+    *   \brief Version of the record layout.
+    */
+    #define CONFIG_STORE_VERSION 1
+
+    /**
+    *   \brief Configuration saved across power cycles.
+    */
+    typedef struct {
+        uint8_t ctrl_reg1;      ///< CTRL_REG1 value selecting the data rate
+    } ConfigStore_Config;
+
+    /**
+    *   \brief Start the EEPROM and recover the newest valid record.
+    *
+    *   \param config Pointer to the structure where the configuration
+    *   will be saved.
+    *   \retval NO_ERROR if a valid record was found, ERROR otherwise
+    *   (config is left untouched).
+    */
+    ErrorCode ConfigStore_Start(ConfigStore_Config* config);
+
+    /**
+    *   \brief Startup register written by the firmware before the store.
+    *
+    *   It was a single CTRL_REG1 byte at EEPROM_STARTUP_ADDRESS: to be
+    *   used, after validation, when ConfigStore_Start finds no record.
+    */
+    uint8_t ConfigStore_LegacyStartupRegister(void);
+
+    /**
+    *   \brief Save a configuration without blocking.
+    *
+    *   Nothing is written if config is the one already stored. Otherwise
+    *   the record is written in the background by ConfigStore_Task; if a
+    *   write is already in progress, only the last configuration saved
+    *   is written after it.
+    *   \param config Configuration to be saved.
+    */
+    ErrorCode ConfigStore_Save(const ConfigStore_Config* config);
+
+    /**
+    *   \brief Advance the background write.
+    *
+    *   To be called at every main loop pass.
+    */
+    void ConfigStore_Task(void);
+
+    /**
+    *   \brief Check if a save has not reached the EEPROM yet.
+    *   \retval Returns true (>0) while a record is pending or being written.
+    */
+    uint8_t ConfigStore_Busy(void);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,32 @@
+/**
+*   \file Crc8.h
+*   \brief CRC-8 used by the EEPROM records and the serial frames.
+*
+*   Polynomial x^8 + x^2 + x + 1 (0x07), initial value 0x00, no
+*   reflection: "123456789" gives 0xF4.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __CRC8_H
+    #define __CRC8_H
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief Initial value of the CRC.
+    */
+    #define CRC8_INIT 0x00
+
+    /**
+    *   \brief Continue a CRC over more bytes.
+    *
+    *   \param crc CRC of the previous bytes (CRC8_INIT for the first ones).
+    *   \param data Bytes to be added.
+    *   \param length Number of bytes.
+    *   \retval Updated CRC.
+    */
+    uint8_t Crc8_Update(uint8_t crc, const uint8_t* data, uint16_t length);
+
+#endif
+/* [] END OF FILE */
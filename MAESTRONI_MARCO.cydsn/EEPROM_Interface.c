@@ -0,0 +1,67 @@
+/*
+* MARCO MAESTRONI
+*
+* EEPROM functions definitions on the EEPROM component
+*/
+
+#include "EEPROM_Interface.h"
+#include "EEPROM.h"
+
+static uint8_t write_in_progress;
+
+ErrorCode EEPROM_Peripheral_Start(void)
+{
+    EEPROM_Start();
+    return NO_ERROR;
+}
+
+ErrorCode EEPROM_Peripheral_ReadRow(uint8_t row, uint8_t* data)
+{
+    uint16_t address = (uint16_t)row * EEPROM_PERIPHERAL_ROW_SIZE;
+    uint8_t i;
+
+    if (row >= EEPROM_PERIPHERAL_ROW_COUNT)
+    {
+        return ERROR;
+    }
+    for (i = 0; i < EEPROM_PERIPHERAL_ROW_SIZE; i++)
+    {
+        data[i] = EEPROM_ReadByte(address + i);
+    }
+    return NO_ERROR;
+}
+
+ErrorCode EEPROM_Peripheral_StartWriteRow(uint8_t row, const uint8_t* data)
+{
+    if (write_in_progress || row >= EEPROM_PERIPHERAL_ROW_COUNT)
+    {
+        return ERROR;
+    }
+    // The programming time depends on the die temperature: it is measured
+    // here, writes are rare enough for this not to matter
+    EEPROM_UpdateTemperature();
+    // The row is loaded in the SPC latches, data can be released at once
+    if (EEPROM_StartWrite(data, row) != CYRET_SUCCESS)
+    {
+        return ERROR;
+    }
+    write_in_progress = 1;
+    return NO_ERROR;
+}
+
+EEPROM_WriteStatus EEPROM_Peripheral_WritePoll(void)
+{
+    if (!write_in_progress)
+    {
+        return EEPROM_WRITE_IDLE;
+    }
+    cystatus status = EEPROM_Query();
+    if (status == CYRET_STARTED)
+    {
+        return EEPROM_WRITE_BUSY;
+    }
+    write_in_progress = 0;
+    return status == CYRET_SUCCESS ? EEPROM_WRITE_DONE : EEPROM_WRITE_FAILED;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,71 @@
+/** 
+ * \file EEPROM_Interface.h
+ * \brief Hardware specific EEPROM interface.
+ *
+ * Row based access to the internal EEPROM. As for I2C_Interface.h, only
+ * this interface needs to be replaced to run the configuration store on
+ * another platform (see Host/EEPROM_Interface_Host.c).
+ *
+ * \author Marco Maestroni
+*/
+
+#ifndef __EEPROM_INTERFACE_H
+    #define __EEPROM_INTERFACE_H
+    
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+    
+    /**
+    *   \brief Bytes of one EEPROM row, the unit of a write.
+    */
+    #define EEPROM_PERIPHERAL_ROW_SIZE  16
+    
+    /**
+    *   \brief Number of rows of the EEPROM (2 KB on the PSoC 5LP).
+    */
+    #define EEPROM_PERIPHERAL_ROW_COUNT 128
+    
+    /**
+    *   \brief State of a row write.
+    */
+    typedef enum {
+        EEPROM_WRITE_IDLE,      ///< No write started
+        EEPROM_WRITE_BUSY,      ///< Row being erased and programmed
+        EEPROM_WRITE_DONE,      ///< Write completed without errors
+        EEPROM_WRITE_FAILED     ///< Write completed with an error
+    } EEPROM_WriteStatus;
+    
+    /** \brief Start the EEPROM peripheral.
+    */
+    ErrorCode EEPROM_Peripheral_Start(void);
+    
+    /**
+    *   \brief Read one row.
+    *   \param row Row number (0 ... EEPROM_PERIPHERAL_ROW_COUNT - 1).
+    *   \param data Array of EEPROM_PERIPHERAL_ROW_SIZE bytes where the row
+    *   will be saved.
+    */
+    ErrorCode EEPROM_Peripheral_ReadRow(uint8_t row, uint8_t* data);
+    
+    /**
+    *   \brief Start writing one row without blocking.
+    *
+    *   The row is erased and programmed by the hardware while the CPU
+    *   does other work; only one write can be in progress.
+    *   \param row Row number (0 ... EEPROM_PERIPHERAL_ROW_COUNT - 1).
+    *   \param data EEPROM_PERIPHERAL_ROW_SIZE bytes to be written. They
+    *   are copied before the function returns.
+    */
+    ErrorCode EEPROM_Peripheral_StartWriteRow(uint8_t row, const uint8_t* data);
+    
+    /**
+    *   \brief Check the row write.
+    *
+    *   It returns EEPROM_WRITE_DONE or EEPROM_WRITE_FAILED once, when the
+    *   write completes, and then EEPROM_WRITE_IDLE.
+    *   \retval State of the write.
+    */
+    EEPROM_WriteStatus EEPROM_Peripheral_WritePoll(void);
+    
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,197 @@
+/*
+* MARCO MAESTRONI
+*
+* Hardware abstraction on the PSoC components
+*/
+
+#include "Hal.h"
+#include "AcquisitionConfig.h"
+#include "project.h"
+
+// Cortex-M3 debug registers of the DWT cycle counter
+#define HAL_DEMCR               0xE000EDFCu
+#define HAL_DEMCR_TRCENA        0x01000000u
+#define HAL_DWT_CTRL            0xE0001000u
+#define HAL_DWT_CTRL_CYCCNTENA  0x00000001u
+#define HAL_DWT_CYCCNT          0xE0001004u
+
+// SysTick interrupt pending flag (PENDSTSET) of the interrupt control register
+#define HAL_ICSR                0xE000ED04u
+#define HAL_ICSR_PENDSTSET      0x04000000u
+
+// SysTick control and status register: COUNTFLAG is cleared by every
+// read, the read-modify-write of CySysTickStop included
+#define HAL_SYST_CSR            0xE000E010u
+#define HAL_SYST_CSR_COUNTFLAG  0x00010000u
+
+// SysTick is a 24-bit down counter
+#define HAL_SYSTICK_MAX_LOAD    0x00FFFFFFu
+
+void Hal_InterruptsEnable(void)
+{
+    CyGlobalIntEnable;
+}
+
+void Hal_InterruptsDisable(void)
+{
+    CyGlobalIntDisable;
+}
+
+uint8_t Hal_EnterCritical(void)
+{
+    return CyEnterCriticalSection();
+}
+
+void Hal_ExitCritical(uint8_t state)
+{
+    CyExitCriticalSection(state);
+}
+
+void Hal_WaitForInterrupt(void)
+{
+    CY_PM_WFI;
+}
+
+uint32_t Hal_SleepTickless(uint32_t max_ms, uint32_t* cycles)
+{
+    uint32_t reload = CySysTickGetReload();
+    uint32_t period = reload + 1;
+    uint32_t status;
+    uint32_t done;
+    uint32_t load;
+    uint32_t total;
+    uint32_t ticks;
+
+    if (max_ms > (HAL_SYSTICK_MAX_LOAD + 1) / period)
+    {
+        max_ms = (HAL_SYSTICK_MAX_LOAD + 1) / period;
+    }
+    // A tick waiting to be served is not skipped
+    if (max_ms < 2 || (CY_GET_REG32(HAL_ICSR) & HAL_ICSR_PENDSTSET))
+    {
+        *cycles = 0;
+        CY_PM_WFI;
+        return 0;
+    }
+
+    // One long SysTick period up to the max_ms-th tick; the few cycles the
+    // counter is stopped for are lost
+    CySysTickStop();
+    done = reload - CySysTickGetValue();
+    load = max_ms * period - done - 1;
+    CySysTickSetReload(load);
+    CySysTickClear();
+    CySysTickEnable();
+
+    CY_PM_WFI;
+
+    // COUNTFLAG read once, before the counter is stopped
+    status = CY_GET_REG32(HAL_SYST_CSR);
+    CySysTickStop();
+    if (status & HAL_SYST_CSR_COUNTFLAG)
+    {
+        // Woken up by the long period: its interrupt is pending and counts
+        // the last tick
+        *cycles = load + 1;
+        ticks = max_ms - 1;
+        CySysTickSetReload(reload);
+    }
+    else
+    {
+        // Woken up by another interrupt: the current tick period goes on
+        // from where it is
+        *cycles = load - CySysTickGetValue();
+        total = done + *cycles;
+        ticks = total / period;
+        load = period - total % period - 1;
+        if (load == 0)
+        {
+            // A reload value of 0 never counts down to 0: the tick due at
+            // the next cycle is counted here and a whole period starts
+            ticks++;
+            load = reload;
+        }
+        CySysTickSetReload(load);
+    }
+    CySysTickClear();
+    CySysTickEnable();
+    // Loaded at the next wrap: back to one tick per period
+    CySysTickSetReload(reload);
+    return ticks;
+}
+
+void Hal_ButtonStart(Hal_Handler handler)
+{
+    isr_Button_StartEx(handler);
+}
+
+uint8_t Hal_ButtonPressed(void)
+{
+    // The button pulls the pin down against its resistive pull-up
+    return Push_Button_Read() == 0;
+}
+
+void Hal_DataReadyStart(Hal_Handler handler)
+{
+    // isr_DataReady is only placed in TopDesign for the INT1 driven modes
+#if ACQ_MODE != ACQ_MODE_POLLING
+    isr_DataReady_StartEx(handler);
+#else
+    (void)handler;
+#endif
+}
+
+void Hal_TickStart(Hal_Handler handler)
+{
+    // SysTick configured to interrupt every 1 ms
+    CySysTickStart();
+    CySysTickSetCallback(0, handler);
+}
+
+uint32_t Hal_TickPeriodCycles(void)
+{
+    return CySysTickGetReload() + 1;
+}
+
+uint32_t Hal_TickElapsedCycles(void)
+{
+    // SysTick counts down from reload to 0
+    return CySysTickGetReload() - CySysTickGetValue();
+}
+
+void Hal_CycleCounterStart(void)
+{
+    // The DWT unit is only clocked once the trace is enabled
+    CY_SET_REG32(HAL_DEMCR, CY_GET_REG32(HAL_DEMCR) | HAL_DEMCR_TRCENA);
+    CY_SET_REG32(HAL_DWT_CYCCNT, 0);
+    CY_SET_REG32(HAL_DWT_CTRL, CY_GET_REG32(HAL_DWT_CTRL) | HAL_DWT_CTRL_CYCCNTENA);
+}
+
+uint32_t Hal_CycleCounter(void)
+{
+    return CY_GET_REG32(HAL_DWT_CYCCNT);
+}
+
+void Hal_UartStart(void)
+{
+    UART_Debug_Start();
+}
+
+void Hal_UartPutString(const char* string)
+{
+    UART_Debug_PutString(string);
+}
+
+void Hal_UartPutArray(const uint8_t* data, uint16_t length)
+{
+    // UART_Debug_PutArray takes at most 255 bytes
+    while (length > 0)
+    {
+        uint8_t chunk = length > 255 ? 255 : (uint8_t)length;
+        UART_Debug_PutArray(data, chunk);
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,129 @@
+/**
+*   \file Hal.h
+*   \brief Hardware abstraction of the platform services used by the firmware.
+*
+*   Interrupt masking, sleep, the push button and data-ready interrupts,
+*   the millisecond tick and the debug UART. Together with I2C_Interface.h
+*   and EEPROM_Interface.h this is everything that has to be replaced to
+*   run the firmware on another platform: Hal.c implements it on the PSoC
+*   components, Host/Hal_Host.c on POSIX signals and standard output,
+*   Host/Hal_Sim.c in virtual time for reproducible host runs.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __HAL_H
+    #define __HAL_H
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief Handler of an interrupt, declared with CY_ISR.
+    */
+    typedef void (*Hal_Handler)(void);
+
+    /**
+    *   \brief Enable the interrupts globally.
+    */
+    void Hal_InterruptsEnable(void);
+
+    /**
+    *   \brief Disable the interrupts globally.
+    */
+    void Hal_InterruptsDisable(void);
+
+    /**
+    *   \brief Disable the interrupts, returning the previous state.
+    *   \retval State to pass to Hal_ExitCritical.
+    */
+    uint8_t Hal_EnterCritical(void);
+
+    /**
+    *   \brief Restore the interrupt state saved by Hal_EnterCritical.
+    *   \param state Value returned by Hal_EnterCritical.
+    */
+    void Hal_ExitCritical(uint8_t state);
+
+    /**
+    *   \brief Sleep until an interrupt is pending.
+    *
+    *   May be called with the interrupts disabled: a pending interrupt
+    *   wakes up the core anyway, and is served once they are enabled.
+    */
+    void Hal_WaitForInterrupt(void);
+
+    /**
+    *   \brief Sleep with the tick stopped until another interrupt is
+    *   pending, for at most max_ms milliseconds (tickless idle).
+    *
+    *   To be called with the interrupts disabled, like
+    *   Hal_WaitForInterrupt. The ticks elapsed while sleeping are not
+    *   signalled to the tick handler: they are returned to the caller.
+    *   With max_ms below 2 the tick is not stopped.
+    *   \param cycles Pointer to a variable where the CPU clock cycles
+    *   spent asleep will be saved.
+    *   \retval Number of ticks elapsed while sleeping.
+    */
+    uint32_t Hal_SleepTickless(uint32_t max_ms, uint32_t* cycles);
+
+    /**
+    *   \brief Call handler when the push button is pressed.
+    */
+    void Hal_ButtonStart(Hal_Handler handler);
+
+    /**
+    *   \brief Read the level of the push button pin, not debounced.
+    *   \retval Returns true (>0) if the button reads pressed.
+    */
+    uint8_t Hal_ButtonPressed(void);
+
+    /**
+    *   \brief Call handler on the rising edges of the LIS3DH INT1 pin.
+    */
+    void Hal_DataReadyStart(Hal_Handler handler);
+
+    /**
+    *   \brief Call handler every millisecond.
+    */
+    void Hal_TickStart(Hal_Handler handler);
+
+    /**
+    *   \brief CPU clock cycles between two ticks.
+    */
+    uint32_t Hal_TickPeriodCycles(void);
+
+    /**
+    *   \brief CPU clock cycles elapsed since the last tick.
+    */
+    uint32_t Hal_TickElapsedCycles(void);
+
+    /**
+    *   \brief Start the free-running CPU clock cycle counter.
+    */
+    void Hal_CycleCounterStart(void);
+
+    /**
+    *   \brief CPU clock cycles counted since Hal_CycleCounterStart.
+    *
+    *   The count wraps around: only differences between two readings are
+    *   meaningful.
+    */
+    uint32_t Hal_CycleCounter(void);
+
+    /**
+    *   \brief Start the debug UART.
+    */
+    void Hal_UartStart(void);
+
+    /**
+    *   \brief Send a string over the debug UART.
+    */
+    void Hal_UartPutString(const char* string);
+
+    /**
+    *   \brief Send length bytes over the debug UART.
+    */
+    void Hal_UartPutArray(const uint8_t* data, uint16_t length);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,118 @@
+/*
+* MARCO MAESTRONI
+*
+* Loss accounting of the acquisition
+*/
+
+#include "Health.h"
+#include "AcquisitionConfig.h"
+#include "LIS3DH_Registers.h"
+#include "Timebase.h"
+#include "UartTx.h"
+#include "LIS3DH_Fifo.h"
+#include "Power.h"
+#include "Button.h"
+#include "LIS3DH_Odr.h"
+#include "Cobs.h"
+
+// Bytes of a health frame on the line
+#if ACQ_FRAMING == ACQ_FRAMING_COBS
+    #define HEALTH_LINE_LENGTH COBS_ENCODED_LENGTH(PACKET_HEALTH_LENGTH)
+#else
+    #define HEALTH_LINE_LENGTH PACKET_HEALTH_LENGTH
+#endif
+
+static Packet_Health health;
+static uint32_t last_frame_ms;
+// Set while a frame would hold the loop for longer than a sample period
+static uint8_t deferred;
+
+void Health_Start(void)
+{
+    Packet_Health cleared = {0};
+
+    cleared.odr = health.odr;
+    health = cleared;
+    last_frame_ms = Timebase_GetMs();
+}
+
+void Health_SetOdr(uint8_t odr)
+{
+    health.odr = odr;
+#if !ACQ_UART_DMA && ACQ_MODE != ACQ_MODE_FIFO
+    // As for the batch frames (Transmit_SetOdr): Hal_UartPutArray blocks
+    // the loop until the frame is in the TX FIFO, and a sample not read
+    // within its period is overwritten in the sensor
+    deferred = (uint32_t)HEALTH_LINE_LENGTH * 10 * LIS3DH_OdrTable[odr].hz > ACQ_UART_BAUD_RATE;
+#endif
+}
+
+void Health_Status(uint8_t status)
+{
+    if (status & LIS3DH_STATUS_REG_NEW_DATA)
+    {
+        health.samples++;
+    }
+    else
+    {
+        health.stale++;
+    }
+    if (status & LIS3DH_STATUS_REG_OVERRUN)
+    {
+        health.overruns++;
+        health.overrun_x += (status & LIS3DH_STATUS_REG_X_OVERRUN) != 0;
+        health.overrun_y += (status & LIS3DH_STATUS_REG_Y_OVERRUN) != 0;
+        health.overrun_z += (status & LIS3DH_STATUS_REG_Z_OVERRUN) != 0;
+    }
+}
+
+void Health_Fifo(uint8_t fifo_src, uint8_t count)
+{
+    health.samples += count;
+    if (count == 0)
+    {
+        health.stale++;
+    }
+    if (fifo_src & LIS3DH_FIFO_SRC_REG_OVRN_FIFO)
+    {
+        health.fifo_overruns++;
+    }
+}
+
+void Health_ReadError(void)
+{
+    health.read_errors++;
+}
+
+void Health_Get(Packet_Health* copy)
+{
+    Power_Stats power;
+
+    Power_GetStats(&power);
+    *copy = health;
+    copy->timestamp = Timebase_GetMs();
+    copy->wakeups = power.wakeups;
+    copy->sleep_ms = power.sleep_ms;
+    copy->button_drops = Button_Dropped();
+}
+
+void Health_Task(void)
+{
+#if ACQ_HEALTH_PERIOD_MS
+    Packet_Health copy;
+    uint8_t* frame;
+
+    if (deferred || Timebase_GetMs() - last_frame_ms < ACQ_HEALTH_PERIOD_MS)
+    {
+        return;
+    }
+
+    Health_Get(&copy);
+    frame = UartTx_Reserve();
+    Packet_BuildHealth(&copy, frame);
+    UartTx_Commit(frame, PACKET_HEALTH_LENGTH);
+    last_frame_ms = copy.timestamp;
+#endif
+}
+
+/* [] END OF FILE */
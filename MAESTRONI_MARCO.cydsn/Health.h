@@ -0,0 +1,86 @@
+/**
+*   \file Health.h
+*   \brief Loss accounting of the acquisition.
+*
+*   Every STATUS_REG read with a sample, or FIFO_SRC_REG read with a FIFO
+*   drain, is accounted here: the overrun flags tell that the LIS3DH
+*   overwrote samples the loop did not read in time, for example while
+*   it was waiting for an EEPROM write or for the UART. The counters run
+*   from startup and are sent in a health frame (Packet.h) every
+*   ACQ_HEALTH_PERIOD_MS, between the sample frames, so that the losses
+*   at a given data rate and baud rate are seen on the receiver. The
+*   frames also carry the wake-ups and sleep time of Power.h, from which
+*   the receiver estimates the duty cycle, and the push button events
+*   dropped by Button.h.
+*
+*   Without ACQ_UART_DMA, and out of ACQ_MODE_FIFO, sending a frame holds
+*   the loop until it is in the TX FIFO. At the data rates where a health
+*   frame does not go out within one sample period, the sensor would
+*   overwrite samples every time one is sent: the frames are deferred
+*   until the data rate is lowered. The counters keep running, so the
+*   next frame accounts for the whole time.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __HEALTH_H
+    #define __HEALTH_H
+
+    #include "cytypes.h"
+    #include "Packet.h"
+
+    /**
+    *   \brief Reset the counters and start the period of the health frames.
+    */
+    void Health_Start(void);
+
+    /**
+    *   \brief Select the data rate reported in the next frames, and
+    *   defer the frames if one would not go out within its sample period.
+    *   \param odr Index of the data rate in LIS3DH_OdrTable.
+    */
+    void Health_SetOdr(uint8_t odr);
+
+    /**
+    *   \brief Account a STATUS_REG read in the same burst as a sample.
+    *
+    *   A read with no new data is counted as stale (the sample is not sent).
+    *   \param status Value of STATUS_REG.
+    */
+    void Health_Status(uint8_t status);
+
+    /**
+    *   \brief Account a FIFO drain.
+    *
+    *   A drain finding the FIFO full counts as a FIFO overrun: in stream
+    *   mode the oldest samples are overwritten from then on.
+    *   \param fifo_src Value of FIFO_SRC_REG read before the drain.
+    *   \param count Number of samples drained.
+    */
+    void Health_Fifo(uint8_t fifo_src, uint8_t count);
+
+    /**
+    *   \brief Account a sample read, FIFO drain or data rate change
+    *   failed on the I2C bus.
+    *
+    *   No sample of the read is sent; a data rate change is tried again.
+    */
+    void Health_ReadError(void);
+
+    /**
+    *   \brief Copy the counters.
+    *   \param health Pointer to the structure where the counters will be saved.
+    */
+    void Health_Get(Packet_Health* health);
+
+    /**
+    *   \brief Send the counters in a health frame once ACQ_HEALTH_PERIOD_MS
+    *   have elapsed since the last one, unless the frames are deferred at
+    *   the current data rate.
+    *
+    *   To be called at every main loop pass.
+    */
+    void Health_Task(void);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,120 @@
+/*
+* MARCO MAESTRONI
+*
+* Host report of the UART bandwidth needed by each frame format: bytes
+* per sample and lowest standard baud rate for every ODR, and check that
+* the batch frames decode back to the samples that were packed.
+*
+* Build from this folder with:
+*   cc -I. -I.. -o BatchReport BatchReport.c PacketDecoder.c ConvertBatch.c ../Packet.c \
+*      ../Crc8.c -lm
+*/
+
+#include <stdio.h>
+#include "PacketDecoder.h"
+
+#define SAMPLES 10000
+
+static const uint32_t odr_hz[] = { 1, 10, 25, 50, 100, 200, 400, 1344, 1600, 5376 };
+static const uint32_t bauds[] = { 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600 };
+static const uint8_t batch_sizes[] = { 4, 8, 16, 32 };
+
+// Lowest baud rate carrying bytes_per_sample at odr, 0 if none does
+static uint32_t BaudFor(uint32_t odr, double bytes_per_sample)
+{
+    uint8_t i;
+    for (i = 0; i < sizeof(bauds) / sizeof(bauds[0]); i++)
+    {
+        // 10 bits per byte on the line
+        if (odr * bytes_per_sample * 10 <= bauds[i])
+        {
+            return bauds[i];
+        }
+    }
+    return 0;
+}
+
+static void PrintRow(const char* name, double bytes_per_sample)
+{
+    uint8_t o;
+    printf("%-9s %6.2f", name, bytes_per_sample);
+    for (o = 0; o < sizeof(odr_hz) / sizeof(odr_hz[0]); o++)
+    {
+        printf(" %7u", (unsigned)BaudFor(odr_hz[o], bytes_per_sample));
+    }
+    printf("\n");
+}
+
+// Pack SAMPLES samples in frames of size samples and decode them back
+static int RoundTrip(uint8_t size)
+{
+    static uint8_t frame[PACKET_BATCH_LENGTH(PACKET_BATCH_MAX)];
+    static PacketDecoder decoder;
+    uint32_t sent = 0;
+    uint32_t received = 0;
+    uint32_t errors = 0;
+    uint16_t length;
+    uint16_t i;
+    uint8_t count;
+    uint8_t s;
+
+    PacketDecoder_Init(&decoder);
+    while (sent < SAMPLES)
+    {
+        Packet_BatchStart(frame, (uint16_t)sent, sent * 5, 5);
+        for (s = 0; s < size; s++, sent++)
+        {
+            Packet_BatchAdd(frame, (int16_t)(sent % 4096) - 2048,
+                            (int16_t)(-(int32_t)(sent % 2048)), (int16_t)(sent % 2047));
+        }
+        length = Packet_BatchFinish(frame);
+        for (i = 0; i < length; i++)
+        {
+            count = PacketDecoder_Push(&decoder, frame[i]);
+            for (s = 0; s < count; s++, received++)
+            {
+                const PacketDecoder_Sample* sample = &decoder.samples[s];
+                errors += sample->seq != (uint16_t)received ||
+                          sample->x != (int16_t)(received % 4096) - 2048 ||
+                          sample->y != (int16_t)(-(int32_t)(received % 2048)) ||
+                          sample->z != (int16_t)(received % 2047);
+            }
+        }
+    }
+    errors += received != sent || decoder.stats.lost || decoder.stats.crc_errors;
+    return errors == 0;
+}
+
+int main(void)
+{
+    char name[16];
+    uint8_t o;
+    uint8_t b;
+    int ok = 1;
+
+    printf("lowest baud rate per ODR (Hz), 0 = none up to 921600\n");
+    printf("format    B/smp ");
+    for (o = 0; o < sizeof(odr_hz) / sizeof(odr_hz[0]); o++)
+    {
+        printf(" %7u", (unsigned)odr_hz[o]);
+    }
+    printf("\n");
+    PrintRow("v1", 8);
+    PrintRow("v2", PACKET_V2_LENGTH);
+    for (b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++)
+    {
+        snprintf(name, sizeof(name), "batch %u", (unsigned)batch_sizes[b]);
+        PrintRow(name, (double)PACKET_BATCH_LENGTH(batch_sizes[b]) / batch_sizes[b]);
+    }
+
+    for (b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++)
+    {
+        int trip = RoundTrip(batch_sizes[b]);
+        printf("batch %2u: %u samples decoded back %s\n", (unsigned)batch_sizes[b],
+               (unsigned)SAMPLES, trip ? "ok" : "FAILED");
+        ok &= trip;
+    }
+    return ok ? 0 : 1;
+}
+
+/* [] END OF FILE */
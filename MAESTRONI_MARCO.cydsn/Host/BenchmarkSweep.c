@@ -0,0 +1,509 @@
+/*
+* MARCO MAESTRONI
+*
+* Benchmark sweep of the whole acquisition chain: the firmware built on
+* the virtual time HAL (Host/Hal_Sim.c) is run for every ODR, I2C bus
+* speed, baud rate and firmware build (packet format) given, and the
+* frames it sends are decoded. One CSV line is printed per run:
+*
+*   format        name given to the firmware build on the command line
+*   odr_hz        rate the firmware boots at (stored in the EEPROM image)
+*   i2c_khz       I2C bus speed
+*   baud          UART baud rate
+*   samples_per_s distinct samples received per second
+*   dropped       samples produced by the sensor and never received
+*   duplicated    samples received more than once
+*   latency_*_ms  50th, 95th, 99th percentile and maximum of the time from
+*                 the sample being ready in the sensor to the last byte of
+*                 its frame on the UART line
+*   awake_pct     time the CPU is not sleeping in Hal_WaitForInterrupt;
+*                 the virtual time HAL only accounts the time spent waiting
+*                 for the I2C bus and the UART, not the code execution
+*   wakeups_per_s times per second the CPU woke up from a sleep
+*   crc_errors    frames rejected by the decoder
+*   untimed       samples received with no time in the trace, or sent
+*                 before the trace has them ready
+*   overwritten   samples the sensor overwrote before the firmware read
+*                 them
+*
+* A run fails if its trace is empty, if a sample is duplicated, untimed
+* or in a frame with a wrong CRC, or if no sample at all is received.
+*
+* The sensor plays back a waveform in which every sample carries its own
+* index in the X and Y outputs, so that every received sample is traced
+* back to the time it was produced (HAL_TRACE_FILE). Only the samples
+* produced between WARMUP_MS and RUN_MS - TAIL_MS are accounted. The
+* firmware builds must use the +-2 g range (ACQ_FULL_SCALE_G 2) and send
+* version 2 or batch frames; they should allow every rate (ACQ_ODR_MAX_HZ
+* 5376).
+*
+* A build that only sends a batch when the LIS3DH FIFO reaches its
+* watermark holds the samples for the time of a batch: at the lowest
+* rates that is longer than TAIL_MS, and the samples still in the FIFO
+* at the end of the run are counted as dropped.
+*
+* Build from this folder with:
+*   cc -I. -I.. -o BenchmarkSweep BenchmarkSweep.c PacketDecoder.c ConvertBatch.c \
+*      EepromSim.c EEPROM_Interface_Host.c I2C_Interface_Host.c Lis3dhSim.c \
+*      ../Packet.c ../Crc8.c ../ConfigStore.c ../LIS3DH_Odr.c \
+*      ../LIS3DH_Convert.c -lm
+*
+* Usage:
+*   ./BenchmarkSweep [--quick] [--odr=1,10,25] v2=./acquisition_sim_v2 \
+*       batch=./acquisition_sim_batch > sweep.csv
+*
+* --quick reduces the rates and baud rates swept, --odr gives the rates.
+* The waveform, trace and EEPROM files of the runs are written in the
+* current folder, named after the process ID, and removed at the end.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "PacketDecoder.h"
+#include "ConfigStore.h"
+#include "EepromSim.h"
+#include "LIS3DH_Odr.h"
+
+#define RUN_MS          2500
+#define WARMUP_MS       500
+#define TAIL_MS         500
+#define NS_PER_MS       1000000ULL
+#define NS_PER_S        1000000000ULL
+
+// The sample index is coded on 8 bits per axis in X and Y, 16 mg per
+// step: exact at every resolution of the +-2 g range
+#define INDEX_COUNT     65536
+#define INDEX_STEP_MG   16
+
+// Files of the runs, named after the process so that two sweeps can run
+// in the same folder at once
+#define FILE_PREFIX     "BenchmarkSweep_"
+#define FILE_NAME_MAX   64
+
+#define FORMAT_MAX      8
+
+typedef struct {
+    const char* name;
+    const char* path;
+} Firmware;
+
+typedef struct {
+    double samples_per_s;
+    uint32_t dropped;
+    uint32_t duplicated;
+    double latency[4];      // 50th, 95th, 99th percentile, maximum
+    double awake_pct;
+    double wakeups_per_s;
+    uint32_t crc_errors;
+    uint32_t untimed;
+    uint32_t overwritten;
+} Result;
+
+static const uint16_t full_odr[] = { 1, 10, 25, 50, 100, 200, 400, 1344, 1600, 5376 };
+static const uint16_t quick_odr[] = { 50, 200, 1344 };
+static const uint16_t full_i2c[] = { 100, 400 };
+static const uint32_t full_baud[] = { 38400, 115200, 230400, 921600 };
+static const uint32_t quick_baud[] = { 38400, 115200 };
+
+// Per sample index: time it was ready (0 if not produced), times received
+// and latency of the first reception (negative if it could not be timed)
+static uint64_t ready_ns[INDEX_COUNT];
+static uint16_t received[INDEX_COUNT];
+static double latency_ms[INDEX_COUNT];
+static double window_latency[INDEX_COUNT];
+
+// End of every Hal_UartPutArray call: bytes sent so far and time
+static uint64_t* chunk_bytes;
+static uint64_t* chunk_ns;
+static size_t chunk_count;
+static size_t chunk_capacity;
+
+static uint64_t total_ns;
+static uint64_t sleep_ns;
+static uint32_t wakeups;
+// Samples overwritten in the sensor by the start and the end of the window
+static uint32_t overwritten_start;
+static uint32_t overwritten_end;
+
+static PacketDecoder decoder;
+static uint8_t stream[1 << 22];
+
+static char waveform_file[FILE_NAME_MAX];
+static char trace_file[FILE_NAME_MAX];
+static char eeprom_file[FILE_NAME_MAX];
+
+static void WriteWaveform(void)
+{
+    FILE* file = fopen(waveform_file, "w");
+    uint32_t i;
+
+    if (file == NULL)
+    {
+        perror(waveform_file);
+        exit(1);
+    }
+    for (i = 0; i < INDEX_COUNT; i++)
+    {
+        fprintf(file, "%d,%d,1000\n",
+                ((int)(i & 0xFF) - 128) * INDEX_STEP_MG, ((int)(i >> 8) - 128) * INDEX_STEP_MG);
+    }
+    fclose(file);
+}
+
+static uint32_t SampleIndex(const PacketDecoder_Sample* sample)
+{
+    // Decoded outputs are 12-bit right-justified: 1 mg per digit at +-2 g
+    return (uint32_t)(sample->x / INDEX_STEP_MG + 128) |
+           ((uint32_t)(sample->y / INDEX_STEP_MG + 128) << 8);
+}
+
+// EEPROM image making the firmware boot at the given rate
+static int WriteEeprom(uint16_t hz)
+{
+    ConfigStore_Config config;
+    uint8_t i;
+
+    for (i = 0; i < LIS3DH_ODR_COUNT && LIS3DH_OdrTable[i].hz != hz; i++)
+    {
+    }
+    if (i == LIS3DH_ODR_COUNT)
+    {
+        return 0;
+    }
+    EepromSim_Erase();
+    ConfigStore_Start(&config);
+    config.ctrl_reg1 = LIS3DH_OdrTable[i].ctrl_reg1;
+    ConfigStore_Save(&config);
+    while (ConfigStore_Busy())
+    {
+        ConfigStore_Task();
+    }
+    EepromSim_Save(eeprom_file);
+    return 1;
+}
+
+static void ReadTrace(void)
+{
+    FILE* file = fopen(trace_file, "r");
+    char type;
+    unsigned long long a;
+    unsigned long long b;
+
+    memset(ready_ns, 0, sizeof(ready_ns));
+    chunk_count = 0;
+    total_ns = 0;
+    sleep_ns = 0;
+    wakeups = 0;
+    overwritten_start = 0;
+    overwritten_end = 0;
+    if (file == NULL)
+    {
+        return;
+    }
+    while (fscanf(file, " %c %llu %llu", &type, &a, &b) == 3)
+    {
+        if (type == 's' && a < INDEX_COUNT)
+        {
+            ready_ns[a] = b;
+        }
+        else if (type == 'u')
+        {
+            if (chunk_count == chunk_capacity)
+            {
+                chunk_capacity = chunk_capacity ? 2 * chunk_capacity : 4096;
+                chunk_bytes = realloc(chunk_bytes, chunk_capacity * sizeof(*chunk_bytes));
+                chunk_ns = realloc(chunk_ns, chunk_capacity * sizeof(*chunk_ns));
+            }
+            chunk_bytes[chunk_count] = a;
+            chunk_ns[chunk_count] = b;
+            chunk_count++;
+        }
+        else if (type == 'w')
+        {
+            wakeups = (uint32_t)a;
+        }
+        else if (type == 'o')
+        {
+            if (b < WARMUP_MS * NS_PER_MS)
+            {
+                overwritten_start = (uint32_t)a;
+            }
+            if (b < (RUN_MS - TAIL_MS) * NS_PER_MS)
+            {
+                overwritten_end = (uint32_t)a;
+            }
+        }
+        else if (type == 't')
+        {
+            total_ns = a;
+            sleep_ns = b;
+        }
+    }
+    fclose(file);
+}
+
+// Time the byte number offset (from 1) was completely sent
+static uint64_t ByteSentNs(uint64_t offset, uint64_t byte_ns)
+{
+    size_t low = 0;
+    size_t high = chunk_count;
+
+    while (low < high)
+    {
+        size_t middle = (low + high) / 2;
+        if (chunk_bytes[middle] < offset)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    if (low == chunk_count)
+    {
+        return UINT64_MAX;
+    }
+    return chunk_ns[low] - (chunk_bytes[low] - offset) * byte_ns;
+}
+
+static int CompareDouble(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double Percentile(const double* sorted, uint32_t count, double fraction)
+{
+    uint32_t i = (uint32_t)(fraction * count);
+    if (count == 0)
+    {
+        return 0;
+    }
+    return sorted[i < count ? i : count - 1];
+}
+
+static int Run(const Firmware* firmware, uint16_t hz, uint16_t i2c_khz, uint32_t baud, Result* result)
+{
+    char value[32];
+    char command[512];
+    FILE* output;
+    uint64_t byte_ns = 10 * NS_PER_S / baud;
+    uint64_t offset = 0;
+    uint32_t first = INDEX_COUNT;
+    uint32_t last = 0;
+    uint32_t latencies = 0;
+    uint32_t distinct = 0;
+    size_t length = 0;
+    uint32_t i;
+    int byte;
+
+    if (!WriteEeprom(hz))
+    {
+        return 0;
+    }
+    sprintf(value, "%u", RUN_MS);
+    setenv("HAL_RUN_MS", value, 1);
+    sprintf(value, "%u", i2c_khz);
+    setenv("HAL_I2C_KHZ", value, 1);
+    sprintf(value, "%u", (unsigned)baud);
+    setenv("HAL_UART_BAUD", value, 1);
+    setenv("HAL_LIS3DH_WAVEFORM", waveform_file, 1);
+    setenv("HAL_TRACE_FILE", trace_file, 1);
+    setenv("HAL_EEPROM_FILE", eeprom_file, 1);
+    unsetenv("HAL_BUTTON_MS");
+
+    snprintf(command, sizeof(command), "'%s' 2> /dev/null", firmware->path);
+    output = popen(command, "r");
+    if (output == NULL)
+    {
+        return 0;
+    }
+    memset(received, 0, sizeof(received));
+    for (i = 0; i < INDEX_COUNT; i++)
+    {
+        latency_ms[i] = -1;
+    }
+    PacketDecoder_Init(&decoder);
+    // The trace is complete once the process has exited: the frames are
+    // decoded first and matched to the UART times afterwards
+    while ((byte = fgetc(output)) != EOF && length < sizeof(stream))
+    {
+        stream[length++] = (uint8_t)byte;
+    }
+    if (pclose(output) != 0)
+    {
+        return 0;
+    }
+    ReadTrace();
+    if (total_ns == 0 || chunk_count == 0)
+    {
+        fprintf(stderr, "%s: empty trace\n", firmware->name);
+        return 0;
+    }
+
+    for (offset = 0; offset < length; offset++)
+    {
+        uint8_t count = PacketDecoder_Push(&decoder, stream[offset]);
+        uint64_t sent_ns = count ? ByteSentNs(offset + 1, byte_ns) : 0;
+
+        for (i = 0; i < count; i++)
+        {
+            uint32_t index = SampleIndex(&decoder.samples[i]);
+            if (index < INDEX_COUNT && received[index]++ == 0 && ready_ns[index] &&
+                sent_ns != UINT64_MAX && sent_ns >= ready_ns[index])
+            {
+                latency_ms[index] = (double)(sent_ns - ready_ns[index]) / NS_PER_MS;
+            }
+        }
+    }
+
+    // Samples produced in the window: indices first ... last, the ones the
+    // sensor overwrote before producing them included
+    for (i = 0; i < INDEX_COUNT; i++)
+    {
+        if (ready_ns[i] >= WARMUP_MS * NS_PER_MS && ready_ns[i] < (RUN_MS - TAIL_MS) * NS_PER_MS)
+        {
+            first = i < first ? i : first;
+            last = i;
+        }
+    }
+    memset(result, 0, sizeof(*result));
+    for (i = first; i <= last && first < INDEX_COUNT; i++)
+    {
+        if (received[i] == 0)
+        {
+            result->dropped++;
+            continue;
+        }
+        result->duplicated += received[i] - 1;
+        distinct++;
+        if (latency_ms[i] < 0)
+        {
+            result->untimed++;
+            continue;
+        }
+        window_latency[latencies++] = latency_ms[i];
+    }
+    qsort(window_latency, latencies, sizeof(double), CompareDouble);
+    result->samples_per_s = distinct * 1000.0 / (RUN_MS - WARMUP_MS - TAIL_MS);
+    result->latency[0] = Percentile(window_latency, latencies, 0.50);
+    result->latency[1] = Percentile(window_latency, latencies, 0.95);
+    result->latency[2] = Percentile(window_latency, latencies, 0.99);
+    result->latency[3] = latencies ? window_latency[latencies - 1] : 0;
+    result->awake_pct = total_ns ? 100.0 * (total_ns - sleep_ns) / total_ns : 0;
+    result->wakeups_per_s = total_ns ? (double)wakeups * NS_PER_S / total_ns : 0;
+    result->overwritten = overwritten_end - overwritten_start;
+    result->crc_errors = decoder.stats.crc_errors;
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    static uint16_t given_odr[LIS3DH_ODR_COUNT];
+    Firmware firmware[FORMAT_MAX];
+    uint8_t formats = 0;
+    uint8_t quick = 0;
+    const uint16_t* odr = full_odr;
+    size_t odr_count = sizeof(full_odr) / sizeof(full_odr[0]);
+    const uint32_t* baud = full_baud;
+    size_t baud_count = sizeof(full_baud) / sizeof(full_baud[0]);
+    int failures = 0;
+    int i;
+    size_t o;
+    size_t s;
+    size_t b;
+    uint8_t f;
+
+    for (i = 1; i < argc; i++)
+    {
+        char* equal = strchr(argv[i], '=');
+        if (strcmp(argv[i], "--quick") == 0)
+        {
+            quick = 1;
+        }
+        else if (strncmp(argv[i], "--odr=", 6) == 0)
+        {
+            char* next = argv[i] + 6;
+            odr = given_odr;
+            odr_count = 0;
+            while (*next != '\0' && odr_count < LIS3DH_ODR_COUNT)
+            {
+                given_odr[odr_count++] = (uint16_t)strtoul(next, &next, 10);
+                next += *next == ',';
+            }
+        }
+        else if (equal != NULL && formats < FORMAT_MAX)
+        {
+            *equal = '\0';
+            firmware[formats].name = argv[i];
+            firmware[formats].path = equal + 1;
+            formats++;
+        }
+    }
+    if (formats == 0)
+    {
+        fprintf(stderr, "usage: %s [--quick] [--odr=hz,...] name=firmware ...\n", argv[0]);
+        return 2;
+    }
+    if (quick)
+    {
+        if (odr != given_odr)
+        {
+            odr = quick_odr;
+            odr_count = sizeof(quick_odr) / sizeof(quick_odr[0]);
+        }
+        baud = quick_baud;
+        baud_count = sizeof(quick_baud) / sizeof(quick_baud[0]);
+    }
+
+    snprintf(waveform_file, sizeof(waveform_file), FILE_PREFIX "%ld_waveform.csv", (long)getpid());
+    snprintf(trace_file, sizeof(trace_file), FILE_PREFIX "%ld_trace.txt", (long)getpid());
+    snprintf(eeprom_file, sizeof(eeprom_file), FILE_PREFIX "%ld_eeprom.bin", (long)getpid());
+    WriteWaveform();
+    printf("format,odr_hz,i2c_khz,baud,samples_per_s,dropped,duplicated,"
+           "latency_p50_ms,latency_p95_ms,latency_p99_ms,latency_max_ms,awake_pct,wakeups_per_s,crc_errors,untimed,"
+           "overwritten\n");
+    for (f = 0; f < formats; f++)
+    {
+        for (o = 0; o < odr_count; o++)
+        {
+            for (s = 0; s < sizeof(full_i2c) / sizeof(full_i2c[0]); s++)
+            {
+                for (b = 0; b < baud_count; b++)
+                {
+                    Result result;
+                    if (!Run(&firmware[f], odr[o], full_i2c[s], baud[b], &result))
+                    {
+                        fprintf(stderr, "%s at %u Hz, %u kHz, %u baud: run failed\n", firmware[f].name,
+                                odr[o], full_i2c[s], (unsigned)baud[b]);
+                        failures++;
+                        continue;
+                    }
+                    printf("%s,%u,%u,%u,%.1f,%u,%u,%.3f,%.3f,%.3f,%.3f,%.1f,%.1f,%u,%u,%u\n",
+                           firmware[f].name, odr[o], full_i2c[s], (unsigned)baud[b],
+                           result.samples_per_s, (unsigned)result.dropped, (unsigned)result.duplicated,
+                           result.latency[0], result.latency[1], result.latency[2], result.latency[3],
+                           result.awake_pct, result.wakeups_per_s, (unsigned)result.crc_errors,
+                           (unsigned)result.untimed, (unsigned)result.overwritten);
+                    fflush(stdout);
+                    // Every sample sent is a new one, timed by the trace, and
+                    // every frame is intact
+                    failures += result.duplicated != 0 || result.crc_errors != 0 ||
+                                result.untimed != 0 || result.samples_per_s == 0;
+                }
+            }
+        }
+    }
+    remove(waveform_file);
+    remove(trace_file);
+    remove(eeprom_file);
+    return failures != 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,72 @@
+/*
+* MARCO MAESTRONI
+*
+* Host report of the I2C bus cost of one accelerometer sample: the
+* previous access pattern (three 2-byte reads of the outputs and one read
+* of STATUS_REG) against the single STATUS_REG ... OUT_Z_H burst.
+*
+* Build from this folder with:
+*   cc -DI2C_BUS_STATS_ENABLED=1 -I. -I.. -o BusCycleReport BusCycleReport.c \
+*      I2C_Interface_Host.c Lis3dhSim.c ../I2C_BusStats.c ../LIS3DH_Driver.c -lm
+*/
+
+#include <stdio.h>
+#include "I2C_Interface.h"
+#include "I2C_BusStats.h"
+#include "LIS3DH_Driver.h"
+#include "Lis3dhSim.h"
+
+#define SAMPLES 200
+
+static void ReadSampleSeparately(LIS3DH_Sample* sample)
+{
+    uint8_t data[2];
+
+    I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS, LIS3DH_OUT_X_L, 2, data);
+    sample->x = (int16_t)(data[0] | (data[1] << 8));
+    I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS, LIS3DH_OUT_Y_L, 2, data);
+    sample->y = (int16_t)(data[0] | (data[1] << 8));
+    I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS, LIS3DH_OUT_Z_L, 2, data);
+    sample->z = (int16_t)(data[0] | (data[1] << 8));
+    I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_STATUS_REG, &sample->status);
+}
+
+static uint32_t Measure(const char* name, void (*read)(LIS3DH_Sample*))
+{
+    LIS3DH_Sample sample;
+    I2C_BusStats stats;
+    int i;
+
+    I2C_BusStats_Reset();
+    for (i = 0; i < SAMPLES; i++)
+    {
+        Lis3dhSim_SetOutput((int16_t)(i << 4), (int16_t)(-i << 4), 1000 << 4);
+        read(&sample);
+    }
+    I2C_BusStats_Get(&stats);
+
+    uint32_t cycles = I2C_BusStats_Cycles(&stats);
+    printf("%-10s %6u transactions %7u bytes %8u SCL cycles (%u per sample)\n",
+           name, (unsigned)stats.transactions, (unsigned)stats.bytes,
+           (unsigned)cycles, (unsigned)(cycles / SAMPLES));
+    return cycles;
+}
+
+static void ReadSampleBurst(LIS3DH_Sample* sample)
+{
+    LIS3DH_ReadSample(sample);
+}
+
+int main(void)
+{
+    I2C_Peripheral_Start();
+
+    printf("I2C cost of %d samples\n", SAMPLES);
+    uint32_t separate = Measure("separate", ReadSampleSeparately);
+    uint32_t burst = Measure("burst", ReadSampleBurst);
+    printf("bus time saving: %.2fx\n", (double)separate / (double)burst);
+
+    return 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,325 @@
+/*
+* MARCO MAESTRONI
+*
+* Column file of the decoded samples
+*/
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "CaptureFile.h"
+
+// Offsets of the columns in a chunk
+#define COLUMN_T (CAPTURE_CHUNK_HEADER_LENGTH)
+#define COLUMN_X (COLUMN_T + CAPTURE_CHUNK_SAMPLES * 8)
+#define COLUMN_Y (COLUMN_X + CAPTURE_CHUNK_SAMPLES * 2)
+#define COLUMN_Z (COLUMN_Y + CAPTURE_CHUNK_SAMPLES * 2)
+
+static void Put16(uint8_t* data, uint16_t value)
+{
+    data[0] = (uint8_t)value;
+    data[1] = (uint8_t)(value >> 8);
+}
+
+static void Put32(uint8_t* data, uint32_t value)
+{
+    Put16(data, (uint16_t)value);
+    Put16(data + 2, (uint16_t)(value >> 16));
+}
+
+static void PutDouble(uint8_t* data, double value)
+{
+    uint64_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    Put32(data, (uint32_t)bits);
+    Put32(data + 4, (uint32_t)(bits >> 32));
+}
+
+static uint16_t Get16(const uint8_t* data)
+{
+    return (uint16_t)(data[0] | data[1] << 8);
+}
+
+static uint32_t Get32(const uint8_t* data)
+{
+    return Get16(data) | (uint32_t)Get16(data + 2) << 16;
+}
+
+static double GetDouble(const uint8_t* data)
+{
+    uint64_t bits = Get32(data) | (uint64_t)Get32(data + 4) << 32;
+    double value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+ErrorCode CaptureWriter_Open(CaptureWriter* writer, const char* path)
+{
+    uint8_t header[CAPTURE_HEADER_LENGTH] = {0};
+
+    memset(writer, 0, sizeof(*writer));
+    // Read back when the index is written
+    writer->file = fopen(path, "w+b");
+    if (writer->file == NULL)
+    {
+        return ERROR;
+    }
+    memcpy(header, CAPTURE_MAGIC, 8);
+    Put16(&header[8], CAPTURE_VERSION);
+    Put16(&header[10], CAPTURE_CHUNK_SAMPLES);
+    if (fwrite(header, 1, sizeof(header), writer->file) != sizeof(header))
+    {
+        return ERROR;
+    }
+    return NO_ERROR;
+}
+
+ErrorCode CaptureWriter_Flush(CaptureWriter* writer)
+{
+    long offset = CAPTURE_HEADER_LENGTH + (long)(writer->chunks - 1) * CAPTURE_CHUNK_LENGTH;
+
+    if (!writer->dirty)
+    {
+        return NO_ERROR;
+    }
+    Put32(&writer->chunk[0], writer->count);
+    if (fseek(writer->file, offset, SEEK_SET) != 0 ||
+        fwrite(writer->chunk, 1, CAPTURE_CHUNK_LENGTH, writer->file) != CAPTURE_CHUNK_LENGTH ||
+        fflush(writer->file) != 0)
+    {
+        return ERROR;
+    }
+    writer->dirty = 0;
+    return NO_ERROR;
+}
+
+ErrorCode CaptureWriter_Add(CaptureWriter* writer, double timestamp,
+                            int16_t x, int16_t y, int16_t z, uint8_t odr, uint8_t unit,
+                            uint8_t g, uint8_t mg_per_digit)
+{
+    ErrorCode error = NO_ERROR;
+    uint32_t i;
+
+    if (writer->count == CAPTURE_CHUNK_SAMPLES ||
+        (writer->count > 0 && (odr != writer->odr || unit != writer->unit ||
+                               g != writer->g || mg_per_digit != writer->mg_per_digit)))
+    {
+        error = CaptureWriter_Flush(writer);
+        writer->count = 0;
+    }
+    if (writer->count == 0)
+    {
+        memset(writer->chunk, 0, sizeof(writer->chunk));
+        writer->chunk[4] = odr;
+        writer->chunk[5] = unit;
+        writer->chunk[6] = g;
+        writer->chunk[7] = mg_per_digit;
+        PutDouble(&writer->chunk[8], timestamp);
+        writer->odr = odr;
+        writer->unit = unit;
+        writer->g = g;
+        writer->mg_per_digit = mg_per_digit;
+        writer->chunks++;
+    }
+
+    i = writer->count++;
+    PutDouble(&writer->chunk[16], timestamp);
+    PutDouble(&writer->chunk[COLUMN_T + i * 8], timestamp);
+    Put16(&writer->chunk[COLUMN_X + i * 2], (uint16_t)x);
+    Put16(&writer->chunk[COLUMN_Y + i * 2], (uint16_t)y);
+    Put16(&writer->chunk[COLUMN_Z + i * 2], (uint16_t)z);
+    writer->samples++;
+    writer->dirty = 1;
+    return error;
+}
+
+ErrorCode CaptureWriter_Close(CaptureWriter* writer)
+{
+    const long index = CAPTURE_HEADER_LENGTH + (long)writer->chunks * CAPTURE_CHUNK_LENGTH;
+    uint8_t entry[CAPTURE_CHUNK_HEADER_LENGTH];
+    uint8_t trailer[CAPTURE_INDEX_TRAILER_LENGTH];
+    ErrorCode error = CaptureWriter_Flush(writer);
+    uint32_t k;
+
+    // The index entries are the chunk headers, copied from the file
+    for (k = 0; k < writer->chunks && error == NO_ERROR; k++)
+    {
+        if (fseek(writer->file, CAPTURE_HEADER_LENGTH + (long)k * CAPTURE_CHUNK_LENGTH, SEEK_SET) != 0 ||
+            fread(entry, 1, sizeof(entry), writer->file) != sizeof(entry) ||
+            fseek(writer->file, index + (long)k * CAPTURE_CHUNK_HEADER_LENGTH, SEEK_SET) != 0 ||
+            fwrite(entry, 1, sizeof(entry), writer->file) != sizeof(entry))
+        {
+            error = ERROR;
+        }
+    }
+    Put32(&trailer[0], writer->chunks);
+    Put32(&trailer[4], writer->samples);
+    memcpy(&trailer[8], CAPTURE_INDEX_MAGIC, 8);
+    if (error != NO_ERROR ||
+        fseek(writer->file, index + (long)writer->chunks * CAPTURE_CHUNK_HEADER_LENGTH, SEEK_SET) != 0 ||
+        fwrite(trailer, 1, sizeof(trailer), writer->file) != sizeof(trailer))
+    {
+        error = ERROR;
+    }
+
+    if (fclose(writer->file) != 0)
+    {
+        error = ERROR;
+    }
+    writer->file = NULL;
+    return error;
+}
+
+ErrorCode CaptureReader_Open(CaptureReader* reader, const char* path)
+{
+    const uint8_t* trailer;
+    struct stat status;
+    void* data;
+    uint32_t k;
+    int fd;
+
+    memset(reader, 0, sizeof(*reader));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    (void)path;
+    return ERROR;
+#endif
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return ERROR;
+    }
+    if (fstat(fd, &status) != 0 || status.st_size < CAPTURE_HEADER_LENGTH)
+    {
+        close(fd);
+        return ERROR;
+    }
+    data = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping holds its own reference to the file
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return ERROR;
+    }
+    reader->data = data;
+    reader->length = (size_t)status.st_size;
+    if (memcmp(reader->data, CAPTURE_MAGIC, 8) != 0 ||
+        Get16(&reader->data[8]) < 1 || Get16(&reader->data[8]) > CAPTURE_VERSION ||
+        Get16(&reader->data[10]) != CAPTURE_CHUNK_SAMPLES)
+    {
+        CaptureReader_Close(reader);
+        return ERROR;
+    }
+
+    trailer = reader->data + reader->length - CAPTURE_INDEX_TRAILER_LENGTH;
+    if (reader->length >= CAPTURE_HEADER_LENGTH + CAPTURE_INDEX_TRAILER_LENGTH &&
+        memcmp(&trailer[8], CAPTURE_INDEX_MAGIC, 8) == 0 &&
+        reader->length == CAPTURE_HEADER_LENGTH + CAPTURE_INDEX_TRAILER_LENGTH +
+            (size_t)Get32(trailer) * (CAPTURE_CHUNK_LENGTH + CAPTURE_CHUNK_HEADER_LENGTH))
+    {
+        reader->indexed = 1;
+        reader->chunks = Get32(trailer);
+        reader->samples = Get32(&trailer[4]);
+        reader->index = reader->data + CAPTURE_HEADER_LENGTH + (size_t)reader->chunks * CAPTURE_CHUNK_LENGTH;
+        reader->stride = CAPTURE_CHUNK_HEADER_LENGTH;
+        return NO_ERROR;
+    }
+
+    // No index: the complete chunks are used, their headers read in place
+    reader->chunks = (uint32_t)((reader->length - CAPTURE_HEADER_LENGTH) / CAPTURE_CHUNK_LENGTH);
+    reader->index = reader->data + CAPTURE_HEADER_LENGTH;
+    reader->stride = CAPTURE_CHUNK_LENGTH;
+    for (k = 0; k < reader->chunks; k++)
+    {
+        reader->samples += Get32(reader->index + (size_t)k * reader->stride);
+    }
+    return NO_ERROR;
+}
+
+ErrorCode CaptureReader_Chunk(const CaptureReader* reader, uint32_t index, CaptureChunk* chunk)
+{
+    const uint8_t* entry;
+    const uint8_t* columns;
+
+    if (index >= reader->chunks)
+    {
+        return ERROR;
+    }
+    entry = reader->index + (size_t)index * reader->stride;
+    columns = reader->data + CAPTURE_HEADER_LENGTH + (size_t)index * CAPTURE_CHUNK_LENGTH;
+    chunk->count = Get32(entry);
+    chunk->odr = entry[4];
+    chunk->unit = entry[5];
+    chunk->g = entry[6];
+    chunk->mg_per_digit = entry[7];
+    chunk->first = GetDouble(&entry[8]);
+    chunk->last = GetDouble(&entry[16]);
+    if (chunk->count > CAPTURE_CHUNK_SAMPLES)
+    {
+        return ERROR;
+    }
+    // The chunks and their columns are at multiples of 8 bytes from the
+    // start of the mapping, which is page aligned
+    chunk->t = (const double*)(columns + COLUMN_T);
+    chunk->x = (const int16_t*)(columns + COLUMN_X);
+    chunk->y = (const int16_t*)(columns + COLUMN_Y);
+    chunk->z = (const int16_t*)(columns + COLUMN_Z);
+    return NO_ERROR;
+}
+
+void CaptureReader_Seek(const CaptureReader* reader, double time, uint32_t* chunk, uint32_t* sample)
+{
+    CaptureChunk found;
+    uint32_t low = 0;
+    uint32_t high = reader->chunks;
+
+    // First chunk ending at or after time
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        if (GetDouble(reader->index + (size_t)middle * reader->stride + 16) < time)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    *chunk = low;
+    *sample = 0;
+    if (CaptureReader_Chunk(reader, low, &found) != NO_ERROR)
+    {
+        return;
+    }
+
+    high = found.count;
+    low = 0;
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        if (found.t[middle] < time)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    *sample = low;
+}
+
+void CaptureReader_Close(CaptureReader* reader)
+{
+    if (reader->data != NULL)
+    {
+        munmap((void*)reader->data, reader->length);
+    }
+    memset(reader, 0, sizeof(*reader));
+}
+
+/* [] END OF FILE */
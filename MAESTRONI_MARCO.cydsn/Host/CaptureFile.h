@@ -0,0 +1,239 @@
+/**
+*   \file CaptureFile.h
+*   \brief Column file of the decoded samples, to be memory-mapped.
+*
+*   The file is a header followed by chunks of the same size, so that
+*   chunk k is at CAPTURE_HEADER_LENGTH + k * CAPTURE_CHUNK_LENGTH and the
+*   file can be mapped and indexed without being parsed. All the fields
+*   are little endian.
+*
+*   Header (CAPTURE_HEADER_LENGTH bytes):
+*
+*   | Byte   | Content                                           |
+*   |--------|---------------------------------------------------|
+*   | 0..7   | CAPTURE_MAGIC                                     |
+*   | 8..9   | CAPTURE_VERSION                                   |
+*   | 10..11 | samples per chunk, CAPTURE_CHUNK_SAMPLES          |
+*   | 12..15 | 0                                                 |
+*
+*   Chunk (CAPTURE_CHUNK_LENGTH bytes), samples of one data rate and unit:
+*
+*   | Byte   | Content                                           |
+*   |--------|---------------------------------------------------|
+*   | 0..3   | count of samples, 1 ... CAPTURE_CHUNK_SAMPLES     |
+*   | 4      | ODR code (index in LIS3DH_OdrTable)               |
+*   | 5      | unit, CAPTURE_UNIT_RAW or CAPTURE_UNIT_MMS2       |
+*   | 6      | full-scale range in g, 0 if not known             |
+*   | 7      | mg/digit of X, Y and Z in CAPTURE_UNIT_RAW, 0 if  |
+*   |        | not known                                         |
+*   | 8..15  | time of the first sample in ms, IEEE 754 double   |
+*   | 16..23 | time of the last sample in ms, IEEE 754 double    |
+*   | 24..   | columns of CAPTURE_CHUNK_SAMPLES entries each:    |
+*   |        | time in ms (double), X, Y and Z (int16)           |
+*
+*   With the range and the sensitivity the raw outputs are converted
+*   without the frames they came from; the files of version 1 have
+*   neither. The entries of a column past count are 0. The chunk being filled is
+*   rewritten in place at every CaptureWriter_Flush, so that the file
+*   read during a recording holds every sample flushed so far.
+*
+*   Index, written after the last chunk by CaptureWriter_Close:
+*
+*   | Byte      | Content                                        |
+*   |-----------|------------------------------------------------|
+*   | 0..       | bytes 0..23 of every chunk, in order           |
+*   | +0..3     | count of chunks                                |
+*   | +4..7     | count of samples                               |
+*   | +8..15    | CAPTURE_INDEX_MAGIC                            |
+*
+*   A reader finds the time range of every chunk in the index without
+*   touching the chunks; a file with no index (recording in progress or
+*   interrupted) is read through the chunk headers instead. The times are
+*   expected to increase through the file, as the timestamps of the
+*   frames do.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __CAPTUREFILE_H
+    #define __CAPTUREFILE_H
+
+    #include <stdio.h>
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief First bytes of a capture file.
+    */
+    #define CAPTURE_MAGIC "LIS3DCAP"
+
+    /**
+    *   \brief Version of the layout.
+    */
+    #define CAPTURE_VERSION 2
+
+    /**
+    *   \brief Last bytes of a capture file with an index.
+    */
+    #define CAPTURE_INDEX_MAGIC "LIS3DIDX"
+
+    /**
+    *   \brief Bytes after the entries of the index.
+    */
+    #define CAPTURE_INDEX_TRAILER_LENGTH 16
+
+    /**
+    *   \brief Bytes of the file header.
+    */
+    #define CAPTURE_HEADER_LENGTH 16
+
+    /**
+    *   \brief Samples per chunk.
+    */
+    #define CAPTURE_CHUNK_SAMPLES 4096
+
+    /**
+    *   \brief Bytes of the chunk header.
+    */
+    #define CAPTURE_CHUNK_HEADER_LENGTH 24
+
+    /**
+    *   \brief Bytes of a chunk.
+    */
+    #define CAPTURE_CHUNK_LENGTH (CAPTURE_CHUNK_HEADER_LENGTH + CAPTURE_CHUNK_SAMPLES * (8 + 3 * 2))
+
+    /**
+    *   \brief X, Y and Z are 12-bit right-justified raw outputs.
+    */
+    #define CAPTURE_UNIT_RAW  0
+
+    /**
+    *   \brief X, Y and Z are in m/s^2 x 1000 (version 1 frames).
+    */
+    #define CAPTURE_UNIT_MMS2 1
+
+    /**
+    *   \brief Writer state.
+    */
+    typedef struct {
+        FILE* file;
+        uint32_t chunks;        ///< Chunks started, the last one being filled
+        uint32_t samples;       ///< Samples added
+        uint32_t count;         ///< Samples in the chunk being filled
+        uint8_t odr;            ///< Data rate of the chunk being filled
+        uint8_t unit;           ///< Unit of the chunk being filled
+        uint8_t g;              ///< Full-scale range of the chunk being filled
+        uint8_t mg_per_digit;   ///< Sensitivity of the chunk being filled
+        uint8_t dirty;          ///< Samples added since the chunk was written
+        uint8_t chunk[CAPTURE_CHUNK_LENGTH];    ///< Chunk being filled
+    } CaptureWriter;
+
+    /**
+    *   \brief Chunk of a mapped file.
+    *
+    *   The columns point into the mapping and are valid until
+    *   CaptureReader_Close.
+    */
+    typedef struct {
+        uint32_t count;         ///< Samples in the chunk
+        uint8_t odr;            ///< Index of the data rate in LIS3DH_OdrTable
+        uint8_t unit;           ///< CAPTURE_UNIT_RAW or CAPTURE_UNIT_MMS2
+        uint8_t g;              ///< Full-scale range in g, 0 if not known
+        uint8_t mg_per_digit;   ///< mg/digit of the raw outputs, 0 if not known
+        double first;           ///< Time of the first sample in ms
+        double last;            ///< Time of the last sample in ms
+        const double* t;        ///< Times in ms, count entries
+        const int16_t* x;       ///< X outputs, count entries
+        const int16_t* y;       ///< Y outputs, count entries
+        const int16_t* z;       ///< Z outputs, count entries
+    } CaptureChunk;
+
+    /**
+    *   \brief Reader state.
+    */
+    typedef struct {
+        const uint8_t* data;    ///< Mapped file
+        size_t length;          ///< Bytes mapped
+        uint32_t chunks;        ///< Chunks in the file
+        uint32_t samples;       ///< Samples in the file
+        uint8_t indexed;        ///< The file has an index
+        const uint8_t* index;   ///< Header of the first chunk, in the index or in the chunk
+        size_t stride;          ///< Bytes from one chunk header to the next
+    } CaptureReader;
+
+    /**
+    *   \brief Create the file and write its header.
+    *   \param writer Writer to initialise.
+    *   \param path File to create (truncated if it exists).
+    *   \retval ERROR if the file cannot be written.
+    */
+    ErrorCode CaptureWriter_Open(CaptureWriter* writer, const char* path);
+
+    /**
+    *   \brief Add one sample.
+    *
+    *   A new chunk is started when the current one is full or when the
+    *   data rate, the unit or the sensitivity change; the full one is
+    *   written.
+    *   \param timestamp Time of the sample in ms.
+    *   \param x, y, z Outputs, in the given unit.
+    *   \param odr Index of the data rate in LIS3DH_OdrTable.
+    *   \param unit CAPTURE_UNIT_RAW or CAPTURE_UNIT_MMS2.
+    *   \param g Full-scale range in g, 0 if not known.
+    *   \param mg_per_digit mg/digit of the raw outputs, 0 if not known.
+    *   \retval ERROR if a chunk cannot be written.
+    */
+    ErrorCode CaptureWriter_Add(CaptureWriter* writer, double timestamp,
+                                int16_t x, int16_t y, int16_t z, uint8_t odr, uint8_t unit,
+                                uint8_t g, uint8_t mg_per_digit);
+
+    /**
+    *   \brief Write the chunk being filled, if samples were added to it.
+    *   \retval ERROR if the chunk cannot be written.
+    */
+    ErrorCode CaptureWriter_Flush(CaptureWriter* writer);
+
+    /**
+    *   \brief Flush, write the index and close the file.
+    *   \retval ERROR if the last chunk or the index cannot be written.
+    */
+    ErrorCode CaptureWriter_Close(CaptureWriter* writer);
+
+    /**
+    *   \brief Map a capture file.
+    *
+    *   Only the header and the index are read: the chunks are paged in as
+    *   their columns are used. The columns are used in place, which needs
+    *   a little-endian host.
+    *   \param reader Reader to initialise.
+    *   \param path File written by CaptureWriter, of any version up to
+    *   CAPTURE_VERSION, complete or not.
+    *   \retval ERROR if the file cannot be mapped or is not a capture file.
+    */
+    ErrorCode CaptureReader_Open(CaptureReader* reader, const char* path);
+
+    /**
+    *   \brief Get a chunk.
+    *   \param index Chunk, 0 ... chunks - 1.
+    *   \param chunk Pointer to the structure where the chunk will be described.
+    *   \retval ERROR if there is no such chunk.
+    */
+    ErrorCode CaptureReader_Chunk(const CaptureReader* reader, uint32_t index, CaptureChunk* chunk);
+
+    /**
+    *   \brief Find the first sample at or after a time.
+    *
+    *   Binary search of the index, then of the times of one chunk.
+    *   \param time Time in ms.
+    *   \param chunk Chunk of the sample, chunks if every sample is earlier.
+    *   \param sample Sample in the chunk.
+    */
+    void CaptureReader_Seek(const CaptureReader* reader, double time, uint32_t* chunk, uint32_t* sample);
+
+    /**
+    *   \brief Unmap the file.
+    */
+    void CaptureReader_Close(CaptureReader* reader);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,274 @@
+/*
+* MARCO MAESTRONI
+*
+* Host check and benchmark of the column file: an hour of 200 Hz samples
+* is written both as a column file (Host/CaptureFile.h) and as the CSV
+* file of PacketRecord. Both are loaded back and must give the samples
+* that were written; the column file must also be readable through its
+* chunk headers while it is being written, before it has an index, and
+* a seek to any time must land on the first sample at or after it.
+*
+* The load times are measured with the files in the page cache: the CSV
+* file has to be parsed whole, the column file is mapped and its columns
+* are used in place. The seek is what reading a short time range of a
+* long recording costs.
+*
+* Build from this folder with:
+*   cc -O2 -I. -I.. -o CaptureReport CaptureReport.c CaptureFile.c
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "CaptureFile.h"
+
+#define SAMPLES   (200 * 3600)
+#define PERIOD_MS 5
+// The data rate changes for the second half, as with the button
+#define ODR_FIRST 5
+#define ODR_LAST  6
+// Range and sensitivity of the 12-bit outputs
+#define RANGE_G      2
+#define MG_PER_DIGIT 1
+
+#define SEEKS     10000
+
+#define CAPTURE_PATH "capture_report.cap"
+#define CSV_PATH     "capture_report.csv"
+
+typedef struct {
+    double t;
+    int64_t x;
+    int64_t y;
+    int64_t z;
+} Sums;
+
+static int failures;
+
+static double seeks[SEEKS];
+static volatile uint32_t sink;
+
+static void Check(const char* name, uint32_t value, uint32_t expected)
+{
+    printf("%-14s %8u (expected %8u) %s\n", name, (unsigned)value, (unsigned)expected,
+           value == expected ? "ok" : "FAILED");
+    failures += value != expected;
+}
+
+static double Seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static double FileMB(const char* path)
+{
+    struct stat status;
+    return stat(path, &status) == 0 ? status.st_size / 1e6 : 0;
+}
+
+static double Time(uint32_t i)
+{
+    return (double)i * PERIOD_MS;
+}
+
+// 12-bit right-justified raw outputs
+static int16_t Axis(uint32_t i, uint32_t axis)
+{
+    return (int16_t)(((i * 2654435761u) >> (axis * 8)) % 4096 - 2048);
+}
+
+static uint8_t Odr(uint32_t i)
+{
+    return i < SAMPLES / 2 ? ODR_FIRST : ODR_LAST;
+}
+
+static void Add(Sums* sums, double t, int16_t x, int16_t y, int16_t z)
+{
+    sums->t += t;
+    sums->x += x;
+    sums->y += y;
+    sums->z += z;
+}
+
+static uint32_t SameSums(const Sums* a, const Sums* b)
+{
+    return a->t == b->t && a->x == b->x && a->y == b->y && a->z == b->z;
+}
+
+static uint32_t SumCapture(const CaptureReader* reader, Sums* sums, uint32_t* odr_errors)
+{
+    CaptureChunk chunk;
+    uint32_t samples = 0;
+    uint32_t k;
+    uint32_t i;
+
+    memset(sums, 0, sizeof(*sums));
+    *odr_errors = 0;
+    for (k = 0; CaptureReader_Chunk(reader, k, &chunk) == NO_ERROR; k++)
+    {
+        for (i = 0; i < chunk.count; i++)
+        {
+            Add(sums, chunk.t[i], chunk.x[i], chunk.y[i], chunk.z[i]);
+        }
+        *odr_errors += chunk.odr != Odr(samples) || chunk.odr != Odr(samples + chunk.count - 1) ||
+                       chunk.first != chunk.t[0] || chunk.last != chunk.t[chunk.count - 1] ||
+                       chunk.g != RANGE_G || chunk.mg_per_digit != MG_PER_DIGIT;
+        samples += chunk.count;
+    }
+    return samples;
+}
+
+int main(void)
+{
+    static CaptureWriter writer;
+    CaptureReader reader;
+    CaptureChunk chunk;
+    Sums written = {0};
+    Sums loaded = {0};
+    char line[128];
+    FILE* csv;
+    uint32_t samples;
+    uint32_t odr_errors;
+    uint32_t seek_errors = 0;
+    uint32_t k;
+    uint32_t s;
+    uint32_t i;
+    double start;
+    double csv_seconds;
+    double capture_seconds;
+    double seek_seconds;
+
+    // Written as PacketRecord writes them
+    csv = fopen(CSV_PATH, "w");
+    if (csv == NULL || CaptureWriter_Open(&writer, CAPTURE_PATH) != NO_ERROR)
+    {
+        perror("capture_report");
+        return 1;
+    }
+    fprintf(csv, "timestamp_ms,seq,odr,x,y,z\n");
+    for (i = 0; i < SAMPLES; i++)
+    {
+        int16_t x = Axis(i, 0);
+        int16_t y = Axis(i, 1);
+        int16_t z = Axis(i, 2);
+
+        CaptureWriter_Add(&writer, Time(i), x, y, z, Odr(i), CAPTURE_UNIT_RAW, RANGE_G, MG_PER_DIGIT);
+        fprintf(csv, "%.3f,%u,%u,%d,%d,%d\n", Time(i), (unsigned)(i & 0xFF), (unsigned)Odr(i), x, y, z);
+        Add(&written, Time(i), x, y, z);
+
+        // A third of the way, the file is read as it would be during a recording
+        if (i == SAMPLES / 3)
+        {
+            CaptureWriter_Flush(&writer);
+            if (CaptureReader_Open(&reader, CAPTURE_PATH) != NO_ERROR)
+            {
+                printf("cannot read the file being written\n");
+                return 1;
+            }
+            samples = SumCapture(&reader, &loaded, &odr_errors);
+            Check("recording idx", reader.indexed, 0);
+            Check("recording", samples, i + 1);
+            Check("recording sum", SameSums(&loaded, &written), 1);
+            CaptureReader_Close(&reader);
+        }
+    }
+    if (CaptureWriter_Close(&writer) != NO_ERROR || fclose(csv) != 0)
+    {
+        perror("capture_report");
+        return 1;
+    }
+
+    // CSV: every row parsed
+    memset(&loaded, 0, sizeof(loaded));
+    samples = 0;
+    start = Seconds();
+    csv = fopen(CSV_PATH, "r");
+    if (csv == NULL || fgets(line, sizeof(line), csv) == NULL)
+    {
+        perror(CSV_PATH);
+        return 1;
+    }
+    while (fgets(line, sizeof(line), csv) != NULL)
+    {
+        char* field = line;
+        double t = strtod(field, &field);
+        int16_t x;
+        int16_t y;
+        int16_t z;
+
+        strtoul(field + 1, &field, 10);
+        strtoul(field + 1, &field, 10);
+        x = (int16_t)strtol(field + 1, &field, 10);
+        y = (int16_t)strtol(field + 1, &field, 10);
+        z = (int16_t)strtol(field + 1, &field, 10);
+        Add(&loaded, t, x, y, z);
+        samples++;
+    }
+    fclose(csv);
+    csv_seconds = Seconds() - start;
+    Check("csv samples", samples, SAMPLES);
+    Check("csv sum", SameSums(&loaded, &written), 1);
+
+    // Column file: mapped, every column read in place
+    start = Seconds();
+    if (CaptureReader_Open(&reader, CAPTURE_PATH) != NO_ERROR)
+    {
+        printf("cannot read %s\n", CAPTURE_PATH);
+        return 1;
+    }
+    samples = SumCapture(&reader, &loaded, &odr_errors);
+    capture_seconds = Seconds() - start;
+    Check("indexed", reader.indexed, 1);
+    Check("index samples", reader.samples, SAMPLES);
+    Check("samples", samples, SAMPLES);
+    Check("sum", SameSums(&loaded, &written), 1);
+    Check("chunk headers", odr_errors, 0);
+
+    // Seeks to random times, between the samples and out of the recording
+    srand(1);
+    for (i = 0; i < SEEKS; i++)
+    {
+        seeks[i] = (rand() % (SAMPLES * PERIOD_MS + 20)) - 10 + 0.5 * (rand() % 2);
+    }
+    start = Seconds();
+    for (i = 0; i < SEEKS; i++)
+    {
+        CaptureReader_Seek(&reader, seeks[i], &k, &s);
+        sink += k + s;
+    }
+    seek_seconds = Seconds() - start;
+    for (i = 0; i < SEEKS; i++)
+    {
+        uint32_t expected = seeks[i] <= 0 ? 0 : (uint32_t)((seeks[i] + PERIOD_MS - 1e-9) / PERIOD_MS);
+        uint32_t found = 0;
+        uint32_t c;
+
+        CaptureReader_Seek(&reader, seeks[i], &k, &s);
+        for (c = 0; c < k && CaptureReader_Chunk(&reader, c, &chunk) == NO_ERROR; c++)
+        {
+            found += chunk.count;
+        }
+        found += s;
+        seek_errors += found != (expected < SAMPLES ? expected : SAMPLES);
+    }
+    Check("seek errors", seek_errors, 0);
+    CaptureReader_Close(&reader);
+
+    printf("%u samples (%.0f min at %u Hz)\n", (unsigned)SAMPLES,
+           SAMPLES * PERIOD_MS / 60000.0, 1000 / PERIOD_MS);
+    printf("csv      %7.1f MB, loaded in %8.3f ms, %6.1f Msamples/s\n",
+           FileMB(CSV_PATH), csv_seconds * 1e3, SAMPLES / csv_seconds / 1e6);
+    printf("columns  %7.1f MB, loaded in %8.3f ms, %6.1f Msamples/s (%.0fx)\n",
+           FileMB(CAPTURE_PATH), capture_seconds * 1e3, SAMPLES / capture_seconds / 1e6,
+           csv_seconds / capture_seconds);
+    printf("seek     %.3f us\n", seek_seconds / SEEKS * 1e6);
+    remove(CSV_PATH);
+    remove(CAPTURE_PATH);
+    return failures != 0;
+}
+
+/* [] END OF FILE */
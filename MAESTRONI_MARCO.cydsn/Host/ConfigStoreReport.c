@@ -0,0 +1,111 @@
+/*
+* MARCO MAESTRONI
+*
+* Host report of the EEPROM wear of the configuration store against the
+* previous firmware, which wrote the startup register at every main loop
+* pass, and check of the recovery after power cycles and torn writes.
+*
+* Build from this folder with:
+*   cc -I. -I.. -o ConfigStoreReport ConfigStoreReport.c EepromSim.c \
+*      EEPROM_Interface_Host.c ../ConfigStore.c ../Crc8.c
+*/
+
+#include <stdio.h>
+#include "ConfigStore.h"
+#include "EepromSim.h"
+
+#define LOOP_PASSES      100000
+#define RECONFIGURATIONS 1000
+
+static const uint8_t ctrl_reg1[] = { 0x17, 0x27, 0x37, 0x47, 0x57, 0x67 };
+
+static int failures;
+
+static void Check(const char* name, int ok)
+{
+    printf("%-44s %s\n", name, ok ? "ok" : "FAILED");
+    failures += !ok;
+}
+
+// Power cycle: the store is started again on the EEPROM content
+static int Recovered(uint8_t expected)
+{
+    ConfigStore_Config config;
+    return ConfigStore_Start(&config) == NO_ERROR && config.ctrl_reg1 == expected;
+}
+
+int main(void)
+{
+    ConfigStore_Config config;
+    uint32_t i;
+
+    EepromSim_Erase();
+    Check("erased EEPROM has no record", ConfigStore_Start(&config) == ERROR);
+
+    // Startup register written by the firmware before the store
+    uint8_t legacy_row[EEPROM_PERIPHERAL_ROW_SIZE] = { 0 };
+    legacy_row[EEPROM_STARTUP_ADDRESS] = ctrl_reg1[4];
+    EepromSim_WriteRow(CONFIG_STORE_FIRST_ROW, legacy_row);
+    Check("legacy startup register is not a record", ConfigStore_Start(&config) == ERROR);
+    Check("legacy startup register readable",
+          ConfigStore_LegacyStartupRegister() == ctrl_reg1[4]);
+    EepromSim_Erase();
+    ConfigStore_Start(&config);
+
+    // Steady state: the main loop saves the same rate at every pass
+    config.ctrl_reg1 = ctrl_reg1[0];
+    for (i = 0; i < LOOP_PASSES; i++)
+    {
+        ConfigStore_Save(&config);
+        ConfigStore_Task();
+    }
+    printf("%u loop passes with the same rate: %u row writes (previous firmware: %u)\n",
+           (unsigned)LOOP_PASSES, (unsigned)EepromSim_RowWrites(), (unsigned)LOOP_PASSES);
+    Check("one write in steady state", EepromSim_RowWrites() == 1);
+    Check("rate recovered after power cycle", Recovered(ctrl_reg1[0]));
+
+    // Button presses: every save changes the rate
+    EepromSim_Erase();
+    ConfigStore_Start(&config);
+    for (i = 0; i < RECONFIGURATIONS; i++)
+    {
+        config.ctrl_reg1 = ctrl_reg1[i % sizeof(ctrl_reg1)];
+        ConfigStore_Save(&config);
+        ConfigStore_Task();
+    }
+    printf("%u rate changes over %d rows: max %u writes per cell (single cell: %u)\n",
+           (unsigned)RECONFIGURATIONS, CONFIG_STORE_ROW_COUNT,
+           (unsigned)EepromSim_MaxWriteCount(), (unsigned)RECONFIGURATIONS);
+    Check("writes spread over the rows",
+          EepromSim_MaxWriteCount() == (RECONFIGURATIONS + CONFIG_STORE_ROW_COUNT - 1) / CONFIG_STORE_ROW_COUNT);
+    Check("newest rate recovered", Recovered(config.ctrl_reg1));
+
+    // Saves requested while a write is in progress: only the last one is written
+    uint32_t before = EepromSim_RowWrites();
+    config.ctrl_reg1 = ctrl_reg1[1];
+    ConfigStore_Save(&config);
+    config.ctrl_reg1 = ctrl_reg1[2];
+    ConfigStore_Save(&config);
+    config.ctrl_reg1 = ctrl_reg1[3];
+    ConfigStore_Save(&config);
+    while (ConfigStore_Busy())
+    {
+        ConfigStore_Task();
+    }
+    Check("saves coalesced while writing", EepromSim_RowWrites() - before == 2);
+    Check("last coalesced rate recovered", Recovered(ctrl_reg1[3]));
+
+    // Power loss in the middle of a write
+    config.ctrl_reg1 = ctrl_reg1[4];
+    EepromSim_TearNextWrite(8);
+    ConfigStore_Save(&config);
+    ConfigStore_Task();
+    Check("torn record skipped, previous rate recovered", Recovered(ctrl_reg1[3]));
+    ConfigStore_Save(&config);
+    ConfigStore_Task();
+    Check("next save after torn record recovered", Recovered(ctrl_reg1[4]));
+
+    return failures ? 1 : 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,116 @@
+/*
+* MARCO MAESTRONI
+*
+* Conversion of arrays of LIS3DH outputs to m/s^2 on the host
+*/
+
+#include "ConvertBatch.h"
+
+// The vector kernels are compiled for their instruction set only, so
+// that the program still runs on a CPU without it
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #include <immintrin.h>
+    #define CONVERT_BATCH_X86 1
+#else
+    #define CONVERT_BATCH_X86 0
+#endif
+
+static void Scalar(const int16_t* raw, float* out, size_t count, uint8_t shift, float scale)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        out[i] = (float)(raw[i] >> shift) * scale;
+    }
+}
+
+#if CONVERT_BATCH_X86
+
+// 8 words per iteration: shifted on 16 bits, then sign-extended to 32
+__attribute__((target("sse2")))
+static void Sse2(const int16_t* raw, float* out, size_t count, uint8_t shift, float scale)
+{
+    const __m128i count_shift = _mm_cvtsi32_si128(shift);
+    const __m128 factor = _mm_set1_ps(scale);
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        __m128i words = _mm_sra_epi16(_mm_loadu_si128((const __m128i*)&raw[i]), count_shift);
+        __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+        __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16);
+
+        _mm_storeu_ps(&out[i], _mm_mul_ps(_mm_cvtepi32_ps(low), factor));
+        _mm_storeu_ps(&out[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(high), factor));
+    }
+    Scalar(&raw[i], &out[i], count - i, shift, scale);
+}
+
+// 16 words per iteration: sign-extended to 32 bits, then shifted
+__attribute__((target("avx2")))
+static void Avx2(const int16_t* raw, float* out, size_t count, uint8_t shift, float scale)
+{
+    const __m128i count_shift = _mm_cvtsi32_si128(shift);
+    const __m256 factor = _mm256_set1_ps(scale);
+    size_t i;
+
+    for (i = 0; i + 16 <= count; i += 16)
+    {
+        __m256i low = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)&raw[i]));
+        __m256i high = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)&raw[i + 8]));
+
+        low = _mm256_sra_epi32(low, count_shift);
+        high = _mm256_sra_epi32(high, count_shift);
+        _mm256_storeu_ps(&out[i], _mm256_mul_ps(_mm256_cvtepi32_ps(low), factor));
+        _mm256_storeu_ps(&out[i + 8], _mm256_mul_ps(_mm256_cvtepi32_ps(high), factor));
+    }
+    Scalar(&raw[i], &out[i], count - i, shift, scale);
+}
+
+#endif
+
+ConvertBatch_Entry ConvertBatch_Kernels[CONVERT_BATCH_KERNEL_COUNT] = {
+    { "scalar", Scalar, 1 },
+#if CONVERT_BATCH_X86
+    { "sse2", Sse2, 0 },
+    { "avx2", Avx2, 0 }
+#else
+    { "sse2", Scalar, 0 },
+    { "avx2", Scalar, 0 }
+#endif
+};
+
+static const ConvertBatch_Entry* selected;
+
+const ConvertBatch_Entry* ConvertBatch_Select(void)
+{
+    int k;
+
+    if (selected != NULL)
+    {
+        return selected;
+    }
+#if CONVERT_BATCH_X86
+    __builtin_cpu_init();
+    ConvertBatch_Kernels[1].supported = __builtin_cpu_supports("sse2") != 0;
+    ConvertBatch_Kernels[2].supported = __builtin_cpu_supports("avx2") != 0;
+#endif
+    for (k = CONVERT_BATCH_KERNEL_COUNT - 1; !ConvertBatch_Kernels[k].supported; k--)
+    {
+    }
+    selected = &ConvertBatch_Kernels[k];
+    return selected;
+}
+
+float ConvertBatch_Scale(const LIS3DH_Sensitivity* sensitivity)
+{
+    return (float)(sensitivity->mg_per_digit * (double)LIS3DH_CONVERT_GRAVITY_MMS2 / 1e6);
+}
+
+void ConvertBatch_Run(const int16_t* raw, float* out, size_t count, uint8_t shift, float scale)
+{
+    ConvertBatch_Select()->kernel(raw, out, count, shift, scale);
+}
+
+/* [] END OF FILE */
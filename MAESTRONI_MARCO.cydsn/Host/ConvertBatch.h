@@ -0,0 +1,79 @@
+/**
+*   \file ConvertBatch.h
+*   \brief Conversion of arrays of LIS3DH outputs to m/s^2 on the host.
+*
+*   The firmware converts one sample at a time (LIS3DH_Convert.h); the
+*   host converts whole columns of a capture at once. Each output word
+*   is shifted right by the shift of its range and mode and multiplied by
+*   the float sensitivity in m/s^2 per digit:
+*
+*       out[i] = (float)(raw[i] >> shift) * scale
+*
+*   The conversion of the shifted word to float is exact and the product
+*   is rounded once, so the SSE2 and AVX2 kernels give the same bits as
+*   the scalar one. The kernel is chosen at run time from what the CPU
+*   supports; ConvertBatch_Kernels lists them all for the checks.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __CONVERTBATCH_H
+    #define __CONVERTBATCH_H
+
+    #include <stddef.h>
+    #include "cytypes.h"
+    #include "LIS3DH_Convert.h"
+
+    /**
+    *   \brief Conversion of count words.
+    *
+    *   \param raw Output words, left-justified (shift of the range and
+    *   mode) or already right-justified (shift 0).
+    *   \param out count floats in m/s^2; may not overlap raw.
+    *   \param count Number of words, any alignment.
+    *   \param shift Right shift of the words, 0 ... 15.
+    *   \param scale m/s^2 per digit.
+    */
+    typedef void (*ConvertBatch_Kernel)(const int16_t* raw, float* out, size_t count,
+                                        uint8_t shift, float scale);
+
+    /**
+    *   \brief A kernel and whether the CPU can run it.
+    */
+    typedef struct {
+        const char* name;           ///< "scalar", "sse2" or "avx2"
+        ConvertBatch_Kernel kernel; ///< Conversion
+        uint8_t supported;          ///< The CPU has the instructions it needs
+    } ConvertBatch_Entry;
+
+    /**
+    *   \brief Number of entries of ConvertBatch_Kernels.
+    */
+    #define CONVERT_BATCH_KERNEL_COUNT 3
+
+    /**
+    *   \brief Every kernel, the scalar reference first.
+    *
+    *   The entries of the kernels not built for this CPU architecture are
+    *   never supported. Filled by the first call of ConvertBatch_Select.
+    */
+    extern ConvertBatch_Entry ConvertBatch_Kernels[CONVERT_BATCH_KERNEL_COUNT];
+
+    /**
+    *   \brief Choose the widest kernel the CPU supports.
+    *   \retval Entry of the kernel used by ConvertBatch_Run.
+    */
+    const ConvertBatch_Entry* ConvertBatch_Select(void);
+
+    /**
+    *   \brief m/s^2 per digit of a range and mode.
+    */
+    float ConvertBatch_Scale(const LIS3DH_Sensitivity* sensitivity);
+
+    /**
+    *   \brief Convert with the kernel chosen by ConvertBatch_Select.
+    */
+    void ConvertBatch_Run(const int16_t* raw, float* out, size_t count, uint8_t shift, float scale);
+
+#endif
+/* [] END OF FILE */
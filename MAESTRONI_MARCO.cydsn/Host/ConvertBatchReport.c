@@ -0,0 +1,151 @@
+/*
+* MARCO MAESTRONI
+*
+* Host check and benchmark of the batch conversion (Host/ConvertBatch.h):
+* for every full-scale range and operating mode, all the 65536 output
+* words are converted by every kernel the CPU supports, from every
+* alignment and with every tail length, and must give the bits of the
+* scalar kernel. The scalar kernel must agree with the fixed-point
+* conversion of the firmware, which truncates to whole mm/s^2, within
+* TOLERANCE_MMS2.
+*
+* The throughput of each kernel is measured on columns larger than the
+* caches, as when a capture is reprocessed, and given in samples (X, Y
+* and Z) per second and in MB/s of the int16 columns read.
+*
+* Build from this folder with:
+*   cc -O2 -I. -I.. -o ConvertBatchReport ConvertBatchReport.c ConvertBatch.c \
+*      ../LIS3DH_Convert.c
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "ConvertBatch.h"
+
+#define WORDS       65536
+#define BENCH_WORDS (3 * 1024 * 1024)
+#define BENCH_MS    200
+// The truncation of the firmware, plus the rounding of its Q16 factor
+// and of the float product at the top of the range
+#define TOLERANCE_MMS2 1.01
+// Samples of a day at 200 Hz
+#define DAY_SAMPLES (200.0 * 86400)
+
+static const char* const mode_names[LIS3DH_MODE_COUNT] = { "low-power", "normal", "high-res" };
+
+static int16_t words[WORDS];
+static float reference[WORDS];
+static float converted[WORDS + 16];
+static int16_t bench_words[BENCH_WORDS];
+static float bench_out[BENCH_WORDS];
+
+static double Seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Bits different from the scalar kernel, from every alignment of the
+// input and output and with tails of 0 to 15 words
+static unsigned Compare(ConvertBatch_Kernel kernel, uint8_t shift, float scale)
+{
+    unsigned differences = 0;
+    size_t offset;
+
+    for (offset = 0; offset < 16; offset++)
+    {
+        kernel(&words[offset], &converted[(offset * 3) % 16], WORDS - offset, shift, scale);
+        differences += memcmp(&converted[(offset * 3) % 16], &reference[offset],
+                              (WORDS - offset) * sizeof(float)) != 0;
+    }
+    return differences;
+}
+
+int main(void)
+{
+    const ConvertBatch_Entry* selected = ConvertBatch_Select();
+    int failures = 0;
+    uint8_t fs;
+    uint8_t mode;
+    int k;
+    int32_t i;
+
+    for (i = 0; i < WORDS; i++)
+    {
+        words[i] = (int16_t)(i + INT16_MIN);
+    }
+    printf("kernels:");
+    for (k = 0; k < CONVERT_BATCH_KERNEL_COUNT; k++)
+    {
+        printf(" %s%s", ConvertBatch_Kernels[k].name, ConvertBatch_Kernels[k].supported ? "" : " (unsupported)");
+    }
+    printf(", selected %s\n", selected->name);
+
+    for (fs = 0; fs < LIS3DH_FULL_SCALE_COUNT; fs++)
+    {
+        for (mode = 0; mode < LIS3DH_MODE_COUNT; mode++)
+        {
+            const LIS3DH_Sensitivity* sensitivity = &LIS3DH_SensitivityTable[fs][mode];
+            const float scale = ConvertBatch_Scale(sensitivity);
+            double largest = 0;
+            unsigned differences = 0;
+
+            ConvertBatch_Kernels[0].kernel(words, reference, WORDS, sensitivity->shift, scale);
+            for (i = 0; i < WORDS; i++)
+            {
+                double difference = fabs(reference[i] * 1000.0 -
+                                         LIS3DH_ConvertMms2(sensitivity, words[i]));
+                largest = difference > largest ? difference : largest;
+            }
+            for (k = 1; k < CONVERT_BATCH_KERNEL_COUNT; k++)
+            {
+                if (ConvertBatch_Kernels[k].supported)
+                {
+                    differences += Compare(ConvertBatch_Kernels[k].kernel, sensitivity->shift, scale);
+                }
+            }
+            printf("+-%2u g %-9s: %.6f m/s^2 per digit, %.3f mm/s^2 from the firmware, "
+                   "%u runs differ from scalar %s\n",
+                   (unsigned)LIS3DH_FullScaleTable[fs].g, mode_names[mode], scale, largest,
+                   differences, largest <= TOLERANCE_MMS2 && differences == 0 ? "ok" : "FAILED");
+            failures += largest > TOLERANCE_MMS2 || differences != 0;
+        }
+    }
+
+    // Throughput, on high-resolution words
+    for (i = 0; i < BENCH_WORDS; i++)
+    {
+        bench_words[i] = (int16_t)(i * 40503);
+    }
+    for (k = 0; k < CONVERT_BATCH_KERNEL_COUNT; k++)
+    {
+        const LIS3DH_Sensitivity* sensitivity = &LIS3DH_SensitivityTable[0][LIS3DH_MODE_HIGH_RESOLUTION];
+        const float scale = ConvertBatch_Scale(sensitivity);
+        double start;
+        double seconds;
+        double samples;
+        unsigned rounds = 0;
+
+        if (!ConvertBatch_Kernels[k].supported)
+        {
+            continue;
+        }
+        start = Seconds();
+        do
+        {
+            ConvertBatch_Kernels[k].kernel(bench_words, bench_out, BENCH_WORDS, sensitivity->shift, scale);
+            rounds++;
+            seconds = Seconds() - start;
+        } while (seconds < BENCH_MS / 1000.0);
+        samples = (double)rounds * BENCH_WORDS / 3;
+        printf("%-6s %8.1f Msamples/s, %8.1f MB/s of columns, a day at 200 Hz in %7.2f ms\n",
+               ConvertBatch_Kernels[k].name, samples / seconds / 1e6, samples * 6 / seconds / 1e6,
+               DAY_SAMPLES / (samples / seconds) * 1e3);
+    }
+    return failures ? 1 : 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,132 @@
+/*
+* MARCO MAESTRONI
+*
+* Host check of the fixed-point conversion: every 16-bit output word is
+* converted for every full-scale range and operating mode and compared
+* with the float conversion the firmware used before, which must be
+* matched within 1 mm/s^2. The cost of both paths is measured on the
+* host; on the target the float path is soft-float library calls while
+* the host has an FPU, so only the target figure (TX CPU of the
+* benchmark) is representative of the gain.
+*
+* Build from this folder with:
+*   cc -O2 -I. -I.. -o ConvertReport ConvertReport.c ../LIS3DH_Convert.c
+*/
+
+#include <stdio.h>
+#include <time.h>
+#include "LIS3DH_Convert.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define CYCLES() __rdtsc()
+#else
+    #define CYCLES() 0
+#endif
+
+#define ROUNDS 100
+
+static const char* const mode_names[LIS3DH_MODE_COUNT] = { "low-power", "normal", "high-res" };
+
+static volatile int32_t sink;
+
+// Conversion done by the firmware before the fixed-point path, on 32 bits
+// so that the ranges above +-2 g do not wrap
+static int32_t FloatReference(const LIS3DH_Sensitivity* sensitivity, int16 raw)
+{
+    const float conversion = 0.00981 * sensitivity->mg_per_digit;
+    const int dirtytrick = 1000;
+    int16 DataOut = raw >> sensitivity->shift;
+    return (int32_t) (DataOut * conversion * dirtytrick);
+}
+
+static double Seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// ns and cycles per conversion of both paths
+static void Measure(const LIS3DH_Sensitivity* sensitivity)
+{
+    double start;
+    double float_ns;
+    double fixed_ns;
+    unsigned long long cycles;
+    unsigned long long float_cycles;
+    unsigned long long fixed_cycles;
+    const double count = (double)ROUNDS * 65536;
+    int round;
+    int32_t raw;
+
+    start = Seconds();
+    cycles = CYCLES();
+    for (round = 0; round < ROUNDS; round++)
+    {
+        for (raw = INT16_MIN; raw <= INT16_MAX; raw++)
+        {
+            sink = FloatReference(sensitivity, (int16)raw);
+        }
+    }
+    float_cycles = CYCLES() - cycles;
+    float_ns = (Seconds() - start) * 1e9;
+
+    start = Seconds();
+    cycles = CYCLES();
+    for (round = 0; round < ROUNDS; round++)
+    {
+        for (raw = INT16_MIN; raw <= INT16_MAX; raw++)
+        {
+            sink = LIS3DH_ConvertMms2(sensitivity, (int16_t)raw);
+        }
+    }
+    fixed_cycles = CYCLES() - cycles;
+    fixed_ns = (Seconds() - start) * 1e9;
+
+    printf("  float %.2f ns %.1f cycles, fixed %.2f ns %.1f cycles per conversion\n",
+           float_ns / count, float_cycles / count, fixed_ns / count, fixed_cycles / count);
+}
+
+int main(void)
+{
+    int failures = 0;
+    uint8_t fs;
+    uint8_t mode;
+
+    for (fs = 0; fs < LIS3DH_FULL_SCALE_COUNT; fs++)
+    {
+        for (mode = 0; mode < LIS3DH_MODE_COUNT; mode++)
+        {
+            const LIS3DH_Sensitivity* sensitivity = &LIS3DH_SensitivityTable[fs][mode];
+            unsigned differences = 0;
+            int32_t largest = 0;
+            int32_t raw;
+
+            for (raw = INT16_MIN; raw <= INT16_MAX; raw++)
+            {
+                int32_t difference = LIS3DH_ConvertMms2(sensitivity, (int16_t)raw) -
+                                     FloatReference(sensitivity, (int16)raw);
+                if (difference < 0)
+                {
+                    difference = -difference;
+                }
+                differences += difference != 0;
+                if (difference > largest)
+                {
+                    largest = difference;
+                }
+            }
+            printf("+-%2u g %-9s: %3u mg/digit, factor %9ld (Q%d), %5u of 65536 differ, largest %ld mm/s^2 %s\n",
+                   (unsigned)LIS3DH_FullScaleTable[fs].g, mode_names[mode],
+                   (unsigned)sensitivity->mg_per_digit, (long)sensitivity->mms2_q, LIS3DH_CONVERT_Q,
+                   differences, (long)largest, largest <= 1 ? "ok" : "FAILED");
+            failures += largest > 1;
+        }
+    }
+    // The conversion is the same code for every entry: one timing suffices
+    Measure(&LIS3DH_SensitivityTable[0][LIS3DH_MODE_HIGH_RESOLUTION]);
+    return failures ? 1 : 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,56 @@
+/**
+*   \file project.h
+*   \brief Host replacement of the PSoC Creator project.h, for Hal.c only.
+*
+*   The cy_boot and component calls of Hal.c are declared here and
+*   implemented by the SysTick model (Host/SysTickSim.h): Hal.c can then
+*   be compiled on a PC and its tickless sleep checked against the
+*   counter of the Cortex-M3. The folder is only put on the include path
+*   of the programs that build Hal.c.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __HOST_PROJECT_H
+    #define __HOST_PROJECT_H
+
+    #include "cytypes.h"
+
+    typedef void (*cySysTickCallback)(void);
+
+    // Core registers, read and written through the model
+    uint32 SysTickSim_ReadRegister(uint32 address);
+    void SysTickSim_WriteRegister(uint32 address, uint32 value);
+    void SysTickSim_WaitForInterrupt(void);
+
+    #define CY_GET_REG32(address)        SysTickSim_ReadRegister(address)
+    #define CY_SET_REG32(address, value) SysTickSim_WriteRegister((address), (value))
+    #define CY_PM_WFI                    SysTickSim_WaitForInterrupt()
+
+    // The interrupts are only served by the model
+    #define CyGlobalIntEnable
+    #define CyGlobalIntDisable
+    uint8 CyEnterCriticalSection(void);
+    void CyExitCriticalSection(uint8 savedIntrStatus);
+
+    // SysTick
+    void CySysTickStart(void);
+    void CySysTickEnable(void);
+    void CySysTickStop(void);
+    void CySysTickSetReload(uint32 value);
+    uint32 CySysTickGetReload(void);
+    uint32 CySysTickGetValue(void);
+    uint32 CySysTickGetCountFlag(void);
+    void CySysTickClear(void);
+    cySysTickCallback CySysTickSetCallback(uint32 number, cySysTickCallback function);
+
+    // Components of TopDesign
+    void isr_Button_StartEx(cySysTickCallback address);
+    void isr_DataReady_StartEx(cySysTickCallback address);
+    uint8 Push_Button_Read(void);
+    void UART_Debug_Start(void);
+    void UART_Debug_PutString(const char* string);
+    void UART_Debug_PutArray(const uint8* string, uint8 byteCount);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,78 @@
+/*
+* MARCO MAESTRONI
+*
+* Host implementation of EEPROM_Interface.h: rows are read from and
+* programmed in the EEPROM model. If HAL_EEPROM_FILE is set, the content
+* is loaded from that file at start and saved to it after every write,
+* so that it survives a restart of the process.
+*/
+
+#include <stdlib.h>
+#include "EEPROM_Interface.h"
+#include "EepromSim.h"
+
+// The host writes program the model immediately; like a real row write,
+// which takes milliseconds, they are reported busy by the first poll and
+// completed by the second one
+static EEPROM_WriteStatus write_status = EEPROM_WRITE_IDLE;
+static const char* image_path;
+
+ErrorCode EEPROM_Peripheral_Start(void)
+{
+    // The content survives a restart, as the real EEPROM does
+    write_status = EEPROM_WRITE_IDLE;
+    image_path = getenv("HAL_EEPROM_FILE");
+    if (image_path != NULL)
+    {
+        EepromSim_Load(image_path);
+    }
+    return NO_ERROR;
+}
+
+ErrorCode EEPROM_Peripheral_ReadRow(uint8_t row, uint8_t* data)
+{
+    uint16_t address = (uint16_t)row * EEPROM_PERIPHERAL_ROW_SIZE;
+    uint8_t i;
+
+    if (row >= EEPROM_PERIPHERAL_ROW_COUNT)
+    {
+        return ERROR;
+    }
+    for (i = 0; i < EEPROM_PERIPHERAL_ROW_SIZE; i++)
+    {
+        data[i] = EepromSim_ReadByte(address + i);
+    }
+    return NO_ERROR;
+}
+
+ErrorCode EEPROM_Peripheral_StartWriteRow(uint8_t row, const uint8_t* data)
+{
+    if (write_status != EEPROM_WRITE_IDLE || row >= EEPROM_PERIPHERAL_ROW_COUNT)
+    {
+        return ERROR;
+    }
+    EepromSim_WriteRow(row, data);
+    if (image_path != NULL)
+    {
+        EepromSim_Save(image_path);
+    }
+    write_status = EEPROM_WRITE_BUSY;
+    return NO_ERROR;
+}
+
+EEPROM_WriteStatus EEPROM_Peripheral_WritePoll(void)
+{
+    EEPROM_WriteStatus status = write_status;
+
+    if (status == EEPROM_WRITE_BUSY)
+    {
+        write_status = EEPROM_WRITE_DONE;
+    }
+    else
+    {
+        write_status = EEPROM_WRITE_IDLE;
+    }
+    return status;
+}
+
+/* [] END OF FILE */
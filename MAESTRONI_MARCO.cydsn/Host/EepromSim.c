@@ -0,0 +1,107 @@
+/*
+* MARCO MAESTRONI
+*
+* Host model of the internal EEPROM with per-cell write counters
+*/
+
+#include <stdio.h>
+#include "EepromSim.h"
+#include "EEPROM_Interface.h"
+
+#define EEPROM_SIM_SIZE (EEPROM_PERIPHERAL_ROW_SIZE * EEPROM_PERIPHERAL_ROW_COUNT)
+
+// Value of an erased cell on the PSoC 5LP
+#define EEPROM_SIM_ERASED 0x00
+
+static uint8_t cells[EEPROM_SIM_SIZE];
+static uint32_t write_count[EEPROM_SIM_SIZE];
+static uint32_t row_writes;
+static uint8_t tear_after = EEPROM_PERIPHERAL_ROW_SIZE;
+
+void EepromSim_Erase(void)
+{
+    uint16_t i;
+    for (i = 0; i < EEPROM_SIM_SIZE; i++)
+    {
+        cells[i] = EEPROM_SIM_ERASED;
+        write_count[i] = 0;
+    }
+    row_writes = 0;
+    tear_after = EEPROM_PERIPHERAL_ROW_SIZE;
+}
+
+uint8_t EepromSim_ReadByte(uint16_t address)
+{
+    return address < EEPROM_SIM_SIZE ? cells[address] : EEPROM_SIM_ERASED;
+}
+
+void EepromSim_WriteRow(uint8_t row, const uint8_t* data)
+{
+    uint16_t address = (uint16_t)row * EEPROM_PERIPHERAL_ROW_SIZE;
+    uint8_t i;
+
+    // The whole row is erased and programmed, whatever changed
+    for (i = 0; i < EEPROM_PERIPHERAL_ROW_SIZE; i++)
+    {
+        cells[address + i] = i < tear_after ? data[i] : EEPROM_SIM_ERASED;
+        write_count[address + i]++;
+    }
+    row_writes++;
+    tear_after = EEPROM_PERIPHERAL_ROW_SIZE;
+}
+
+void EepromSim_TearNextWrite(uint8_t count)
+{
+    tear_after = count;
+}
+
+uint32_t EepromSim_WriteCount(uint16_t address)
+{
+    return address < EEPROM_SIM_SIZE ? write_count[address] : 0;
+}
+
+uint32_t EepromSim_MaxWriteCount(void)
+{
+    uint32_t max = 0;
+    uint16_t i;
+    for (i = 0; i < EEPROM_SIM_SIZE; i++)
+    {
+        if (write_count[i] > max)
+        {
+            max = write_count[i];
+        }
+    }
+    return max;
+}
+
+uint32_t EepromSim_RowWrites(void)
+{
+    return row_writes;
+}
+
+uint8_t EepromSim_Load(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    size_t read;
+
+    if (file == NULL)
+    {
+        return 0;
+    }
+    read = fread(cells, 1, EEPROM_SIM_SIZE, file);
+    fclose(file);
+    return read == EEPROM_SIM_SIZE;
+}
+
+void EepromSim_Save(const char* path)
+{
+    FILE* file = fopen(path, "wb");
+
+    if (file != NULL)
+    {
+        fwrite(cells, 1, EEPROM_SIM_SIZE, file);
+        fclose(file);
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,72 @@
+/**
+*   \file EepromSim.h
+*   \brief Host model of the internal EEPROM.
+*
+*   The model is used by the host implementation of EEPROM_Interface.h
+*   and counts how many times every cell has been programmed.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __EEPROMSIM_H
+    #define __EEPROMSIM_H
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief Erase the whole EEPROM and clear the write counters.
+    */
+    void EepromSim_Erase(void);
+
+    /**
+    *   \brief Read one byte.
+    *   \param address Byte address.
+    */
+    uint8_t EepromSim_ReadByte(uint16_t address);
+
+    /**
+    *   \brief Program one row and count a write on each of its cells.
+    *   \param row Row number.
+    *   \param data EEPROM_PERIPHERAL_ROW_SIZE bytes.
+    */
+    void EepromSim_WriteRow(uint8_t row, const uint8_t* data);
+
+    /**
+    *   \brief Make the next row write stop after count bytes.
+    *
+    *   Models a power loss during programming: the remaining bytes of
+    *   the row are left erased.
+    */
+    void EepromSim_TearNextWrite(uint8_t count);
+
+    /**
+    *   \brief Number of times a cell has been programmed.
+    *   \param address Byte address.
+    */
+    uint32_t EepromSim_WriteCount(uint16_t address);
+
+    /**
+    *   \brief Highest write count over all the cells.
+    */
+    uint32_t EepromSim_MaxWriteCount(void);
+
+    /**
+    *   \brief Number of row writes since the last erase.
+    */
+    uint32_t EepromSim_RowWrites(void);
+
+    /**
+    *   \brief Load the content from an image file, without counting writes.
+    *   \param path File written by EepromSim_Save.
+    *   \retval 1 if the file could be read, 0 otherwise.
+    */
+    uint8_t EepromSim_Load(const char* path);
+
+    /**
+    *   \brief Save the content to an image file.
+    *   \param path File to be written.
+    */
+    void EepromSim_Save(const char* path);
+
+#endif
+/* [] END OF FILE */
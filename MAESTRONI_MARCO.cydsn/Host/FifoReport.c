@@ -0,0 +1,135 @@
+/*
+* MARCO MAESTRONI
+*
+* Host report of the FIFO acquisition engine against the simulated
+* LIS3DH FIFO. For every ODR and I2C bus speed the samples are generated
+* at the sensor rate while the bus is busy draining the FIFO, so that
+* samples overwritten in stream mode show up as lost.
+*
+* Build from this folder with:
+*   cc -DI2C_BUS_STATS_ENABLED=1 -I. -I.. -o FifoReport FifoReport.c \
+*      I2C_Interface_Host.c Lis3dhSim.c ../I2C_BusStats.c ../LIS3DH_Driver.c \
+*      ../LIS3DH_Fifo.c -lm
+*/
+
+#include <stdio.h>
+#include "I2C_Interface.h"
+#include "I2C_BusStats.h"
+#include "LIS3DH_Fifo.h"
+#include "Lis3dhSim.h"
+
+#define SAMPLES   20000
+#define WATERMARK 16
+
+static const uint32_t odr_hz[] = { 1, 10, 25, 50, 100, 200, 400, 1344, 1600, 5376 };
+static const uint32_t bus_hz[] = { 100000, 400000 };
+
+/* Number of sensor samples generated so far, pushed with their sequence
+ * number in the X output so that gaps can be detected on the reader side. */
+static uint32_t generated;
+
+static void Generate(double now_s, uint32_t odr)
+{
+    while (generated < SAMPLES && (double)generated / odr <= now_s)
+    {
+        int16_t seq = (int16_t)(generated & 0x7FF);
+        Lis3dhSim_SetOutput((int16_t)(seq << 4), 0, 0);
+        generated++;
+    }
+}
+
+static double BusSeconds(uint32_t cycles_before, uint32_t speed)
+{
+    I2C_BusStats stats;
+    I2C_BusStats_Get(&stats);
+    return (double)(I2C_BusStats_Cycles(&stats) - cycles_before) / speed;
+}
+
+static void RunFifo(uint32_t odr, uint32_t speed)
+{
+    LIS3DH_Sample samples[LIS3DH_FIFO_DEPTH];
+    I2C_BusStats stats;
+    uint32_t received = 0;
+    uint32_t lost = 0;
+    uint32_t expected = 0;
+    double now = 0;
+    uint8_t count;
+    uint8_t src;
+    uint8_t i;
+
+    I2C_Peripheral_Start();
+    LIS3DH_FifoStart(WATERMARK, 1);
+    I2C_BusStats_Reset();
+    generated = 0;
+
+    while (generated < SAMPLES || Lis3dhSim_FifoLevel() > 0)
+    {
+        // Wait for the watermark (or the end of the run)
+        if (generated < SAMPLES && Lis3dhSim_FifoLevel() < WATERMARK)
+        {
+            now = (double)generated / odr;
+            Generate(now, odr);
+            continue;
+        }
+
+        // Samples keep coming while the transfer is on the bus
+        I2C_BusStats_Get(&stats);
+        uint32_t cycles = I2C_BusStats_Cycles(&stats);
+        LIS3DH_FifoDrain(samples, LIS3DH_FIFO_DEPTH, &count, &src);
+        now += BusSeconds(cycles, speed);
+        Generate(now, odr);
+
+        for (i = 0; i < count; i++)
+        {
+            uint32_t seq = (uint16_t)samples[i].x >> 4;
+            lost += (seq - expected) & 0x7FF;
+            expected = (seq + 1) & 0x7FF;
+            received++;
+        }
+    }
+
+    I2C_BusStats_Get(&stats);
+    printf("%5u Hz %4u kHz  fifo   %6.1f cycles/sample  bus %5.1f%%  lost %u of %u\n",
+           (unsigned)odr, (unsigned)(speed / 1000),
+           (double)I2C_BusStats_Cycles(&stats) / received,
+           100.0 * I2C_BusStats_Cycles(&stats) / speed / ((double)SAMPLES / odr),
+           (unsigned)lost, (unsigned)SAMPLES);
+}
+
+static void RunSingle(uint32_t odr, uint32_t speed)
+{
+    LIS3DH_Sample sample;
+    I2C_BusStats stats;
+
+    I2C_Peripheral_Start();
+    I2C_BusStats_Reset();
+    Lis3dhSim_SetOutput(0, 0, 0);
+    LIS3DH_ReadSample(&sample);
+    I2C_BusStats_Get(&stats);
+
+    // One burst per sample period: the bus time must fit in the period
+    double busy = (double)I2C_BusStats_Cycles(&stats) / speed * odr;
+    printf("%5u Hz %4u kHz  single %6.1f cycles/sample  bus %5.1f%%  %s\n",
+           (unsigned)odr, (unsigned)(speed / 1000),
+           (double)I2C_BusStats_Cycles(&stats), 100.0 * busy,
+           busy < 1.0 ? "sustained" : "NOT sustained");
+}
+
+int main(void)
+{
+    uint8_t o;
+    uint8_t b;
+
+    printf("FIFO stream mode, watermark %d, %d samples per run\n", WATERMARK, SAMPLES);
+    for (b = 0; b < sizeof(bus_hz) / sizeof(bus_hz[0]); b++)
+    {
+        for (o = 0; o < sizeof(odr_hz) / sizeof(odr_hz[0]); o++)
+        {
+            RunSingle(odr_hz[o], bus_hz[b]);
+            RunFifo(odr_hz[o], bus_hz[b]);
+        }
+    }
+    return 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,279 @@
+/*
+* MARCO MAESTRONI
+*
+* Host check of the framing of the serial stream: the same random samples
+* are sent in each frame layout, with one byte dropped at a random place
+* every DROP_EVERY frames, and the decoded samples are matched against the
+* sent ones. The payload is random, so the header, footer and sync values
+* turn up in it as they do with real data.
+*
+* For each layout the report gives the bytes per sample and the overhead
+* over the 8-byte version 1 frame, the samples lost per dropped byte, the
+* longest run of frames lost, the samples decoded with wrong values and
+* the decoding speed. With COBS framing a dropped byte must cost at most
+* the damaged frame and the next one (when the delimiter itself is
+* dropped) and no sample may be garbled.
+*
+* Build from this folder with:
+*   cc -O2 -I. -I.. -o FramingReport FramingReport.c PacketDecoder.c ConvertBatch.c \
+*      ../Packet.c ../Crc8.c ../Cobs.c -lm
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "PacketDecoder.h"
+#include "Cobs.h"
+
+#define SAMPLES    64000
+#define DROP_EVERY 100
+// Samples searched ahead of the next expected one when matching
+#define WINDOW     1024
+
+#define STREAM_LENGTH (SAMPLES * COBS_ENCODED_LENGTH(PACKET_V2_LENGTH))
+
+typedef enum {
+    LAYOUT_V1,
+    LAYOUT_V2,
+    LAYOUT_V1_COBS,
+    LAYOUT_V2_COBS,
+    LAYOUT_BATCH_COBS,
+    LAYOUT_COUNT
+} Layout;
+
+static const char* const layout_names[LAYOUT_COUNT] = {
+    "v1", "v2", "v1+cobs", "v2+cobs", "batch+cobs"
+};
+
+typedef struct {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+} Sample;
+
+static Sample sent[SAMPLES];
+static Sample decoded[SAMPLES * 2];
+static uint8_t stream[STREAM_LENGTH];
+
+static int failures;
+
+static double Seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static uint8_t IsCobs(Layout layout)
+{
+    return layout == LAYOUT_V1_COBS || layout == LAYOUT_V2_COBS || layout == LAYOUT_BATCH_COBS;
+}
+
+static uint8_t SamplesPerFrame(Layout layout)
+{
+    return layout == LAYOUT_BATCH_COBS ? PACKET_BATCH_MAX : 1;
+}
+
+// Frame of the samples from first on, at frame + COBS_OFFSET so that the
+// COBS layouts can encode it in place as the firmware does
+static uint16_t BuildFrame(Layout layout, uint32_t first, uint8_t* buffer)
+{
+    uint8_t* frame = buffer + COBS_OFFSET;
+    const Sample* sample = &sent[first];
+    uint16_t length;
+
+    if (layout == LAYOUT_V1 || layout == LAYOUT_V1_COBS)
+    {
+        frame[0] = PACKET_V1_HEADER;
+        frame[1] = (uint8_t)sample->x;
+        frame[2] = (uint8_t)(sample->x >> 8);
+        frame[3] = (uint8_t)sample->y;
+        frame[4] = (uint8_t)(sample->y >> 8);
+        frame[5] = (uint8_t)sample->z;
+        frame[6] = (uint8_t)(sample->z >> 8);
+        frame[7] = PACKET_V1_FOOTER;
+        length = PACKET_V1_LENGTH;
+    }
+    else if (layout == LAYOUT_V2 || layout == LAYOUT_V2_COBS)
+    {
+        Packet_V2 packet;
+
+        packet.seq = (uint8_t)first;
+        packet.timestamp = first * 5;
+        packet.x = sample->x;
+        packet.y = sample->y;
+        packet.z = sample->z;
+        packet.odr = 5;
+        Packet_BuildV2(&packet, frame);
+        length = PACKET_V2_LENGTH;
+    }
+    else
+    {
+        uint8_t i;
+
+        Packet_BatchStart(frame, (uint16_t)first, first * 5, 5);
+        for (i = 0; i < PACKET_BATCH_MAX; i++)
+        {
+            Packet_BatchAdd(frame, sample[i].x, sample[i].y, sample[i].z);
+        }
+        length = Packet_BatchFinish(frame);
+    }
+
+    if (IsCobs(layout))
+    {
+        return Cobs_Encode(buffer, length);
+    }
+    memmove(buffer, frame, length);
+    return length;
+}
+
+// Stream of all the samples, one byte dropped every DROP_EVERY frames
+static uint32_t BuildStream(Layout layout, uint32_t* drops)
+{
+    uint8_t buffer[COBS_ENCODED_LENGTH(PACKET_BATCH_LENGTH(PACKET_BATCH_MAX))];
+    uint32_t length = 0;
+    uint32_t first;
+    uint32_t frame = 0;
+
+    *drops = 0;
+    for (first = 0; first < SAMPLES; first += SamplesPerFrame(layout), frame++)
+    {
+        uint16_t frame_length = BuildFrame(layout, first, buffer);
+        int drop = -1;
+
+        if (frame > 0 && frame % DROP_EVERY == 0)
+        {
+            drop = rand() % frame_length;
+            (*drops)++;
+        }
+        for (uint16_t i = 0; i < frame_length; i++)
+        {
+            if (i != drop)
+            {
+                stream[length++] = buffer[i];
+            }
+        }
+    }
+    return length;
+}
+
+static void Run(Layout layout)
+{
+    static PacketDecoder decoder;
+    const uint8_t per_frame = SamplesPerFrame(layout);
+    uint8_t buffer[COBS_ENCODED_LENGTH(PACKET_BATCH_LENGTH(PACKET_BATCH_MAX))];
+    uint32_t drops;
+    uint32_t length;
+    uint32_t count = 0;
+    uint32_t next = 0;
+    uint32_t lost = 0;
+    uint32_t garbled = 0;
+    uint32_t run = 0;
+    uint32_t run_max;
+    double frame_bytes;
+    double start;
+    double seconds;
+    uint32_t i;
+
+    frame_bytes = BuildFrame(layout, 0, buffer);
+    length = BuildStream(layout, &drops);
+
+    if (layout == LAYOUT_V1 || layout == LAYOUT_V1_COBS)
+    {
+        PacketDecoder_InitV1(&decoder);
+    }
+    else
+    {
+        PacketDecoder_Init(&decoder);
+    }
+    if (IsCobs(layout))
+    {
+        PacketDecoder_UseCobs(&decoder);
+    }
+    start = Seconds();
+    for (i = 0; i < length; i++)
+    {
+        uint8_t samples = PacketDecoder_Push(&decoder, stream[i]);
+        uint8_t s;
+
+        for (s = 0; s < samples && count < SAMPLES * 2; s++)
+        {
+            decoded[count].x = decoder.samples[s].x;
+            decoded[count].y = decoder.samples[s].y;
+            decoded[count].z = decoder.samples[s].z;
+            count++;
+        }
+    }
+    seconds = Seconds() - start;
+
+    // Each decoded sample is looked for among the next ones sent: the
+    // ones skipped are lost, a sample found nowhere is garbled
+    run_max = 0;
+    for (i = 0; i < count; i++)
+    {
+        uint32_t j;
+
+        for (j = next; j < SAMPLES && j < next + WINDOW; j++)
+        {
+            if (memcmp(&sent[j], &decoded[i], sizeof(Sample)) == 0)
+            {
+                break;
+            }
+        }
+        if (j == SAMPLES || j == next + WINDOW)
+        {
+            garbled++;
+            continue;
+        }
+        run = j - next;
+        run_max = run > run_max ? run : run_max;
+        lost += run;
+        next = j + 1;
+    }
+    run = SAMPLES - next;
+    run_max = run > run_max ? run : run_max;
+    lost += run;
+
+    const uint32_t frames_lost_max = (run_max + per_frame - 1) / per_frame;
+    printf("%-10s %6.2f %8.1f %% %10.2f %10u %8u %8.1f",
+           layout_names[layout], frame_bytes / per_frame,
+           100.0 * (frame_bytes / per_frame - PACKET_V1_LENGTH) / PACKET_V1_LENGTH,
+           drops > 0 ? (double)lost / drops : 0.0, (unsigned)frames_lost_max, (unsigned)garbled,
+           seconds > 0 ? length / seconds / 1e6 : 0.0);
+
+    if (IsCobs(layout))
+    {
+        const uint8_t ok = garbled == 0 && frames_lost_max <= 2 && lost <= drops * 2u * per_frame;
+        printf("  %s", ok ? "ok" : "FAILED");
+        failures += !ok;
+    }
+    printf("\n");
+}
+
+int main(void)
+{
+    uint32_t i;
+    int layout;
+
+    srand(1);
+    for (i = 0; i < SAMPLES; i++)
+    {
+        // 12-bit right-justified raw outputs in the version 2 and batch
+        // frames: the random values are kept in that range for all
+        sent[i].x = (int16_t)(rand() % 4096 - 2048);
+        sent[i].y = (int16_t)(rand() % 4096 - 2048);
+        sent[i].z = (int16_t)(rand() % 4096 - 2048);
+    }
+
+    printf("%u samples, one byte dropped every %u frames\n", (unsigned)SAMPLES, (unsigned)DROP_EVERY);
+    printf("%-10s %6s %10s %10s %10s %8s %8s\n",
+           "layout", "B/smp", "overhead", "lost/drop", "max frames", "garbled", "MB/s");
+    for (layout = 0; layout < LAYOUT_COUNT; layout++)
+    {
+        Run((Layout)layout);
+    }
+    return failures != 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,304 @@
+/*
+* MARCO MAESTRONI
+*
+* Host implementation of Hal.h on POSIX: the interrupts are signals.
+*
+* - the millisecond tick is SIGALRM from an interval timer;
+* - the push button is SIGUSR1 (kill -USR1 <pid>), or is pressed every
+*   HAL_BUTTON_MS milliseconds if that variable is set; it then reads
+*   pressed for HAL_BUTTON_HOLD_MS milliseconds (50 if not set);
+* - INT1 is raised by the LIS3DH model (Lis3dhSim), which is given the
+*   monotonic clock as time source;
+* - disabling the interrupts blocks the signals, and waiting for an
+*   interrupt is sigsuspend;
+* - the UART is the standard output, binary frames and strings mixed
+*   as on the real line.
+*
+* The process exits after HAL_RUN_MS milliseconds if that variable is set.
+* A cycle is one nanosecond.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include "Hal.h"
+#include "Lis3dhSim.h"
+
+#define HAL_HOST_NS_PER_MS 1000000UL
+
+// Standard output is flushed at least this often, for live decoding
+#define HAL_HOST_FLUSH_MS 10
+
+// Time the push button reads pressed, if HAL_BUTTON_HOLD_MS is not set
+#define HAL_HOST_BUTTON_HOLD_MS 50
+
+static Hal_Handler tick_handler;
+static Hal_Handler button_handler;
+static Hal_Handler data_ready_handler;
+
+static struct timespec start;
+static volatile uint64_t last_tick_ns;
+static volatile uint32_t ticks;
+static uint32_t run_ms;
+static uint32_t button_ms;
+static uint32_t hold_ms;
+// Tick of the last press, valid once pressed is set
+static volatile uint32_t press_tick;
+static volatile sig_atomic_t pressed;
+static uint32_t last_flush_ms;
+
+// Set while the main context waits in Hal_WaitForInterrupt, when the
+// signal handlers may drive the LIS3DH model
+static volatile sig_atomic_t sleeping;
+static volatile sig_atomic_t stop;
+static volatile sig_atomic_t in_handler;
+
+static uint64_t NowNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)(now.tv_sec - start.tv_sec) * 1000000000ULL + now.tv_nsec - start.tv_nsec;
+}
+
+// Safe point of the main context: leave once HAL_RUN_MS has elapsed
+static void CheckStop(void)
+{
+    if (stop && !in_handler)
+    {
+        fflush(stdout);
+        exit(0);
+    }
+}
+
+// Clock of the LIS3DH model, read at the start of every I2C transaction
+static uint64_t SimClock(void)
+{
+    CheckStop();
+    return NowNs();
+}
+
+static void SignalSet(sigset_t* set)
+{
+    sigemptyset(set);
+    sigaddset(set, SIGALRM);
+    sigaddset(set, SIGUSR1);
+}
+
+static void OnAlarm(int signal)
+{
+    (void)signal;
+    in_handler = 1;
+    ticks++;
+    last_tick_ns = NowNs();
+    if (tick_handler != NULL)
+    {
+        tick_handler();
+    }
+    if (button_ms && ticks % button_ms == 0)
+    {
+        press_tick = ticks;
+        pressed = 1;
+        if (button_handler != NULL)
+        {
+            button_handler();
+        }
+    }
+    // While the main context sleeps the model is not in use: advance it
+    // so that INT1 can wake it up
+    if (sleeping)
+    {
+        Lis3dhSim_Update();
+    }
+    if (run_ms && ticks >= run_ms)
+    {
+        stop = 1;
+    }
+    in_handler = 0;
+}
+
+static void OnButton(int signal)
+{
+    (void)signal;
+    press_tick = ticks;
+    pressed = 1;
+    if (button_handler != NULL)
+    {
+        button_handler();
+    }
+}
+
+static void OnInt1(void)
+{
+    if (data_ready_handler != NULL)
+    {
+        data_ready_handler();
+    }
+}
+
+static uint32_t Variable(const char* name)
+{
+    const char* value = getenv(name);
+    return value != NULL ? (uint32_t)strtoul(value, NULL, 10) : 0;
+}
+
+void Hal_InterruptsEnable(void)
+{
+    sigset_t set;
+    SignalSet(&set);
+    sigprocmask(SIG_UNBLOCK, &set, NULL);
+}
+
+void Hal_InterruptsDisable(void)
+{
+    sigset_t set;
+    SignalSet(&set);
+    sigprocmask(SIG_BLOCK, &set, NULL);
+}
+
+uint8_t Hal_EnterCritical(void)
+{
+    sigset_t set;
+    sigset_t previous;
+    SignalSet(&set);
+    sigprocmask(SIG_BLOCK, &set, &previous);
+    return (uint8_t)sigismember(&previous, SIGALRM);
+}
+
+void Hal_ExitCritical(uint8_t state)
+{
+    if (!state)
+    {
+        Hal_InterruptsEnable();
+    }
+}
+
+void Hal_WaitForInterrupt(void)
+{
+    sigset_t set;
+    sigset_t previous;
+    sigset_t wait;
+
+    SignalSet(&set);
+    sigprocmask(SIG_BLOCK, &set, &previous);
+    wait = previous;
+    sigdelset(&wait, SIGALRM);
+    sigdelset(&wait, SIGUSR1);
+    sleeping = 1;
+    sigsuspend(&wait);
+    sleeping = 0;
+    sigprocmask(SIG_SETMASK, &previous, NULL);
+    CheckStop();
+}
+
+void Hal_ButtonStart(Hal_Handler handler)
+{
+    struct sigaction action;
+
+    button_handler = handler;
+    button_ms = Variable("HAL_BUTTON_MS");
+    hold_ms = Variable("HAL_BUTTON_HOLD_MS");
+    if (hold_ms == 0)
+    {
+        hold_ms = HAL_HOST_BUTTON_HOLD_MS;
+    }
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = OnButton;
+    sigemptyset(&action.sa_mask);
+    sigaddset(&action.sa_mask, SIGALRM);
+    sigaction(SIGUSR1, &action, NULL);
+}
+
+uint8_t Hal_ButtonPressed(void)
+{
+    return pressed && ticks - press_tick < hold_ms;
+}
+
+void Hal_DataReadyStart(Hal_Handler handler)
+{
+    data_ready_handler = handler;
+    Lis3dhSim_SetInt1Handler(OnInt1);
+}
+
+void Hal_TickStart(Hal_Handler handler)
+{
+    struct sigaction action;
+    struct itimerval timer;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    Lis3dhSim_SetClock(SimClock);
+    tick_handler = handler;
+    run_ms = Variable("HAL_RUN_MS");
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = OnAlarm;
+    sigemptyset(&action.sa_mask);
+    sigaddset(&action.sa_mask, SIGUSR1);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGALRM, &action, NULL);
+
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = 1000;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+uint32_t Hal_TickPeriodCycles(void)
+{
+    return HAL_HOST_NS_PER_MS;
+}
+
+uint32_t Hal_TickElapsedCycles(void)
+{
+    uint64_t elapsed = NowNs() - last_tick_ns;
+    // A late signal must not make the time within the tick overflow
+    return elapsed < HAL_HOST_NS_PER_MS ? (uint32_t)elapsed : HAL_HOST_NS_PER_MS - 1;
+}
+
+uint32_t Hal_SleepTickless(uint32_t max_ms, uint32_t* cycles)
+{
+    // The interval timer keeps running: the ticks are signalled as usual
+    uint64_t asleep = NowNs();
+
+    (void)max_ms;
+    Hal_WaitForInterrupt();
+    *cycles = (uint32_t)(NowNs() - asleep);
+    return 0;
+}
+
+void Hal_CycleCounterStart(void)
+{
+}
+
+uint32_t Hal_CycleCounter(void)
+{
+    return (uint32_t)NowNs();
+}
+
+void Hal_UartStart(void)
+{
+    static char buffer[1 << 16];
+    setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+}
+
+void Hal_UartPutString(const char* string)
+{
+    Hal_UartPutArray((const uint8_t*)string, (uint16_t)strlen(string));
+}
+
+void Hal_UartPutArray(const uint8_t* data, uint16_t length)
+{
+    fwrite(data, 1, length, stdout);
+    if (ticks - last_flush_ms >= HAL_HOST_FLUSH_MS)
+    {
+        fflush(stdout);
+        last_flush_ms = ticks;
+    }
+    CheckStop();
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,460 @@
+/*
+* MARCO MAESTRONI
+*
+* Host implementation of Hal.h in virtual time, for reproducible runs:
+* nothing depends on the wall clock or on the load of the PC.
+*
+* The time only moves on
+* - by the SCL cycles of every I2C transaction, at HAL_I2C_KHZ
+*   (ACQ_I2C_SPEED_KHZ if not set);
+* - on the UART, when the HAL_UART_BUFFER bytes (4, the TX FIFO, if not
+*   set) of the transmit buffer are full: each byte takes 10 bits at
+*   HAL_UART_BAUD (ACQ_UART_BAUD_RATE if not set);
+* - in Hal_WaitForInterrupt, up to the next tick or LIS3DH sample, and in
+*   Hal_SleepTickless up to the next LIS3DH sample or button press, the
+*   ticks being counted without interrupting.
+* The code in between takes no time. The interrupts (the millisecond
+* tick, the push button every HAL_BUTTON_MS milliseconds, INT1 of the
+* LIS3DH model) are served when the time reaches them, or once enabled
+* again if they were masked.
+*
+* The push button reads pressed for HAL_BUTTON_HOLD_MS milliseconds (50
+* if not set). If HAL_BUTTON_BOUNCE_MS is set, its contacts bounce for
+* that long after the press and after the release: the pin changes level
+* every millisecond, raising an interrupt at every press edge.
+*
+* The UART is the standard output. If HAL_LIS3DH_WAVEFORM is set, the
+* LIS3DH model plays back that file (Lis3dhSim_LoadWaveform). The process
+* exits after HAL_RUN_MS milliseconds of virtual time if that variable is
+* set, printing the LIS3DH model counters and the number of times the
+* core woke up on the standard error.
+*
+* If HAL_TRACE_FILE is set, the times are written to that file for the
+* benchmark sweep (Host/BenchmarkSweep.c), one event per line:
+*   s <index> <ns>   LIS3DH sample <index> ready
+*   u <bytes> <ns>   last byte of a Hal_UartPutArray call sent, <bytes>
+*                    being the bytes sent since the start
+*   w <count> <ns>   end of the run: times the core woke up from a sleep
+*   o <count> <ns>   samples overwritten in the LIS3DH model before being
+*                    read since the start, written when it changes and at
+*                    the end of the run
+*   t <ns> <ns>      end of the run: total and sleeping time
+* A cycle is one nanosecond.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Hal.h"
+#include "AcquisitionConfig.h"
+#include "I2C_Interface_Host.h"
+#include "Lis3dhSim.h"
+
+#define HAL_SIM_NS_PER_MS 1000000ULL
+#define HAL_SIM_NS_PER_S  1000000000ULL
+
+// Start bit, 8 data bits and stop bit
+#define HAL_SIM_UART_BITS   10
+#define HAL_SIM_UART_BUFFER 4
+
+// Time the push button reads pressed, if HAL_BUTTON_HOLD_MS is not set
+#define HAL_SIM_BUTTON_HOLD_MS 50
+
+// Interrupts waiting to be served
+#define HAL_SIM_TICK       0x01
+#define HAL_SIM_BUTTON     0x02
+#define HAL_SIM_DATA_READY 0x04
+
+static Hal_Handler tick_handler;
+static Hal_Handler button_handler;
+static Hal_Handler data_ready_handler;
+
+static uint64_t now_ns;
+static uint64_t next_tick_ns;
+static uint32_t ticks;
+static uint8_t ticking;
+// Set in Hal_SleepTickless: the ticks are counted in skipped_ticks
+static uint8_t tickless;
+static uint32_t skipped_ticks;
+
+static uint8_t enabled;
+static uint8_t pending;
+static uint8_t in_interrupt;
+static uint32_t served;
+static uint8_t stop;
+
+static uint32_t run_ms;
+static uint32_t button_ms;
+static uint32_t hold_ms;
+static uint32_t bounce_ms;
+static uint32_t i2c_khz;
+static uint64_t uart_byte_ns;
+static uint64_t uart_buffer_ns;
+// Time at which the last byte queued on the UART is completely sent
+static uint64_t uart_idle_ns;
+static uint64_t uart_bytes;
+
+static FILE* trace;
+static uint64_t sleep_ns;
+static uint32_t wakeups;
+
+static uint32_t Variable(const char* name, uint32_t otherwise)
+{
+    const char* value = getenv(name);
+    return value != NULL ? (uint32_t)strtoul(value, NULL, 10) : otherwise;
+}
+
+static uint64_t Now(void)
+{
+    return now_ns;
+}
+
+// Level of the push button pin at the given tick
+static uint8_t ButtonLevel(uint32_t tick)
+{
+    uint32_t since;
+
+    if (!button_ms || tick < button_ms)
+    {
+        return 0;
+    }
+    since = tick % button_ms;
+    if (since < bounce_ms)
+    {
+        return since % 2 == 0;
+    }
+    if (since < hold_ms)
+    {
+        return 1;
+    }
+    if (since < hold_ms + bounce_ms)
+    {
+        return (since - hold_ms) % 2 == 1;
+    }
+    return 0;
+}
+
+static void Serve(void)
+{
+    while (enabled && !in_interrupt && pending)
+    {
+        uint8_t sources = pending;
+
+        pending = 0;
+        in_interrupt = 1;
+        if ((sources & HAL_SIM_TICK) && tick_handler != NULL)
+        {
+            tick_handler();
+        }
+        if ((sources & HAL_SIM_BUTTON) && button_handler != NULL)
+        {
+            button_handler();
+        }
+        if ((sources & HAL_SIM_DATA_READY) && data_ready_handler != NULL)
+        {
+            data_ready_handler();
+        }
+        in_interrupt = 0;
+        served++;
+    }
+}
+
+// Move the time on, raising the ticks and the LIS3DH samples in order
+static void AdvanceTo(uint64_t time)
+{
+    while (ticking && next_tick_ns <= time)
+    {
+        now_ns = next_tick_ns;
+        next_tick_ns += HAL_SIM_NS_PER_MS;
+        Lis3dhSim_Update();
+        ticks++;
+        if (tickless)
+        {
+            skipped_ticks++;
+        }
+        else
+        {
+            pending |= HAL_SIM_TICK;
+        }
+        if (ButtonLevel(ticks) && !ButtonLevel(ticks - 1))
+        {
+            pending |= HAL_SIM_BUTTON;
+        }
+        if (run_ms && ticks >= run_ms)
+        {
+            stop = 1;
+        }
+        Serve();
+    }
+    if (time > now_ns)
+    {
+        now_ns = time;
+    }
+    Lis3dhSim_Update();
+    Serve();
+}
+
+// Safe point of the main context: leave once HAL_RUN_MS has elapsed
+static void CheckStop(void)
+{
+    Lis3dhSim_Stats stats;
+
+    if (!stop || in_interrupt)
+    {
+        return;
+    }
+    fflush(stdout);
+    Lis3dhSim_GetStats(&stats);
+    fprintf(stderr, "time        %u ms\n", (unsigned)(now_ns / HAL_SIM_NS_PER_MS));
+    fprintf(stderr, "generated   %u\n", (unsigned)stats.generated);
+    fprintf(stderr, "read        %u\n", (unsigned)stats.read);
+    fprintf(stderr, "overwritten %u\n", (unsigned)stats.overwritten);
+    fprintf(stderr, "stale       %u\n", (unsigned)stats.stale);
+    fprintf(stderr, "awake       %.1f %%\n", now_ns ? 100.0 * (now_ns - sleep_ns) / now_ns : 0.0);
+    fprintf(stderr, "wakeups     %u\n", (unsigned)wakeups);
+    if (trace != NULL)
+    {
+        fprintf(trace, "w %u %llu\n", (unsigned)wakeups, (unsigned long long)now_ns);
+        fprintf(trace, "o %u %llu\n", (unsigned)stats.overwritten, (unsigned long long)now_ns);
+        fprintf(trace, "t %llu %llu\n", (unsigned long long)now_ns, (unsigned long long)sleep_ns);
+        fclose(trace);
+    }
+    exit(0);
+}
+
+static void OnBus(uint32_t scl_cycles)
+{
+    AdvanceTo(now_ns + (uint64_t)scl_cycles * HAL_SIM_NS_PER_S / (i2c_khz * 1000ULL));
+    CheckStop();
+}
+
+static void OnInt1(void)
+{
+    pending |= HAL_SIM_DATA_READY;
+}
+
+static void OnSample(uint32_t index, uint64_t ready_ns)
+{
+    static uint32_t overwritten;
+    Lis3dhSim_Stats stats;
+
+    Lis3dhSim_GetStats(&stats);
+    if (stats.overwritten != overwritten)
+    {
+        overwritten = stats.overwritten;
+        fprintf(trace, "o %u %llu\n", (unsigned)overwritten, (unsigned long long)ready_ns);
+    }
+    fprintf(trace, "s %u %llu\n", (unsigned)index, (unsigned long long)ready_ns);
+}
+
+void Hal_InterruptsEnable(void)
+{
+    enabled = 1;
+    Serve();
+}
+
+void Hal_InterruptsDisable(void)
+{
+    enabled = 0;
+}
+
+uint8_t Hal_EnterCritical(void)
+{
+    uint8_t state = !enabled;
+    enabled = 0;
+    return state;
+}
+
+void Hal_ExitCritical(uint8_t state)
+{
+    if (!state)
+    {
+        Hal_InterruptsEnable();
+    }
+}
+
+// Time of the next button press, UINT64_MAX if none
+static uint64_t NextButtonNs(void)
+{
+    if (!button_ms)
+    {
+        return UINT64_MAX;
+    }
+    return next_tick_ns + (uint64_t)(button_ms - 1 - ticks % button_ms) * HAL_SIM_NS_PER_MS;
+}
+
+void Hal_WaitForInterrupt(void)
+{
+    uint32_t before = served;
+    uint64_t asleep = now_ns;
+
+    // A pending interrupt wakes up the core even when masked
+    while (!pending && served == before && !stop)
+    {
+        uint64_t wake = ticking ? next_tick_ns : UINT64_MAX;
+        uint64_t sample = Lis3dhSim_NextSampleNs();
+
+        if (sample < wake)
+        {
+            wake = sample;
+        }
+        if (wake == UINT64_MAX)
+        {
+            // Nothing could ever wake the core up
+            stop = 1;
+            break;
+        }
+        AdvanceTo(wake);
+    }
+    if (now_ns > asleep)
+    {
+        wakeups++;
+    }
+    sleep_ns += now_ns - asleep;
+    CheckStop();
+}
+
+uint32_t Hal_SleepTickless(uint32_t max_ms, uint32_t* cycles)
+{
+    uint64_t asleep = now_ns;
+    uint64_t limit;
+
+    if (max_ms < 2 || !ticking)
+    {
+        Hal_WaitForInterrupt();
+        *cycles = (uint32_t)(now_ns - asleep);
+        return 0;
+    }
+
+    // Up to the max_ms-th tick, or the button press or the end of the run
+    // that the tick would have raised
+    limit = next_tick_ns + (uint64_t)(max_ms - 1) * HAL_SIM_NS_PER_MS;
+    if (NextButtonNs() < limit)
+    {
+        limit = NextButtonNs();
+    }
+    if (run_ms && (uint64_t)run_ms * HAL_SIM_NS_PER_MS < limit)
+    {
+        limit = (uint64_t)run_ms * HAL_SIM_NS_PER_MS;
+    }
+    tickless = 1;
+    skipped_ticks = 0;
+    while (!pending && !stop && now_ns < limit)
+    {
+        uint64_t sample = Lis3dhSim_NextSampleNs();
+        AdvanceTo(sample < limit ? sample : limit);
+    }
+    tickless = 0;
+
+    if (now_ns > asleep)
+    {
+        wakeups++;
+    }
+    sleep_ns += now_ns - asleep;
+    *cycles = (uint32_t)(now_ns - asleep);
+    CheckStop();
+    return skipped_ticks;
+}
+
+void Hal_ButtonStart(Hal_Handler handler)
+{
+    button_handler = handler;
+    button_ms = Variable("HAL_BUTTON_MS", 0);
+    hold_ms = Variable("HAL_BUTTON_HOLD_MS", HAL_SIM_BUTTON_HOLD_MS);
+    bounce_ms = Variable("HAL_BUTTON_BOUNCE_MS", 0);
+}
+
+uint8_t Hal_ButtonPressed(void)
+{
+    return ButtonLevel(ticks);
+}
+
+void Hal_DataReadyStart(Hal_Handler handler)
+{
+    data_ready_handler = handler;
+    Lis3dhSim_SetInt1Handler(OnInt1);
+}
+
+void Hal_TickStart(Hal_Handler handler)
+{
+    const char* waveform = getenv("HAL_LIS3DH_WAVEFORM");
+    const char* trace_path = getenv("HAL_TRACE_FILE");
+
+    tick_handler = handler;
+    run_ms = Variable("HAL_RUN_MS", 0);
+    i2c_khz = Variable("HAL_I2C_KHZ", ACQ_I2C_SPEED_KHZ);
+    next_tick_ns = now_ns + HAL_SIM_NS_PER_MS;
+    ticking = 1;
+
+    Lis3dhSim_SetClock(Now);
+    I2C_Host_SetBusHook(OnBus);
+    if (waveform != NULL && Lis3dhSim_LoadWaveform(waveform) == 0)
+    {
+        fprintf(stderr, "cannot load %s, synthetic waveform used\n", waveform);
+    }
+    if (trace_path != NULL)
+    {
+        trace = fopen(trace_path, "w");
+        if (trace != NULL)
+        {
+            Lis3dhSim_SetSampleHandler(OnSample);
+        }
+    }
+}
+
+uint32_t Hal_TickPeriodCycles(void)
+{
+    return HAL_SIM_NS_PER_MS;
+}
+
+uint32_t Hal_TickElapsedCycles(void)
+{
+    return ticking ? (uint32_t)(now_ns + HAL_SIM_NS_PER_MS - next_tick_ns) : 0;
+}
+
+void Hal_CycleCounterStart(void)
+{
+}
+
+uint32_t Hal_CycleCounter(void)
+{
+    return (uint32_t)now_ns;
+}
+
+void Hal_UartStart(void)
+{
+    static char buffer[1 << 16];
+
+    setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+    uart_byte_ns = HAL_SIM_UART_BITS * HAL_SIM_NS_PER_S / Variable("HAL_UART_BAUD", ACQ_UART_BAUD_RATE);
+    uart_buffer_ns = Variable("HAL_UART_BUFFER", HAL_SIM_UART_BUFFER) * uart_byte_ns;
+}
+
+void Hal_UartPutString(const char* string)
+{
+    Hal_UartPutArray((const uint8_t*)string, (uint16_t)strlen(string));
+}
+
+void Hal_UartPutArray(const uint8_t* data, uint16_t length)
+{
+    uint16_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        // Wait for room in the transmit buffer
+        if (uart_idle_ns > now_ns + uart_buffer_ns)
+        {
+            AdvanceTo(uart_idle_ns - uart_buffer_ns);
+        }
+        uart_idle_ns = (uart_idle_ns > now_ns ? uart_idle_ns : now_ns) + uart_byte_ns;
+    }
+    fwrite(data, 1, length, stdout);
+    uart_bytes += length;
+    if (trace != NULL)
+    {
+        fprintf(trace, "u %llu %llu\n", (unsigned long long)uart_bytes, (unsigned long long)uart_idle_ns);
+    }
+    CheckStop();
+}
+
+/* [] END OF FILE */
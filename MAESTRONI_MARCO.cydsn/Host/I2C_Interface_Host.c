@@ -0,0 +1,166 @@
+/*
+* MARCO MAESTRONI
+*
+* Host implementation of I2C_Interface.h: every transaction is served
+* by the LIS3DH register model and accounted as the PSoC one would be.
+* The register address of the bursts carries the auto-increment bit, as
+* the PSoC implementation sends it.
+*/
+
+#include "I2C_Interface.h"
+#include "I2C_Interface_Host.h"
+#include "I2C_BusStats.h"
+#include "LIS3DH_Registers.h"
+#include "Lis3dhSim.h"
+
+static I2C_Host_BusHook bus_hook;
+
+// SCL cycles of a transaction, counted as in I2C_BusStats.c
+static void BusTime(uint8_t conditions, uint16_t bytes)
+{
+    if (bus_hook != NULL)
+    {
+        bus_hook((uint32_t)conditions * I2C_BUS_STATS_CYCLES_PER_CONDITION +
+                 (uint32_t)bytes * I2C_BUS_STATS_CYCLES_PER_BYTE);
+    }
+}
+
+void I2C_Host_SetBusHook(I2C_Host_BusHook hook)
+{
+    bus_hook = hook;
+}
+
+ErrorCode I2C_Peripheral_Start(void)
+{
+    Lis3dhSim_Reset();
+    return NO_ERROR;
+}
+
+ErrorCode I2C_Peripheral_Stop(void)
+{
+    return NO_ERROR;
+}
+
+ErrorCode I2C_Peripheral_ReadRegister(uint8_t device_address,
+                                      uint8_t register_address,
+                                      uint8_t* data)
+{
+    I2C_BUS_STATS_RECORD(3, 4);
+    if (device_address != LIS3DH_DEVICE_ADDRESS)
+    {
+        return ERROR;
+    }
+    Lis3dhSim_Update();
+    *data = Lis3dhSim_ReadRegister(register_address);
+    BusTime(3, 4);
+    return NO_ERROR;
+}
+
+ErrorCode I2C_Peripheral_ReadRegisterMulti(uint8_t device_address,
+                                           uint8_t register_address,
+                                           uint8_t register_count,
+                                           uint8_t* data)
+{
+    I2C_BUS_STATS_RECORD(3, 3 + register_count);
+    if (device_address != LIS3DH_DEVICE_ADDRESS)
+    {
+        return ERROR;
+    }
+    Lis3dhSim_Update();
+    Lis3dhSim_ReadBurst(register_address | LIS3DH_SIM_AUTO_INCREMENT, data, register_count);
+    BusTime(3, 3 + register_count);
+    return NO_ERROR;
+}
+
+ErrorCode I2C_Peripheral_WriteRegister(uint8_t device_address,
+                                       uint8_t register_address,
+                                       uint8_t data)
+{
+    I2C_BUS_STATS_RECORD(2, 3);
+    if (device_address != LIS3DH_DEVICE_ADDRESS)
+    {
+        return ERROR;
+    }
+    Lis3dhSim_Update();
+    Lis3dhSim_WriteRegister(register_address, data);
+    BusTime(2, 3);
+    return NO_ERROR;
+}
+
+ErrorCode I2C_Peripheral_WriteRegisterMulti(uint8_t device_address,
+                                            uint8_t register_address,
+                                            uint8_t register_count,
+                                            uint8_t* data)
+{
+    I2C_BUS_STATS_RECORD(2, 2 + register_count);
+    if (device_address != LIS3DH_DEVICE_ADDRESS)
+    {
+        return ERROR;
+    }
+    Lis3dhSim_Update();
+    Lis3dhSim_WriteBurst(register_address | LIS3DH_SIM_AUTO_INCREMENT, data, register_count);
+    BusTime(2, 2 + register_count);
+    return NO_ERROR;
+}
+
+// The host transfers complete immediately, the completion is reported
+// by the first poll as the PSoC one would be
+static I2C_AsyncStatus async_status = I2C_ASYNC_IDLE;
+static I2C_AsyncCallback async_callback;
+
+ErrorCode I2C_Peripheral_ReadRegisterMultiAsync(uint8_t device_address,
+                                                uint8_t register_address,
+                                                uint8_t register_count,
+                                                uint8_t* data,
+                                                I2C_AsyncCallback callback)
+{
+    if (async_status != I2C_ASYNC_IDLE)
+    {
+        return ERROR;
+    }
+    ErrorCode error = I2C_Peripheral_ReadRegisterMulti(device_address, register_address,
+                                                       register_count, data);
+    async_status = error == NO_ERROR ? I2C_ASYNC_DONE : I2C_ASYNC_FAILED;
+    async_callback = callback;
+    return NO_ERROR;
+}
+
+ErrorCode I2C_Peripheral_WriteRegisterAsync(uint8_t device_address,
+                                            uint8_t register_address,
+                                            uint8_t data,
+                                            I2C_AsyncCallback callback)
+{
+    if (async_status != I2C_ASYNC_IDLE)
+    {
+        return ERROR;
+    }
+    ErrorCode error = I2C_Peripheral_WriteRegister(device_address, register_address, data);
+    async_status = error == NO_ERROR ? I2C_ASYNC_DONE : I2C_ASYNC_FAILED;
+    async_callback = callback;
+    return NO_ERROR;
+}
+
+I2C_AsyncStatus I2C_Peripheral_AsyncPoll(void)
+{
+    I2C_AsyncStatus status = async_status;
+
+    if (status == I2C_ASYNC_IDLE)
+    {
+        return status;
+    }
+    async_status = I2C_ASYNC_IDLE;
+    if (async_callback != 0)
+    {
+        async_callback(status == I2C_ASYNC_DONE ? NO_ERROR : ERROR);
+    }
+    return status;
+}
+
+uint8_t I2C_Peripheral_IsDeviceConnected(uint8_t device_address)
+{
+    I2C_BUS_STATS_RECORD(2, 1);
+    BusTime(2, 1);
+    return device_address == LIS3DH_DEVICE_ADDRESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,31 @@
+/**
+*   \file I2C_Interface_Host.h
+*   \brief Bus timing of the host implementation of I2C_Interface.h.
+*
+*   The host transactions complete immediately. A platform that keeps
+*   its own time (Host/Hal_Sim.c) is told how long each one would have
+*   kept the bus busy, so that the samples the LIS3DH model produces in
+*   the meantime are the ones the device would have produced.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __I2C_INTERFACE_HOST_H
+    #define __I2C_INTERFACE_HOST_H
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief Function told the length of every completed transaction.
+    *   \param scl_cycles SCL clock cycles of the transaction (I2C_BusStats.h).
+    */
+    typedef void (*I2C_Host_BusHook)(uint32_t scl_cycles);
+
+    /**
+    *   \brief Set the function called at the end of every transaction.
+    *   \param hook Function to call, NULL (the default) for none.
+    */
+    void I2C_Host_SetBusHook(I2C_Host_BusHook hook);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,488 @@
+/*
+* MARCO MAESTRONI
+*
+* Host model of the LIS3DH register file
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "Lis3dhSim.h"
+#include "LIS3DH_Registers.h"
+
+#ifndef M_PI
+    #define M_PI 3.14159265358979323846
+#endif
+
+#define LIS3DH_SIM_REGISTER_COUNT 0x40
+#define LIS3DH_SIM_WHO_AM_I       0x33
+#define LIS3DH_SIM_SAMPLE_SIZE    (LIS3DH_OUT_Z_H - LIS3DH_OUT_X_L + 1)
+#define LIS3DH_SIM_NS_PER_S       1000000000ULL
+
+// STATUS_REG: XDA, YDA, ZDA in bits 0..2, XOR, YOR, ZOR in bits 4..6
+#define LIS3DH_SIM_STATUS_DA      0x07
+
+static uint8_t registers[LIS3DH_SIM_REGISTER_COUNT];
+static Lis3dhSim_Stats stats;
+
+// FIFO content: circular buffer of output register sets
+static uint8_t fifo[LIS3DH_FIFO_DEPTH][LIS3DH_SIM_SAMPLE_SIZE];
+static uint8_t fifo_head;
+static uint8_t fifo_level;
+
+// Sample generation: samples generated since origin_ns at the rate of
+// generation_ctrl_reg1
+static uint64_t (*clock_ns)(void);
+static void (*int1_handler)(void);
+static void (*sample_handler)(uint32_t index, uint64_t ready_ns);
+static uint8_t int1_level;
+static uint8_t generation_ctrl_reg1;
+static uint64_t origin_ns;
+static uint64_t generated;
+
+// Recorded waveform in mg, played back from sample_index
+static int16_t (*waveform)[3];
+static uint32_t waveform_length;
+static uint32_t sample_index;
+
+// Data rate selected by CTRL_REG1 ODR[3:0] and LPen, 0 in power-down
+static uint32_t DataRate(void)
+{
+    static const uint16_t rates[] = { 0, 1, 10, 25, 50, 100, 200, 400, 1600, 1344 };
+    uint8_t code = registers[LIS3DH_CTRL_REG1] >> LIS3DH_CTRL_REG1_ODR_SHIFT;
+
+    if (code == 0x9 && (registers[LIS3DH_CTRL_REG1] & LIS3DH_CTRL_REG1_LPEN))
+    {
+        return 5376;
+    }
+    return code < sizeof(rates) / sizeof(rates[0]) ? rates[code] : 0;
+}
+
+// Left-justified output word of an acceleration in mg, at the full-scale
+// range and resolution selected in CTRL_REG1 and CTRL_REG4
+static int16_t OutputWord(double mg)
+{
+    static const double words_per_g[] = { 16000.0, 8000.0, 4000.0, 16000.0 / 12 };
+    uint8_t ctrl_reg4 = registers[LIS3DH_CTRL_REG4];
+    double word = mg * words_per_g[(ctrl_reg4 >> LIS3DH_CTRL_REG4_FS_SHIFT) & 0x3] / 1000.0;
+    uint16_t mask;
+
+    if (registers[LIS3DH_CTRL_REG1] & LIS3DH_CTRL_REG1_LPEN)
+    {
+        mask = 0xFF00;
+    }
+    else if (ctrl_reg4 & LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG4)
+    {
+        mask = 0xFFF0;
+    }
+    else
+    {
+        mask = 0xFFC0;
+    }
+    if (word > INT16_MAX)
+    {
+        word = INT16_MAX;
+    }
+    if (word < INT16_MIN)
+    {
+        word = INT16_MIN;
+    }
+    return (int16_t)((uint16_t)(int16_t)word & mask);
+}
+
+// Next sample of the recorded waveform or, without one, of the synthetic
+// waveform: 1 Hz rotation of +-0.5 g on X and +-0.25 g on Y, gravity on Z
+static void Generate(double seconds)
+{
+    if (waveform_length)
+    {
+        const int16_t* mg = waveform[sample_index % waveform_length];
+        Lis3dhSim_SetOutput(OutputWord(mg[0]), OutputWord(mg[1]), OutputWord(mg[2]));
+        return;
+    }
+    const double phase = 2 * M_PI * seconds;
+    Lis3dhSim_SetOutput(OutputWord(500 * sin(phase)), OutputWord(250 * cos(phase)), OutputWord(1000));
+}
+
+static uint8_t Int1Level(void)
+{
+    uint8_t ctrl_reg3 = registers[LIS3DH_CTRL_REG3];
+    uint8_t watermark = registers[LIS3DH_FIFO_CTRL_REG] & LIS3DH_FIFO_CTRL_REG_FTH;
+
+    if ((ctrl_reg3 & LIS3DH_CTRL_REG3_I1_ZYXDA) &&
+        (registers[LIS3DH_STATUS_REG] & LIS3DH_STATUS_REG_NEW_DATA))
+    {
+        return 1;
+    }
+    if ((ctrl_reg3 & LIS3DH_CTRL_REG3_I1_OVERRUN) && fifo_level == LIS3DH_FIFO_DEPTH)
+    {
+        return 1;
+    }
+    return (ctrl_reg3 & LIS3DH_CTRL_REG3_I1_WTM) && fifo_level >= watermark && fifo_level > 0;
+}
+
+static uint8_t FifoMode(void)
+{
+    return registers[LIS3DH_FIFO_CTRL_REG] & LIS3DH_FIFO_CTRL_REG_MODE;
+}
+
+static uint8_t FifoEnabled(void)
+{
+    return (registers[LIS3DH_CTRL_REG5] & LIS3DH_CTRL_REG5_FIFO_EN) &&
+           FifoMode() != LIS3DH_FIFO_CTRL_REG_BYPASS;
+}
+
+static void FifoClear(void)
+{
+    stats.overwritten += fifo_level;
+    fifo_head = 0;
+    fifo_level = 0;
+}
+
+static uint8_t FifoSource(void)
+{
+    uint8_t watermark = registers[LIS3DH_FIFO_CTRL_REG] & LIS3DH_FIFO_CTRL_REG_FTH;
+    uint8_t src = fifo_level & LIS3DH_FIFO_SRC_REG_FSS;
+
+    if (fifo_level == 0)
+    {
+        src |= LIS3DH_FIFO_SRC_REG_EMPTY;
+    }
+    // Set as soon as the FIFO is full, the next sample overwrites the oldest
+    if (fifo_level >= LIS3DH_FIFO_DEPTH)
+    {
+        src |= LIS3DH_FIFO_SRC_REG_OVRN_FIFO;
+    }
+    if (fifo_level >= watermark)
+    {
+        src |= LIS3DH_FIFO_SRC_REG_WTM;
+    }
+    return src;
+}
+
+// Reading OUT_x_H consumes the data-available and overrun flags of that
+// axis; ZYXDA and ZYXOR are cleared once the three axes have been read
+static void ReadAxis(uint8_t axis)
+{
+    uint8_t* status = &registers[LIS3DH_STATUS_REG];
+
+    if (axis == 2)
+    {
+        if (*status & (1 << axis))
+        {
+            stats.read++;
+        }
+        else
+        {
+            stats.stale++;
+        }
+    }
+    *status &= (uint8_t)~((0x01 | 0x10) << axis);
+    if (!(*status & LIS3DH_SIM_STATUS_DA))
+    {
+        *status &= (uint8_t)~(LIS3DH_STATUS_REG_NEW_DATA | LIS3DH_STATUS_REG_OVERRUN);
+    }
+}
+
+void Lis3dhSim_Reset(void)
+{
+    uint8_t i;
+    for (i = 0; i < LIS3DH_SIM_REGISTER_COUNT; i++)
+    {
+        registers[i] = 0;
+    }
+    registers[LIS3DH_WHO_AM_I_REG_ADDR] = LIS3DH_SIM_WHO_AM_I;
+    registers[LIS3DH_CTRL_REG1] = 0x07;
+    FifoClear();
+    int1_level = 0;
+    generation_ctrl_reg1 = 0;
+    sample_index = 0;
+    stats = (Lis3dhSim_Stats){ 0 };
+}
+
+uint8_t Lis3dhSim_ReadRegister(uint8_t register_address)
+{
+    register_address &= (uint8_t)~LIS3DH_SIM_AUTO_INCREMENT;
+    if (register_address >= LIS3DH_SIM_REGISTER_COUNT)
+    {
+        return 0;
+    }
+    if (register_address == LIS3DH_FIFO_SRC_REG)
+    {
+        return FifoSource();
+    }
+    if (FifoEnabled() &&
+        register_address >= LIS3DH_OUT_X_L && register_address <= LIS3DH_OUT_Z_H)
+    {
+        // Outputs are read from the oldest sample, reading OUT_Z_H pops it
+        if (fifo_level == 0)
+        {
+            if (register_address == LIS3DH_OUT_Z_H)
+            {
+                stats.stale++;
+            }
+            return 0;
+        }
+        uint8_t data = fifo[fifo_head][register_address - LIS3DH_OUT_X_L];
+        if (register_address == LIS3DH_OUT_Z_H)
+        {
+            fifo_head = (fifo_head + 1) % LIS3DH_FIFO_DEPTH;
+            fifo_level--;
+            stats.read++;
+            if (fifo_level == 0)
+            {
+                registers[LIS3DH_STATUS_REG] = 0;
+            }
+        }
+        return data;
+    }
+
+    uint8_t data = registers[register_address];
+    if (register_address >= LIS3DH_OUT_X_L && register_address <= LIS3DH_OUT_Z_H &&
+        (register_address & 1))
+    {
+        ReadAxis((uint8_t)((register_address - LIS3DH_OUT_X_L) / 2));
+    }
+    return data;
+}
+
+void Lis3dhSim_WriteRegister(uint8_t register_address, uint8_t data)
+{
+    register_address &= (uint8_t)~LIS3DH_SIM_AUTO_INCREMENT;
+    // Read-only registers
+    if (register_address >= LIS3DH_SIM_REGISTER_COUNT ||
+        register_address == LIS3DH_WHO_AM_I_REG_ADDR ||
+        register_address == LIS3DH_STATUS_REG ||
+        (register_address >= LIS3DH_OUT_X_L && register_address <= LIS3DH_FIFO_SRC_REG &&
+         register_address != LIS3DH_FIFO_CTRL_REG))
+    {
+        return;
+    }
+    registers[register_address] = data;
+    // Going through bypass mode empties the FIFO
+    if (register_address == LIS3DH_FIFO_CTRL_REG &&
+        (data & LIS3DH_FIFO_CTRL_REG_MODE) == LIS3DH_FIFO_CTRL_REG_BYPASS)
+    {
+        FifoClear();
+    }
+}
+
+uint8_t Lis3dhSim_NextAddress(uint8_t register_address)
+{
+    register_address &= (uint8_t)~LIS3DH_SIM_AUTO_INCREMENT;
+    // With the FIFO enabled the output registers roll over
+    if (FifoEnabled() && register_address == LIS3DH_OUT_Z_H)
+    {
+        return LIS3DH_OUT_X_L;
+    }
+    return register_address + 1;
+}
+
+void Lis3dhSim_ReadBurst(uint8_t sub_address, uint8_t* data, uint8_t count)
+{
+    uint8_t address = sub_address & (uint8_t)~LIS3DH_SIM_AUTO_INCREMENT;
+    uint8_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        data[i] = Lis3dhSim_ReadRegister(address);
+        if (sub_address & LIS3DH_SIM_AUTO_INCREMENT)
+        {
+            address = Lis3dhSim_NextAddress(address);
+        }
+    }
+}
+
+void Lis3dhSim_WriteBurst(uint8_t sub_address, const uint8_t* data, uint8_t count)
+{
+    uint8_t address = sub_address & (uint8_t)~LIS3DH_SIM_AUTO_INCREMENT;
+    uint8_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        Lis3dhSim_WriteRegister(address, data[i]);
+        if (sub_address & LIS3DH_SIM_AUTO_INCREMENT)
+        {
+            address++;
+        }
+    }
+}
+
+void Lis3dhSim_SetOutput(int16_t x, int16_t y, int16_t z)
+{
+    uint8_t* out = &registers[LIS3DH_OUT_X_L];
+    uint8_t* status = &registers[LIS3DH_STATUS_REG];
+
+    stats.generated++;
+    sample_index++;
+    if (FifoEnabled())
+    {
+        if (fifo_level == LIS3DH_FIFO_DEPTH)
+        {
+            stats.overwritten++;
+            if (FifoMode() == LIS3DH_FIFO_CTRL_REG_FIFO)
+            {
+                // FIFO mode: collection stops until the FIFO is read
+                return;
+            }
+            // Stream mode: the oldest sample is overwritten
+            fifo_head = (fifo_head + 1) % LIS3DH_FIFO_DEPTH;
+            fifo_level--;
+        }
+        out = fifo[(fifo_head + fifo_level) % LIS3DH_FIFO_DEPTH];
+        fifo_level++;
+        *status |= LIS3DH_SIM_STATUS_DA | LIS3DH_STATUS_REG_NEW_DATA;
+    }
+    else
+    {
+        // The axes not read yet are overrun
+        *status |= (uint8_t)((*status & LIS3DH_SIM_STATUS_DA) << 4);
+        if (*status & LIS3DH_STATUS_REG_NEW_DATA)
+        {
+            *status |= LIS3DH_STATUS_REG_OVERRUN;
+            stats.overwritten++;
+        }
+        *status |= LIS3DH_SIM_STATUS_DA | LIS3DH_STATUS_REG_NEW_DATA;
+    }
+    out[0] = (uint8_t)(x & 0xFF);
+    out[1] = (uint8_t)((uint16_t)x >> 8);
+    out[2] = (uint8_t)(y & 0xFF);
+    out[3] = (uint8_t)((uint16_t)y >> 8);
+    out[4] = (uint8_t)(z & 0xFF);
+    out[5] = (uint8_t)((uint16_t)z >> 8);
+}
+
+uint8_t Lis3dhSim_FifoLevel(void)
+{
+    return fifo_level;
+}
+
+void Lis3dhSim_SetClock(uint64_t (*now_ns)(void))
+{
+    clock_ns = now_ns;
+}
+
+void Lis3dhSim_SetInt1Handler(void (*handler)(void))
+{
+    int1_handler = handler;
+}
+
+void Lis3dhSim_SetSampleHandler(void (*handler)(uint32_t index, uint64_t ready_ns))
+{
+    sample_handler = handler;
+}
+
+void Lis3dhSim_Update(void)
+{
+    uint64_t now;
+    uint64_t due;
+    uint32_t hz;
+    uint8_t level;
+
+    if (clock_ns == NULL)
+    {
+        return;
+    }
+    now = clock_ns();
+    hz = DataRate();
+    // INT1 dropped if the outputs or the FIFO have been read since
+    int1_level = int1_level && Int1Level();
+
+    // A new rate starts from now
+    if (registers[LIS3DH_CTRL_REG1] != generation_ctrl_reg1)
+    {
+        generation_ctrl_reg1 = registers[LIS3DH_CTRL_REG1];
+        origin_ns = now;
+        generated = 0;
+    }
+    if (hz)
+    {
+        due = (now - origin_ns) * hz / LIS3DH_SIM_NS_PER_S;
+        // Only the last FIFO depth of samples can still be read: the
+        // others are accounted as lost without being produced
+        if (due - generated > LIS3DH_FIFO_DEPTH)
+        {
+            uint64_t skipped = due - generated - LIS3DH_FIFO_DEPTH;
+            stats.generated += (uint32_t)skipped;
+            stats.overwritten += (uint32_t)skipped;
+            sample_index += (uint32_t)skipped;
+            generated += skipped;
+        }
+        while (generated < due)
+        {
+            uint64_t ready_ns;
+
+            generated++;
+            ready_ns = origin_ns + (generated * LIS3DH_SIM_NS_PER_S + hz - 1) / hz;
+            if (sample_handler != NULL)
+            {
+                sample_handler(sample_index, ready_ns);
+            }
+            Generate((double)ready_ns / LIS3DH_SIM_NS_PER_S);
+        }
+    }
+
+    level = Int1Level();
+    if (level && !int1_level && int1_handler != NULL)
+    {
+        int1_handler();
+    }
+    int1_level = level;
+}
+
+uint64_t Lis3dhSim_NextSampleNs(void)
+{
+    uint32_t hz = DataRate();
+
+    if (clock_ns == NULL || hz == 0)
+    {
+        return UINT64_MAX;
+    }
+    // The rate changed after the last update: it restarts now
+    if (registers[LIS3DH_CTRL_REG1] != generation_ctrl_reg1)
+    {
+        return clock_ns();
+    }
+    // Sample k is due once (now - origin) * hz reaches k seconds
+    return origin_ns + ((generated + 1) * LIS3DH_SIM_NS_PER_S + hz - 1) / hz;
+}
+
+uint32_t Lis3dhSim_LoadWaveform(const char* path)
+{
+    FILE* file = fopen(path, "r");
+    char line[128];
+    double mg[3];
+    uint32_t capacity = 0;
+    uint32_t length = 0;
+
+    if (file == NULL)
+    {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (sscanf(line, "%lf%*[ ,;\t]%lf%*[ ,;\t]%lf", &mg[0], &mg[1], &mg[2]) != 3)
+        {
+            continue;
+        }
+        if (length == capacity)
+        {
+            capacity = capacity ? 2 * capacity : 1024;
+            waveform = realloc(waveform, capacity * sizeof(*waveform));
+        }
+        waveform[length][0] = (int16_t)mg[0];
+        waveform[length][1] = (int16_t)mg[1];
+        waveform[length][2] = (int16_t)mg[2];
+        length++;
+    }
+    fclose(file);
+    waveform_length = length;
+    return length;
+}
+
+void Lis3dhSim_GetStats(Lis3dhSim_Stats* copy)
+{
+    *copy = stats;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,153 @@
+/**
+*   \file Lis3dhSim.h
+*   \brief Host model of the LIS3DH register file.
+*
+*   The model is used by the host implementation of I2C_Interface.h in
+*   place of the real accelerometer. It implements the registers the
+*   firmware touches: WHO_AM_I, CTRL_REG1 ... CTRL_REG6 (CTRL_REG2 and
+*   CTRL_REG6 are only stored), STATUS_REG with the per-axis and ZYX
+*   data-available and overrun flags, the outputs, the FIFO in bypass,
+*   FIFO and stream mode and INT1 (I1_ZYXDA, I1_WTM and I1_OVERRUN).
+*
+*   Once a clock is given, the model produces samples at the data rate,
+*   operating mode and full-scale range configured in its registers,
+*   from a synthetic waveform or from one loaded with
+*   Lis3dhSim_LoadWaveform. Everything is a function of the clock only,
+*   so that a virtual clock gives a reproducible run.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __LIS3DHSIM_H
+    #define __LIS3DHSIM_H
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief Register address bit requesting the auto-increment of a burst.
+    */
+    #define LIS3DH_SIM_AUTO_INCREMENT 0x80
+
+    /**
+    *   \brief Counters of the samples produced and read since the reset.
+    */
+    typedef struct {
+        uint32_t generated;     ///< Samples produced at the data rate
+        uint32_t overwritten;   ///< Samples lost before being read (overrun)
+        uint32_t read;          ///< Samples read through OUT_Z_H or popped from the FIFO
+        uint32_t stale;         ///< Reads of OUT_Z_H with no new data available
+    } Lis3dhSim_Stats;
+
+    /**
+    *   \brief Reset all the registers to their power-up value and the counters to zero.
+    */
+    void Lis3dhSim_Reset(void);
+
+    /**
+    *   \brief Read one register as the I2C master would.
+    *   \param register_address Address of the register (auto-increment bit ignored).
+    */
+    uint8_t Lis3dhSim_ReadRegister(uint8_t register_address);
+
+    /**
+    *   \brief Write one register as the I2C master would.
+    *   \param register_address Address of the register (auto-increment bit ignored).
+    *   \param data Value to be written.
+    */
+    void Lis3dhSim_WriteRegister(uint8_t register_address, uint8_t data);
+
+    /**
+    *   \brief Address read after register_address during an auto-increment burst.
+    *
+    *   With the FIFO enabled the address rolls over from OUT_Z_H to OUT_X_L.
+    */
+    uint8_t Lis3dhSim_NextAddress(uint8_t register_address);
+
+    /**
+    *   \brief Read count registers in one transaction.
+    *
+    *   As on the device, the address only moves on if the sub-address has
+    *   LIS3DH_SIM_AUTO_INCREMENT set; otherwise the same register is read
+    *   count times.
+    *   \param sub_address Register address and auto-increment bit.
+    */
+    void Lis3dhSim_ReadBurst(uint8_t sub_address, uint8_t* data, uint8_t count);
+
+    /**
+    *   \brief Write count registers in one transaction.
+    *   \param sub_address Register address and auto-increment bit.
+    */
+    void Lis3dhSim_WriteBurst(uint8_t sub_address, const uint8_t* data, uint8_t count);
+
+    /**
+    *   \brief Load a new set of left-justified outputs and flag them in STATUS_REG.
+    *
+    *   With the FIFO enabled the sample is pushed in the FIFO instead; when
+    *   the FIFO is full the oldest sample is overwritten in stream mode and
+    *   the new one is discarded in FIFO mode.
+    */
+    void Lis3dhSim_SetOutput(int16_t x, int16_t y, int16_t z);
+
+    /**
+    *   \brief Number of samples stored in the simulated FIFO.
+    */
+    uint8_t Lis3dhSim_FifoLevel(void);
+
+    /**
+    *   \brief Time source of the sample generation.
+    *
+    *   Without a clock (the default) samples are only loaded with
+    *   Lis3dhSim_SetOutput.
+    *   \param now_ns Function returning the time in nanoseconds.
+    */
+    void Lis3dhSim_SetClock(uint64_t (*now_ns)(void));
+
+    /**
+    *   \brief Function called on the rising edges of INT1.
+    */
+    void Lis3dhSim_SetInt1Handler(void (*handler)(void));
+
+    /**
+    *   \brief Function called for every sample produced from the clock.
+    *
+    *   Given the index of the sample since the reset, which is also its
+    *   line in a recorded waveform, and the time it is ready at.
+    */
+    void Lis3dhSim_SetSampleHandler(void (*handler)(uint32_t index, uint64_t ready_ns));
+
+    /**
+    *   \brief Generate the samples due up to now and update INT1.
+    *
+    *   Called by the host I2C interface at the start of every transaction,
+    *   so that the registers do not change during a burst.
+    */
+    void Lis3dhSim_Update(void);
+
+    /**
+    *   \brief Time of the next sample, in nanoseconds.
+    *
+    *   To be called after Lis3dhSim_Update.
+    *   \retval UINT64_MAX in power-down or without a clock.
+    */
+    uint64_t Lis3dhSim_NextSampleNs(void);
+
+    /**
+    *   \brief Play back a recorded waveform instead of the synthetic one.
+    *
+    *   One sample per line, the X, Y and Z accelerations in mg separated by
+    *   commas or blanks; lines that do not start with a number (headers)
+    *   are skipped. The samples are produced one per data rate period, in
+    *   a loop.
+    *   \param path File to load.
+    *   \retval Number of samples loaded, 0 if the file cannot be read: the
+    *           synthetic waveform is then kept.
+    */
+    uint32_t Lis3dhSim_LoadWaveform(const char* path);
+
+    /**
+    *   \brief Copy the sample counters.
+    */
+    void Lis3dhSim_GetStats(Lis3dhSim_Stats* stats);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,252 @@
+/*
+* MARCO MAESTRONI
+*
+* Host report of the LIS3DH model: checks of the register semantics the
+* firmware relies on, then the single sample burst read polled and on
+* INT1 at every ODR and I2C bus speed, in the virtual time given by the
+* bus cycles. Each acquisition is run twice and must give the same
+* counters.
+*
+* Build from this folder with:
+*   cc -I. -I.. -o Lis3dhSimReport Lis3dhSimReport.c I2C_Interface_Host.c \
+*      Lis3dhSim.c ../LIS3DH_Driver.c ../LIS3DH_Odr.c ../LIS3DH_Convert.c -lm
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "I2C_Interface.h"
+#include "I2C_Interface_Host.h"
+#include "LIS3DH_Driver.h"
+#include "LIS3DH_Odr.h"
+#include "Lis3dhSim.h"
+
+#define RUN_NS          1000000000ULL
+#define NS_PER_S        1000000000ULL
+#define WAVEFORM_FILE   "Lis3dhSimReport.csv"
+
+// STATUS_REG with every data-available and overrun flag set
+#define STATUS_ALL      0xFF
+
+static uint64_t now_ns;
+static uint32_t bus_hz;
+static uint32_t edges;
+static int failures;
+
+static uint64_t Now(void)
+{
+    return now_ns;
+}
+
+static void OnBus(uint32_t scl_cycles)
+{
+    now_ns += (uint64_t)scl_cycles * NS_PER_S / bus_hz;
+}
+
+static void OnInt1(void)
+{
+    edges++;
+}
+
+static void Check(int condition, const char* what)
+{
+    printf("%-56s %s\n", what, condition ? "ok" : "FAILED");
+    if (!condition)
+    {
+        failures++;
+    }
+}
+
+static void CheckRegisters(void)
+{
+    uint8_t data[LIS3DH_SAMPLE_BURST_LENGTH];
+    uint8_t ctrl[6] = { 0x57, 0x01, 0x10, 0x88, 0x40, 0x02 };
+    uint8_t i;
+    Lis3dhSim_Stats stats;
+
+    Lis3dhSim_SetClock(NULL);
+    I2C_Peripheral_Start();
+
+    I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_WHO_AM_I_REG_ADDR, data);
+    Check(data[0] == 0x33, "WHO_AM_I reads 0x33");
+
+    I2C_Peripheral_WriteRegisterMulti(LIS3DH_DEVICE_ADDRESS, LIS3DH_CTRL_REG1, 6, ctrl);
+    I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS, LIS3DH_CTRL_REG1, 6, data);
+    Check(memcmp(data, ctrl, 6) == 0, "CTRL_REG1 ... CTRL_REG6 written and read in a burst");
+
+    // Two samples without a read in between: the first one is overrun
+    Lis3dhSim_WriteRegister(LIS3DH_CTRL_REG5, 0);
+    Lis3dhSim_SetOutput(0x1230, 0x4560, 0x7890);
+    Lis3dhSim_SetOutput(0x1110, 0x2220, 0x3330);
+    Lis3dhSim_ReadBurst(LIS3DH_STATUS_REG | LIS3DH_SIM_AUTO_INCREMENT, data, LIS3DH_SAMPLE_BURST_LENGTH);
+    Check(data[0] == STATUS_ALL, "STATUS_REG flags ZYXDA, ZYXOR and every axis");
+    Check(data[1] == 0x10 && data[2] == 0x11 && data[5] == 0x30 && data[6] == 0x33,
+          "outputs hold the newest sample");
+    Check(Lis3dhSim_ReadRegister(LIS3DH_STATUS_REG) == 0, "reading OUT_X_H ... OUT_Z_H clears STATUS_REG");
+
+    Lis3dhSim_SetOutput(0x1110, 0x2220, 0x3330);
+    Lis3dhSim_ReadRegister(LIS3DH_OUT_X_L + 1);
+    data[0] = Lis3dhSim_ReadRegister(LIS3DH_STATUS_REG);
+    Check(data[0] == (LIS3DH_STATUS_REG_NEW_DATA | 0x06), "reading OUT_X_H only clears XDA");
+    Lis3dhSim_ReadBurst(LIS3DH_OUT_Y_L, data, 4);
+    Check(data[0] == 0x20 && data[3] == 0x20, "without the 0x80 bit a burst reads one register");
+    Lis3dhSim_ReadBurst(LIS3DH_OUT_Y_L | LIS3DH_SIM_AUTO_INCREMENT, data, 4);
+    Check(data[1] == 0x22 && data[3] == 0x33, "with the 0x80 bit a burst auto-increments");
+    Check(Lis3dhSim_ReadRegister(LIS3DH_OUT_Z_H) == 0x33, "a stale read returns the last sample");
+    Lis3dhSim_GetStats(&stats);
+    Check(stats.generated == 3 && stats.overwritten == 1 && stats.read == 2 && stats.stale == 1,
+          "generated, overwritten, read and stale counters");
+
+    // FIFO mode keeps the first 32 samples, stream mode the last 32
+    Lis3dhSim_WriteRegister(LIS3DH_CTRL_REG5, LIS3DH_CTRL_REG5_FIFO_EN);
+    Lis3dhSim_WriteRegister(LIS3DH_FIFO_CTRL_REG, LIS3DH_FIFO_CTRL_REG_FIFO);
+    for (i = 0; i < LIS3DH_FIFO_DEPTH + 8; i++)
+    {
+        Lis3dhSim_SetOutput((int16_t)(i << 4), 0, 0);
+    }
+    Lis3dhSim_ReadBurst(LIS3DH_OUT_X_L | LIS3DH_SIM_AUTO_INCREMENT, data, 6);
+    Check(Lis3dhSim_FifoLevel() == LIS3DH_FIFO_DEPTH - 1 && data[0] == 0,
+          "FIFO mode stops collecting when full");
+
+    Lis3dhSim_WriteRegister(LIS3DH_FIFO_CTRL_REG, LIS3DH_FIFO_CTRL_REG_BYPASS);
+    Lis3dhSim_WriteRegister(LIS3DH_FIFO_CTRL_REG, LIS3DH_FIFO_CTRL_REG_STREAM);
+    for (i = 0; i < LIS3DH_FIFO_DEPTH + 8; i++)
+    {
+        Lis3dhSim_SetOutput((int16_t)(i << 4), 0, 0);
+    }
+    Check((Lis3dhSim_ReadRegister(LIS3DH_FIFO_SRC_REG) & LIS3DH_FIFO_SRC_REG_OVRN_FIFO) != 0,
+          "stream mode flags the overrun in FIFO_SRC_REG");
+    Lis3dhSim_ReadBurst(LIS3DH_OUT_X_L | LIS3DH_SIM_AUTO_INCREMENT, data, 6);
+    Check(data[0] == 8 << 4, "stream mode overwrites the oldest samples");
+}
+
+static void CheckClock(void)
+{
+    FILE* file;
+    uint8_t data[LIS3DH_SAMPLE_BURST_LENGTH];
+    LIS3DH_Sample sample;
+
+    I2C_Host_SetBusHook(NULL);
+    Lis3dhSim_SetClock(Now);
+    Lis3dhSim_SetInt1Handler(OnInt1);
+    now_ns = 0;
+    edges = 0;
+    I2C_Peripheral_Start();
+
+    // 100 Hz, data-ready on INT1: one edge per sample read in time
+    I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_CTRL_REG1, 0x57);
+    I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_CTRL_REG3, LIS3DH_CTRL_REG3_I1_ZYXDA);
+    Lis3dhSim_Update();
+    Check(Lis3dhSim_NextSampleNs() == 10000000, "first sample one period after the rate is set");
+    while (now_ns < 100000000)
+    {
+        now_ns = Lis3dhSim_NextSampleNs();
+        Lis3dhSim_Update();
+        LIS3DH_ReadSample(&sample);
+    }
+    Check(edges == 10, "one INT1 edge per sample");
+
+    // Recorded waveform, played back one line per sample
+    file = fopen(WAVEFORM_FILE, "w");
+    if (file == NULL)
+    {
+        Check(0, "recorded waveform file written");
+        return;
+    }
+    fprintf(file, "x,y,z\n100,-200,1000\n-300,400,-1000\n");
+    fclose(file);
+    Check(Lis3dhSim_LoadWaveform(WAVEFORM_FILE) == 2, "recorded waveform loaded");
+    remove(WAVEFORM_FILE);
+
+    I2C_Peripheral_Start();
+    I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_CTRL_REG4, 0x08);
+    I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_CTRL_REG1, 0x57);
+    Lis3dhSim_Update();
+    now_ns = Lis3dhSim_NextSampleNs();
+    LIS3DH_ReadSample(&sample);
+    now_ns = Lis3dhSim_NextSampleNs();
+    I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS, LIS3DH_STATUS_REG,
+                                     LIS3DH_SAMPLE_BURST_LENGTH, data);
+    LIS3DH_DecodeSample(data, &sample);
+    // +-2 g high resolution: 16 words per mg
+    Check(sample.x == -300 * 16 && sample.y == 400 * 16 && sample.z == -1000 * 16,
+          "recorded waveform played back in order");
+    Check(Lis3dhSim_LoadWaveform("/nonexistent/waveform.csv") == 0, "missing waveform file reported");
+}
+
+// One second of acquisition with the sample burst, polled or on INT1
+static void Acquire(const LIS3DH_OdrDescriptor* odr, uint8_t on_int1, Lis3dhSim_Stats* stats)
+{
+    LIS3DH_Sample sample;
+
+    Lis3dhSim_SetClock(Now);
+    Lis3dhSim_SetInt1Handler(NULL);
+    I2C_Host_SetBusHook(OnBus);
+    now_ns = 0;
+    I2C_Peripheral_Start();
+    LIS3DH_SetOdr(odr);
+
+    while (now_ns < RUN_NS)
+    {
+        if (on_int1)
+        {
+            // Sleep until the next sample unless one is already waiting
+            Lis3dhSim_Update();
+            if (!(Lis3dhSim_ReadRegister(LIS3DH_STATUS_REG) & LIS3DH_STATUS_REG_NEW_DATA))
+            {
+                now_ns = Lis3dhSim_NextSampleNs();
+            }
+        }
+        LIS3DH_ReadSample(&sample);
+    }
+    Lis3dhSim_GetStats(stats);
+}
+
+static void MeasureRates(void)
+{
+    static const uint32_t speeds[] = { 100000, 400000 };
+    Lis3dhSim_Stats stats;
+    Lis3dhSim_Stats again;
+    uint8_t i;
+    uint8_t s;
+    uint8_t on_int1;
+
+    printf("\n%-6s %-5s %-8s %9s %9s %11s %9s %10s\n",
+           "read", "kHz", "ODR Hz", "generated", "received", "overwritten", "stale", "samples/s");
+    for (on_int1 = 0; on_int1 <= 1; on_int1++)
+    {
+        for (s = 0; s < sizeof(speeds) / sizeof(speeds[0]); s++)
+        {
+            bus_hz = speeds[s];
+            for (i = 0; i < LIS3DH_ODR_COUNT; i++)
+            {
+                const LIS3DH_OdrDescriptor* odr = &LIS3DH_OdrTable[i];
+
+                Acquire(odr, on_int1, &stats);
+                Acquire(odr, on_int1, &again);
+                printf("%-6s %-5u %-8u %9u %9u %11u %9u %10.1f\n",
+                       on_int1 ? "INT1" : "poll", (unsigned)(bus_hz / 1000), (unsigned)odr->hz,
+                       (unsigned)stats.generated, (unsigned)stats.read, (unsigned)stats.overwritten,
+                       (unsigned)stats.stale, stats.read * (double)NS_PER_S / RUN_NS);
+                // Every sample is either read or lost, the last one may still be waiting
+                if (memcmp(&stats, &again, sizeof(stats)) != 0 ||
+                    stats.generated - stats.read - stats.overwritten > 1)
+                {
+                    printf("  ^ FAILED\n");
+                    failures++;
+                }
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    CheckRegisters();
+    CheckClock();
+    MeasureRates();
+
+    printf("\n%s\n", failures ? "FAILED" : "all checks passed");
+    return failures != 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,142 @@
+/*
+* MARCO MAESTRONI
+*
+* Decoder of a capture of version 2, batch or raw frames: reads the bytes
+* received from the serial port (file or standard input) and prints the
+* stream statistics, the last health frame and the last profile frame if
+* the firmware sends them (ACQ_HEALTH_PERIOD_MS, ACQ_PROFILE). The samples
+* of the raw frames are converted with the descriptor frames and their
+* mean acceleration is printed.
+*
+* Build from this folder with:
+*   cc -I. -I.. -o PacketDecode PacketDecode.c PacketDecoder.c ConvertBatch.c ../Packet.c \
+*      ../Crc8.c -lm
+*
+* Usage:
+*   ./PacketDecode [--cobs] capture.bin
+*   ./PacketDecode [--cobs] < /dev/ttyACM0
+*
+* --cobs decodes the frames of a firmware built with ACQ_FRAMING_COBS.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "PacketDecoder.h"
+#include "Profile.h"
+
+int main(int argc, char** argv)
+{
+    FILE* input = stdin;
+    static PacketDecoder decoder;
+    uint8_t cobs = 0;
+    uint32_t converted = 0;
+    double sum[3] = {0, 0, 0};
+    int byte;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--cobs") == 0)
+        {
+            cobs = 1;
+        }
+        else
+        {
+            input = fopen(argv[i], "rb");
+            if (input == NULL)
+            {
+                perror(argv[i]);
+                return 1;
+            }
+        }
+    }
+
+    PacketDecoder_Init(&decoder);
+    if (cobs)
+    {
+        PacketDecoder_UseCobs(&decoder);
+    }
+    while ((byte = fgetc(input)) != EOF)
+    {
+        uint8_t count = PacketDecoder_Push(&decoder, (uint8_t)byte);
+        uint8_t s;
+
+        for (s = 0; s < count; s++)
+        {
+            const PacketDecoder_Sample* sample = &decoder.samples[s];
+            if (sample->converted)
+            {
+                converted++;
+                sum[0] += sample->ax;
+                sum[1] += sample->ay;
+                sum[2] += sample->az;
+            }
+        }
+    }
+
+    const PacketDecoder_Stats* stats = &decoder.stats;
+    printf("frames      %u (%u samples)\n", (unsigned)stats->frames, (unsigned)stats->samples);
+    printf("lost        %u\n", (unsigned)stats->lost);
+    printf("reordered   %u\n", (unsigned)stats->reordered);
+    printf("duplicated  %u\n", (unsigned)stats->duplicated);
+    printf("crc errors  %u (%u bytes skipped)\n",
+           (unsigned)stats->crc_errors, (unsigned)stats->skipped_bytes);
+    printf("period      %.3f ms mean, %.3f ms jitter rms, %.3f ... %.3f ms\n",
+           PacketDecoder_PeriodMean(stats), PacketDecoder_PeriodJitter(stats),
+           stats->period_min, stats->period_max);
+
+    if (stats->descriptors > 0)
+    {
+        const Packet_Descriptor* descriptor = &decoder.descriptor;
+
+        printf("descriptors %u, last one +-%u g, mode %u, shift %u, %u mg/digit, ODR code %u\n",
+               (unsigned)stats->descriptors, (unsigned)descriptor->g, (unsigned)descriptor->mode,
+               (unsigned)descriptor->shift, (unsigned)descriptor->mg_per_digit,
+               (unsigned)descriptor->odr);
+    }
+    if (converted > 0 || stats->unconverted > 0)
+    {
+        printf("converted   %u samples (%u unconverted), mean X %.3f Y %.3f Z %.3f m/s^2\n",
+               (unsigned)converted, (unsigned)stats->unconverted, converted ? sum[0] / converted : 0.0,
+               converted ? sum[1] / converted : 0.0, converted ? sum[2] / converted : 0.0);
+    }
+    if (stats->healths > 0)
+    {
+        const Packet_Health* health = &decoder.health;
+
+        printf("healths     %u, last one at %u ms, ODR code %u:\n",
+               (unsigned)stats->healths, (unsigned)health->timestamp, (unsigned)health->odr);
+        printf("  samples   %u read, %u stale reads\n",
+               (unsigned)health->samples, (unsigned)health->stale);
+        printf("  overruns  %u (X %u, Y %u, Z %u), FIFO %u\n",
+               (unsigned)health->overruns, (unsigned)health->overrun_x,
+               (unsigned)health->overrun_y, (unsigned)health->overrun_z,
+               (unsigned)health->fifo_overruns);
+        printf("  errors    %u failed reads, %u button events dropped\n",
+               (unsigned)health->read_errors, (unsigned)health->button_drops);
+        printf("  power     %u wakeups, %u ms asleep, duty cycle %.1f %%\n",
+               (unsigned)health->wakeups, (unsigned)health->sleep_ms,
+               health->timestamp ? 100.0 - 100.0 * health->sleep_ms / health->timestamp : 100.0);
+    }
+    if (stats->profiles > 0)
+    {
+        static const char* names[PROFILE_STAGES] = PROFILE_STAGE_NAMES;
+        const Packet_Profile* profile = &decoder.profile;
+        uint8_t i;
+
+        printf("profiles    %u, last one at %u cycles/ms:\n",
+               (unsigned)stats->profiles, (unsigned)profile->cycles_per_ms);
+        printf("  %-10s %8s %8s %8s %8s %10s\n", "stage", "calls", "min", "avg", "max", "avg us");
+        for (i = 0; i < profile->count; i++)
+        {
+            const Packet_ProfileStage* stage = &profile->stages[i];
+            printf("  %-10s %8u %8u %8u %8u %10.3f\n",
+                   i < PROFILE_STAGES ? names[i] : "?", (unsigned)stage->calls,
+                   (unsigned)stage->min, (unsigned)stage->avg, (unsigned)stage->max,
+                   profile->cycles_per_ms ? stage->avg * 1000.0 / profile->cycles_per_ms : 0.0);
+        }
+    }
+    return 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,453 @@
+/*
+* MARCO MAESTRONI
+*
+* Host decoder of the version 1, version 2, batch, raw, descriptor, profile
+* and health frames
+*/
+
+#include <math.h>
+#include <string.h>
+#include "PacketDecoder.h"
+#include "Cobs.h"
+
+// Bytes of the batch header needed to know the frame length
+#define BATCH_COUNT_LENGTH 8
+
+// Bytes of the profile header needed to know the frame length
+#define PROFILE_COUNT_LENGTH 2
+
+// Bytes of the health header needed to know the frame length
+#define HEALTH_VERSION_LENGTH 2
+
+void PacketDecoder_Init(PacketDecoder* decoder)
+{
+    memset(decoder, 0, sizeof(*decoder));
+}
+
+void PacketDecoder_InitV1(PacketDecoder* decoder)
+{
+    PacketDecoder_Init(decoder);
+    decoder->v1 = 1;
+}
+
+void PacketDecoder_UseCobs(PacketDecoder* decoder)
+{
+    decoder->cobs = 1;
+}
+
+/*
+* Account a frame of count samples starting at sequence number seq;
+* mask is the range of the sequence number of the frame format.
+* Returns 0 if the frame is a duplicate or arrived late.
+*/
+static uint8_t Account(PacketDecoder* decoder, uint16_t seq, uint16_t mask,
+                       uint8_t count, uint32_t timestamp)
+{
+    PacketDecoder_Stats* stats = &decoder->stats;
+    uint16_t expected = (decoder->last_seq + decoder->last_count) & mask;
+    uint16_t gap = (seq - expected) & mask;
+    uint16_t distance = (seq - decoder->last_seq) & mask;
+
+    stats->frames++;
+    stats->samples += count;
+    if (!decoder->have_last)
+    {
+        decoder->have_last = 1;
+    }
+    else if (distance == 0)
+    {
+        stats->duplicated++;
+        return 0;
+    }
+    else if (gap > mask / 2)
+    {
+        // Counted as lost when the newer one arrived: not lost after all
+        stats->reordered++;
+        stats->lost = stats->lost > count ? stats->lost - count : 0;
+        return 0;
+    }
+    else
+    {
+        stats->lost += gap;
+
+        // Period over the samples in between, lost ones included
+        double period = (double)(timestamp - decoder->last_timestamp) / distance;
+        if (stats->intervals == 0 || period < stats->period_min)
+        {
+            stats->period_min = period;
+        }
+        if (stats->intervals == 0 || period > stats->period_max)
+        {
+            stats->period_max = period;
+        }
+        stats->intervals++;
+        stats->period_sum += period;
+        stats->period_sum_sq += period * period;
+        decoder->last_period = period;
+    }
+    decoder->last_seq = seq;
+    decoder->last_count = count;
+    decoder->last_timestamp = timestamp;
+    return 1;
+}
+
+// Length of the candidate frame, 0 while it is not known yet
+static uint16_t FrameLength(const PacketDecoder* decoder)
+{
+    if (decoder->frame[0] == PACKET_V1_HEADER)
+    {
+        return PACKET_V1_LENGTH;
+    }
+    if (decoder->frame[0] == PACKET_V2_SYNC)
+    {
+        return PACKET_V2_LENGTH;
+    }
+    if (decoder->frame[0] == PACKET_HEALTH_SYNC)
+    {
+        if (decoder->length < HEALTH_VERSION_LENGTH)
+        {
+            return 0;
+        }
+        // Another layout has another length: not decoded
+        if (decoder->frame[HEALTH_VERSION_LENGTH - 1] != PACKET_HEALTH_VERSION)
+        {
+            return decoder->length;
+        }
+        return PACKET_HEALTH_LENGTH;
+    }
+    if (decoder->frame[0] == PACKET_DESCRIPTOR_SYNC)
+    {
+        return PACKET_DESCRIPTOR_LENGTH;
+    }
+    if (decoder->frame[0] == PACKET_PROFILE_SYNC)
+    {
+        if (decoder->length < PROFILE_COUNT_LENGTH)
+        {
+            return 0;
+        }
+        uint8_t stages = decoder->frame[PROFILE_COUNT_LENGTH - 1];
+        if (stages == 0 || stages > PACKET_PROFILE_MAX_STAGES)
+        {
+            return decoder->length;
+        }
+        return PACKET_PROFILE_LENGTH(stages);
+    }
+    if (decoder->length <= BATCH_COUNT_LENGTH)
+    {
+        return 0;
+    }
+    uint8_t count = decoder->frame[BATCH_COUNT_LENGTH - 1];
+    if (count == 0 || count > PACKET_BATCH_MAX)
+    {
+        // Not a frame: rejected as soon as possible
+        return decoder->length;
+    }
+    return decoder->frame[0] == PACKET_RAW_SYNC ? PACKET_RAW_LENGTH(count) : PACKET_BATCH_LENGTH(count);
+}
+
+// Convert the output words of a raw frame with the descriptor of its rate
+static void Convert(PacketDecoder* decoder, const Packet_Batch* batch)
+{
+    static float columns[3][PACKET_BATCH_MAX];
+    PacketDecoder_Sample* out = decoder->samples;
+    uint8_t i;
+
+    if (!decoder->have_descriptor || decoder->descriptor.odr != batch->odr)
+    {
+        decoder->stats.unconverted += batch->count;
+        return;
+    }
+    ConvertBatch_Run(batch->x, columns[0], batch->count, decoder->descriptor.shift, decoder->scale);
+    ConvertBatch_Run(batch->y, columns[1], batch->count, decoder->descriptor.shift, decoder->scale);
+    ConvertBatch_Run(batch->z, columns[2], batch->count, decoder->descriptor.shift, decoder->scale);
+    for (i = 0; i < batch->count; i++)
+    {
+        out[i].converted = 1;
+        out[i].ax = columns[0][i];
+        out[i].ay = columns[1][i];
+        out[i].az = columns[2][i];
+    }
+}
+
+// Decode the complete candidate frame, returns the number of samples
+static uint8_t Decode(PacketDecoder* decoder, uint8_t* valid)
+{
+    PacketDecoder_Sample* out = decoder->samples;
+    *valid = 0;
+
+    if (decoder->frame[0] == PACKET_V1_HEADER)
+    {
+        if (decoder->frame[PACKET_V1_LENGTH - 1] != PACKET_V1_FOOTER)
+        {
+            return 0;
+        }
+        *valid = 1;
+        decoder->stats.frames++;
+        decoder->stats.samples++;
+        out->seq = decoder->v1_frames++;
+        out->timestamp = 0;
+        out->x = (int16_t)(decoder->frame[1] | decoder->frame[2] << 8);
+        out->y = (int16_t)(decoder->frame[3] | decoder->frame[4] << 8);
+        out->z = (int16_t)(decoder->frame[5] | decoder->frame[6] << 8);
+        out->odr = decoder->health.odr;
+        out->mms2 = 1;
+        out->word = 0;
+        out->converted = 1;
+        out->ax = out->x / 1000.0f;
+        out->ay = out->y / 1000.0f;
+        out->az = out->z / 1000.0f;
+        return 1;
+    }
+
+    if (decoder->frame[0] == PACKET_V2_SYNC)
+    {
+        Packet_V2 packet;
+        if (Packet_ParseV2(decoder->frame, &packet) != NO_ERROR)
+        {
+            return 0;
+        }
+        *valid = 1;
+        if (!Account(decoder, packet.seq, 0xFF, 1, packet.timestamp))
+        {
+            return 0;
+        }
+        out->seq = packet.seq;
+        out->timestamp = packet.timestamp;
+        out->x = packet.x;
+        out->y = packet.y;
+        out->z = packet.z;
+        out->odr = packet.odr;
+        out->mms2 = 0;
+        out->word = 0;
+        out->converted = 0;
+        return 1;
+    }
+
+    if (decoder->frame[0] == PACKET_HEALTH_SYNC)
+    {
+        if (Packet_ParseHealth(decoder->frame, &decoder->health) != NO_ERROR)
+        {
+            return 0;
+        }
+        *valid = 1;
+        decoder->stats.healths++;
+        return 0;
+    }
+
+    if (decoder->frame[0] == PACKET_DESCRIPTOR_SYNC)
+    {
+        LIS3DH_Sensitivity sensitivity;
+
+        if (Packet_ParseDescriptor(decoder->frame, &decoder->descriptor) != NO_ERROR)
+        {
+            return 0;
+        }
+        *valid = 1;
+        sensitivity.shift = decoder->descriptor.shift;
+        sensitivity.mg_per_digit = decoder->descriptor.mg_per_digit;
+        sensitivity.mms2_q = decoder->descriptor.mms2_q;
+        decoder->scale = ConvertBatch_Scale(&sensitivity);
+        decoder->have_descriptor = 1;
+        decoder->stats.descriptors++;
+        return 0;
+    }
+
+    if (decoder->frame[0] == PACKET_PROFILE_SYNC)
+    {
+        if (Packet_ParseProfile(decoder->frame, decoder->length, &decoder->profile) != NO_ERROR)
+        {
+            return 0;
+        }
+        *valid = 1;
+        decoder->stats.profiles++;
+        return 0;
+    }
+
+    static Packet_Batch batch;
+    const uint8_t raw = decoder->frame[0] == PACKET_RAW_SYNC;
+    uint8_t i;
+    if ((raw ? Packet_ParseRaw(decoder->frame, decoder->length, &batch)
+             : Packet_ParseBatch(decoder->frame, decoder->length, &batch)) != NO_ERROR)
+    {
+        return 0;
+    }
+    *valid = 1;
+    if (!Account(decoder, batch.seq, 0xFFFF, batch.count, batch.timestamp))
+    {
+        return 0;
+    }
+    // The samples of a batch are one period apart
+    for (i = 0; i < batch.count; i++)
+    {
+        out[i].seq = batch.seq + i;
+        out[i].timestamp = batch.timestamp + i * decoder->last_period;
+        out[i].x = batch.x[i];
+        out[i].y = batch.y[i];
+        out[i].z = batch.z[i];
+        out[i].odr = batch.odr;
+        out[i].mms2 = 0;
+        out[i].word = raw;
+        out[i].converted = 0;
+    }
+    if (raw)
+    {
+        Convert(decoder, &batch);
+    }
+    return batch.count;
+}
+
+static uint8_t IsSync(const PacketDecoder* decoder, uint8_t byte)
+{
+    if (byte == PACKET_PROFILE_SYNC || byte == PACKET_HEALTH_SYNC)
+    {
+        return 1;
+    }
+    if (decoder->v1)
+    {
+        return byte == PACKET_V1_HEADER;
+    }
+    return byte == PACKET_V2_SYNC || byte == PACKET_BATCH_SYNC ||
+           byte == PACKET_RAW_SYNC || byte == PACKET_DESCRIPTOR_SYNC;
+}
+
+// A delimiter ends the encoded frame: decode it if it is complete
+static uint8_t EndCobs(PacketDecoder* decoder)
+{
+    uint8_t valid = 0;
+    uint8_t count = 0;
+
+    if (decoder->cobs_bytes == 0)
+    {
+        return 0;
+    }
+    if (decoder->cobs_overflow || decoder->cobs_left != 0 || decoder->length == 0 ||
+        !IsSync(decoder, decoder->frame[0]))
+    {
+        // Not a frame (a string, or the bytes before the first delimiter)
+        decoder->stats.skipped_bytes += decoder->cobs_bytes;
+    }
+    else
+    {
+        if (FrameLength(decoder) == decoder->length)
+        {
+            count = Decode(decoder, &valid);
+        }
+        if (!valid)
+        {
+            decoder->stats.crc_errors++;
+            decoder->stats.skipped_bytes += decoder->cobs_bytes;
+        }
+    }
+    decoder->length = 0;
+    decoder->cobs_left = 0;
+    decoder->cobs_code = 0;
+    decoder->cobs_overflow = 0;
+    decoder->cobs_bytes = 0;
+    return count;
+}
+
+// Add a decoded byte to the frame
+static void AppendCobs(PacketDecoder* decoder, uint8_t byte)
+{
+    if (decoder->length >= sizeof(decoder->frame))
+    {
+        decoder->cobs_overflow = 1;
+        return;
+    }
+    decoder->frame[decoder->length++] = byte;
+}
+
+static uint8_t PushCobs(PacketDecoder* decoder, uint8_t byte)
+{
+    if (byte == COBS_DELIMITER)
+    {
+        return EndCobs(decoder);
+    }
+    decoder->cobs_bytes++;
+    if (decoder->cobs_left == 0)
+    {
+        // Code byte: the previous group, unless it was a full one, ended
+        // with a 0x00 that was removed
+        if (decoder->cobs_code != 0 && decoder->cobs_code != 0xFF)
+        {
+            AppendCobs(decoder, 0x00);
+        }
+        decoder->cobs_code = byte;
+        decoder->cobs_left = byte - 1;
+    }
+    else
+    {
+        decoder->cobs_left--;
+        AppendCobs(decoder, byte);
+    }
+    return 0;
+}
+
+uint8_t PacketDecoder_Push(PacketDecoder* decoder, uint8_t byte)
+{
+    uint16_t length;
+    uint16_t i;
+    uint8_t valid;
+    uint8_t count;
+
+    if (decoder->cobs)
+    {
+        return PushCobs(decoder, byte);
+    }
+
+    // Wait for a sync byte
+    if (decoder->length == 0 && !IsSync(decoder, byte))
+    {
+        decoder->stats.skipped_bytes++;
+        return 0;
+    }
+    decoder->frame[decoder->length++] = byte;
+
+    // After a resynchronisation the bytes kept can hold a whole frame
+    while (decoder->length > 0)
+    {
+        length = FrameLength(decoder);
+        if (length == 0 || decoder->length < length)
+        {
+            return 0;
+        }
+
+        count = Decode(decoder, &valid);
+        if (valid)
+        {
+            decoder->length -= length;
+            memmove(decoder->frame, &decoder->frame[length], decoder->length);
+            return count;
+        }
+
+        // Resynchronise on the next sync byte of the candidate frame
+        decoder->stats.crc_errors++;
+        for (i = 1; i < decoder->length && !IsSync(decoder, decoder->frame[i]); i++)
+        {
+        }
+        decoder->stats.skipped_bytes += i;
+        decoder->length -= i;
+        memmove(decoder->frame, &decoder->frame[i], decoder->length);
+    }
+    return 0;
+}
+
+double PacketDecoder_PeriodMean(const PacketDecoder_Stats* stats)
+{
+    return stats->intervals ? stats->period_sum / stats->intervals : 0;
+}
+
+double PacketDecoder_PeriodJitter(const PacketDecoder_Stats* stats)
+{
+    double mean = PacketDecoder_PeriodMean(stats);
+    double variance;
+
+    if (stats->intervals == 0)
+    {
+        return 0;
+    }
+    variance = stats->period_sum_sq / stats->intervals - mean * mean;
+    return variance > 0 ? sqrt(variance) : 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,163 @@
+/**
+*   \file PacketDecoder.h
+*   \brief Host decoder of the version 1, version 2, batch, raw,
+*   descriptor, profile and health frames.
+*
+*   Bytes received from the serial port are pushed one at a time; the
+*   decoder finds the frames, checks the CRC and accounts lost, reordered
+*   and duplicated samples from the sequence numbers, and the jitter of
+*   the sample period from the timestamps. The last profile and health
+*   frames are kept apart from the samples.
+*
+*   The version 1 frames (PACKET_V1_HEADER, X, Y, Z, PACKET_V1_FOOTER)
+*   have no CRC, sequence number or timestamp: they are only checked by
+*   their footer, and only decoded with PacketDecoder_InitV1, in place of
+*   the version 2 and batch frames. Losses cannot be counted.
+*
+*   The output words of the raw frames (ACQ_PACKET_FORMAT_RAW) are
+*   converted to m/s^2 here, a frame at a time (Host/ConvertBatch.h), with
+*   the last descriptor frame of their data rate; the samples received
+*   before it are kept as words only.
+*
+*   With PacketDecoder_UseCobs the frames are expected COBS-encoded and
+*   delimited by 0x00 (ACQ_FRAMING_COBS, Cobs.h): they are decoded as the
+*   bytes arrive, in constant time per byte, and a lost or corrupted byte
+*   only costs the frame it belongs to, or the next one too if it was
+*   the delimiter.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __PACKETDECODER_H
+    #define __PACKETDECODER_H
+
+    #include "cytypes.h"
+    #include "Packet.h"
+    #include "ConvertBatch.h"
+
+    /**
+    *   \brief First byte of a version 1 frame.
+    */
+    #define PACKET_V1_HEADER 0xA0
+
+    /**
+    *   \brief Last byte of a version 1 frame.
+    */
+    #define PACKET_V1_FOOTER 0xC0
+
+    /**
+    *   \brief Bytes of a version 1 frame.
+    */
+    #define PACKET_V1_LENGTH 8
+
+    /**
+    *   \brief Stream statistics.
+    */
+    typedef struct {
+        uint32_t frames;            ///< Valid frames
+        uint32_t samples;           ///< Samples of the valid frames
+        uint32_t crc_errors;        ///< Candidate frames rejected by the CRC or the footer
+        uint32_t skipped_bytes;     ///< Bytes discarded while resynchronising
+        uint32_t lost;              ///< Sequence numbers never received
+        uint32_t reordered;         ///< Frames older than the newest one
+        uint32_t duplicated;        ///< Frames with the sequence number of the previous one
+        uint32_t profiles;          ///< Valid profile frames
+        uint32_t healths;           ///< Valid health frames
+        uint32_t descriptors;       ///< Valid descriptor frames
+        uint32_t unconverted;       ///< Raw samples received with no descriptor of their data rate
+        uint32_t intervals;         ///< Sample periods measured
+        double period_sum;          ///< Sum of the periods (ms)
+        double period_sum_sq;       ///< Sum of the squared periods (ms^2)
+        double period_min;          ///< Shortest period (ms)
+        double period_max;          ///< Longest period (ms)
+    } PacketDecoder_Stats;
+
+    /**
+    *   \brief One decoded sample.
+    */
+    typedef struct {
+        uint16_t seq;               ///< Sequence number (8 bit in version 2 frames, frame count in version 1)
+        double timestamp;           ///< Time of the sample in ms, 0 in version 1 frames
+        int16_t x;                  ///< X axis, 12-bit right-justified raw output
+        int16_t y;                  ///< Y axis, 12-bit right-justified raw output
+        int16_t z;                  ///< Z axis, 12-bit right-justified raw output
+        uint8_t odr;                ///< Index of the data rate in LIS3DH_OdrTable
+        uint8_t mms2;               ///< x, y and z are in m/s^2 x 1000 (version 1 frames)
+        uint8_t word;               ///< x, y and z are left-justified output words (raw frames)
+        uint8_t converted;          ///< ax, ay and az hold the acceleration
+        float ax;                   ///< X axis in m/s^2
+        float ay;                   ///< Y axis in m/s^2
+        float az;                   ///< Z axis in m/s^2
+    } PacketDecoder_Sample;
+
+    /**
+    *   \brief Decoder state.
+    */
+    typedef struct {
+        uint8_t frame[PACKET_RAW_LENGTH(PACKET_BATCH_MAX)];    ///< Candidate frame
+        uint16_t length;                    ///< Bytes in frame
+        uint8_t v1;                         ///< Version 1 frames expected
+        uint16_t v1_frames;                 ///< Version 1 frames received
+        uint8_t cobs;                       ///< COBS-encoded frames expected
+        uint8_t cobs_left;                  ///< Bytes left in the COBS group, 0 at a code byte
+        uint8_t cobs_code;                  ///< Code byte of the COBS group
+        uint8_t cobs_overflow;              ///< Encoded frame too long: dropped up to its delimiter
+        uint16_t cobs_bytes;                ///< Encoded bytes of the frame so far
+        uint8_t have_last;                  ///< A frame has been received
+        uint16_t last_seq;                  ///< Sequence number of the newest frame
+        uint8_t last_count;                 ///< Samples of the newest frame
+        uint32_t last_timestamp;            ///< Timestamp of the newest frame
+        double last_period;                 ///< Last sample period measured (ms)
+        PacketDecoder_Sample samples[PACKET_BATCH_MAX]; ///< Samples of the last frame
+        Packet_Profile profile;             ///< Last profile frame
+        Packet_Health health;               ///< Last health frame
+        Packet_Descriptor descriptor;       ///< Last descriptor frame
+        uint8_t have_descriptor;            ///< A descriptor frame has been received
+        float scale;                        ///< m/s^2 per digit of the descriptor
+        PacketDecoder_Stats stats;
+    } PacketDecoder;
+
+    /**
+    *   \brief Reset the decoder and its statistics.
+    */
+    void PacketDecoder_Init(PacketDecoder* decoder);
+
+    /**
+    *   \brief Reset the decoder for a stream of version 1 frames.
+    *
+    *   The profile and health frames are still decoded; the version 2 and
+    *   batch sync bytes are not looked for.
+    */
+    void PacketDecoder_InitV1(PacketDecoder* decoder);
+
+    /**
+    *   \brief Expect COBS-encoded frames delimited by 0x00.
+    *
+    *   To be called after PacketDecoder_Init or PacketDecoder_InitV1. The
+    *   bytes up to the first delimiter, and the strings the firmware
+    *   sends between the frames, are counted as skipped.
+    */
+    void PacketDecoder_UseCobs(PacketDecoder* decoder);
+
+    /**
+    *   \brief Push one received byte.
+    *
+    *   \retval Number of samples of the frame completed by the byte
+    *   (saved in decoder->samples), 0 if no valid sample frame was
+    *   completed. A profile frame is saved in decoder->profile, a health
+    *   frame in decoder->health, a descriptor frame in decoder->descriptor.
+    */
+    uint8_t PacketDecoder_Push(PacketDecoder* decoder, uint8_t byte);
+
+    /**
+    *   \brief Mean sample period in ms (0 without intervals).
+    */
+    double PacketDecoder_PeriodMean(const PacketDecoder_Stats* stats);
+
+    /**
+    *   \brief Standard deviation of the sample period in ms (RMS jitter).
+    */
+    double PacketDecoder_PeriodJitter(const PacketDecoder_Stats* stats);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,345 @@
+/*
+* MARCO MAESTRONI
+*
+* Recorder of the serial stream on Linux, in place of the Bridge Control
+* Panel for long captures: reads the bytes from the serial port (or a
+* file, or the standard input), decodes the frames as they arrive
+* (Host/PacketDecoder.h) and writes the samples to a column file
+* (Host/CaptureFile.h) and optionally to a CSV file. Once per second the
+* frames and samples per second, the frame errors and the lost samples
+* are printed on the standard error; the totals are printed on the
+* standard output at the end.
+*
+* A serial port is set to raw mode at the given baud rate. The version 1
+* frames (0xA0, X, Y, Z in m/s^2 x 1000, 0xC0) carry no timestamp: their
+* samples are timed with the clock of the PC. --cobs decodes the frames
+* of a firmware built with ACQ_FRAMING_COBS. The output words of the raw
+* frames are recorded right-justified, as the batch frames carry them,
+* with the range and sensitivity of their descriptor frame; those of the
+* version 2 and batch frames are fixed (Packet.h).
+* The recording ends at the end of the input, when the port is closed or
+* on SIGINT/SIGTERM.
+*
+* Build from this folder with:
+*   cc -I. -I.. -o PacketRecord PacketRecord.c PacketDecoder.c ConvertBatch.c CaptureFile.c \
+*      ../Packet.c ../Crc8.c -lm
+*
+* Usage:
+*   ./PacketRecord [--v1] [--cobs] [--baud=115200] [--columns=capture.cap] \
+*       [--csv=capture.csv] [--quiet] [/dev/ttyACM0 | capture.bin]
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "PacketDecoder.h"
+#include "CaptureFile.h"
+
+#define READ_LENGTH     4096
+#define POLL_MS         100
+#define REPORT_MS       1000
+
+typedef struct {
+    uint32_t baud;
+    speed_t speed;
+} Baud;
+
+static const Baud bauds[] = {
+    {9600, B9600}, {19200, B19200}, {38400, B38400}, {57600, B57600},
+    {115200, B115200}, {230400, B230400}, {460800, B460800}, {921600, B921600}
+};
+
+static volatile sig_atomic_t stop;
+
+// Full-scale range and mg/digit of a sample as recorded: right-justified
+// to 12 bits, the output words keep the high-resolution digits of their range
+static void Range(const PacketDecoder* decoder, const PacketDecoder_Sample* sample,
+                  uint8_t* g, uint8_t* mg_per_digit)
+{
+    if (sample->mms2 || (sample->word && !sample->converted))
+    {
+        *g = 0;
+        *mg_per_digit = 0;
+    }
+    else if (sample->word)
+    {
+        *g = decoder->descriptor.g;
+        *mg_per_digit = (uint8_t)((decoder->descriptor.mg_per_digit << 4) >> decoder->descriptor.shift);
+    }
+    else
+    {
+        *g = PACKET_V2_FULL_SCALE_G;
+        *mg_per_digit = PACKET_V2_MG_PER_DIGIT;
+    }
+}
+
+static void OnSignal(int signal)
+{
+    (void)signal;
+    stop = 1;
+}
+
+static double NowMs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+}
+
+// Raw mode: no echo, no line editing, no translation of the bytes
+static int SetupPort(int fd, uint32_t baud)
+{
+    struct termios tty;
+    size_t i;
+
+    for (i = 0; i < sizeof(bauds) / sizeof(bauds[0]) && bauds[i].baud != baud; i++)
+    {
+    }
+    if (i == sizeof(bauds) / sizeof(bauds[0]) || tcgetattr(fd, &tty) != 0)
+    {
+        return 0;
+    }
+    tty.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF);
+    tty.c_oflag &= ~OPOST;
+    tty.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+    tty.c_cflag &= ~(CSIZE | PARENB | CSTOPB);
+    tty.c_cflag |= CS8 | CLOCAL | CREAD;
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    cfsetispeed(&tty, bauds[i].speed);
+    cfsetospeed(&tty, bauds[i].speed);
+    return tcsetattr(fd, TCSANOW, &tty) == 0;
+}
+
+int main(int argc, char** argv)
+{
+    static PacketDecoder decoder;
+    static CaptureWriter capture;
+    static uint8_t buffer[READ_LENGTH];
+    const char* path = NULL;
+    const char* columns_path = NULL;
+    const char* csv_path = NULL;
+    FILE* csv = NULL;
+    uint32_t baud = 115200;
+    uint8_t v1 = 0;
+    uint8_t cobs = 0;
+    uint8_t quiet = 0;
+    uint8_t write_errors = 0;
+    int fd = STDIN_FILENO;
+    double start;
+    double last_report;
+    uint32_t last_frames = 0;
+    uint32_t last_samples = 0;
+    struct sigaction action;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--v1") == 0)
+        {
+            v1 = 1;
+        }
+        else if (strcmp(argv[i], "--cobs") == 0)
+        {
+            cobs = 1;
+        }
+        else if (strcmp(argv[i], "--quiet") == 0)
+        {
+            quiet = 1;
+        }
+        else if (strncmp(argv[i], "--baud=", 7) == 0)
+        {
+            baud = (uint32_t)strtoul(argv[i] + 7, NULL, 10);
+        }
+        else if (strncmp(argv[i], "--columns=", 10) == 0)
+        {
+            columns_path = argv[i] + 10;
+        }
+        else if (strncmp(argv[i], "--csv=", 6) == 0)
+        {
+            csv_path = argv[i] + 6;
+        }
+        else if (argv[i][0] != '-' && path == NULL)
+        {
+            path = argv[i];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--v1] [--cobs] [--baud=115200] [--columns=capture.cap] "
+                    "[--csv=capture.csv] [--quiet] [port | file]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (path != NULL)
+    {
+        fd = open(path, O_RDONLY | O_NOCTTY);
+        if (fd < 0)
+        {
+            perror(path);
+            return 1;
+        }
+    }
+    if (isatty(fd) && !SetupPort(fd, baud))
+    {
+        fprintf(stderr, "cannot set %s to raw mode at %u baud\n",
+                path != NULL ? path : "the input", (unsigned)baud);
+        return 1;
+    }
+    if (columns_path != NULL && CaptureWriter_Open(&capture, columns_path) != NO_ERROR)
+    {
+        perror(columns_path);
+        return 1;
+    }
+    if (csv_path != NULL)
+    {
+        csv = fopen(csv_path, "w");
+        if (csv == NULL)
+        {
+            perror(csv_path);
+            return 1;
+        }
+        fprintf(csv, "timestamp_ms,seq,odr,x,y,z\n");
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = OnSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    if (v1)
+    {
+        PacketDecoder_InitV1(&decoder);
+    }
+    else
+    {
+        PacketDecoder_Init(&decoder);
+    }
+    if (cobs)
+    {
+        PacketDecoder_UseCobs(&decoder);
+    }
+    start = NowMs();
+    last_report = start;
+
+    while (!stop)
+    {
+        struct pollfd ready = {fd, POLLIN, 0};
+        ssize_t length = 0;
+        ssize_t b;
+        double now;
+
+        if (poll(&ready, 1, POLL_MS) > 0)
+        {
+            length = read(fd, buffer, sizeof(buffer));
+            // A closed port reads 0 bytes or fails with EIO
+            if (length == 0 || (length < 0 && errno != EINTR && errno != EAGAIN))
+            {
+                break;
+            }
+        }
+        now = NowMs();
+
+        for (b = 0; b < length; b++)
+        {
+            uint8_t count = PacketDecoder_Push(&decoder, buffer[b]);
+            uint8_t s;
+
+            for (s = 0; s < count; s++)
+            {
+                PacketDecoder_Sample* sample = &decoder.samples[s];
+                uint8_t g;
+                uint8_t mg_per_digit;
+
+                if (sample->mms2)
+                {
+                    sample->timestamp = now - start;
+                }
+                Range(&decoder, sample, &g, &mg_per_digit);
+                if (sample->word)
+                {
+                    // Recorded as the batch frames carry them
+                    sample->x >>= 4;
+                    sample->y >>= 4;
+                    sample->z >>= 4;
+                }
+                if (columns_path != NULL &&
+                    CaptureWriter_Add(&capture, sample->timestamp, sample->x, sample->y, sample->z,
+                                      sample->odr, sample->mms2 ? CAPTURE_UNIT_MMS2 : CAPTURE_UNIT_RAW,
+                                      g, mg_per_digit) != NO_ERROR)
+                {
+                    write_errors = 1;
+                }
+                if (csv != NULL)
+                {
+                    fprintf(csv, "%.3f,%u,%u,%d,%d,%d\n", sample->timestamp, (unsigned)sample->seq,
+                            (unsigned)sample->odr, sample->x, sample->y, sample->z);
+                }
+            }
+        }
+
+        if (now - last_report >= REPORT_MS)
+        {
+            const PacketDecoder_Stats* stats = &decoder.stats;
+            double seconds = (now - last_report) / 1000;
+
+            if (!quiet)
+            {
+                fprintf(stderr, "%8.1f s %8.1f frames/s %8.1f samples/s, frame errors %u, lost %u\n",
+                        (now - start) / 1000, (stats->frames - last_frames) / seconds,
+                        (stats->samples - last_samples) / seconds,
+                        (unsigned)stats->crc_errors, (unsigned)stats->lost);
+            }
+            last_frames = stats->frames;
+            last_samples = stats->samples;
+            last_report = now;
+            // The column file can be read while recording
+            if (columns_path != NULL && CaptureWriter_Flush(&capture) != NO_ERROR)
+            {
+                write_errors = 1;
+            }
+        }
+    }
+
+    if (columns_path != NULL && CaptureWriter_Close(&capture) != NO_ERROR)
+    {
+        write_errors = 1;
+    }
+    if (csv != NULL && fclose(csv) != 0)
+    {
+        write_errors = 1;
+    }
+
+    const PacketDecoder_Stats* stats = &decoder.stats;
+    double seconds = (NowMs() - start) / 1000;
+    printf("time         %.1f s\n", seconds);
+    printf("frames       %u (%u samples), %.1f frames/s\n",
+           (unsigned)stats->frames, (unsigned)stats->samples, seconds > 0 ? stats->frames / seconds : 0);
+    printf("lost         %u\n", (unsigned)stats->lost);
+    printf("frame errors %u (%u bytes skipped)\n",
+           (unsigned)stats->crc_errors, (unsigned)stats->skipped_bytes);
+    if (columns_path != NULL)
+    {
+        printf("columns      %u samples in %u chunks, the last one at +-%u g, %u mg/digit\n",
+               (unsigned)capture.samples, (unsigned)capture.chunks,
+               (unsigned)capture.g, (unsigned)capture.mg_per_digit);
+    }
+    if (write_errors)
+    {
+        fprintf(stderr, "error writing the output files\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,363 @@
+/*
+* MARCO MAESTRONI
+*
+* Host check of the version 2 frames: a 200 Hz stream is built with
+* Packet_BuildV2, then frames are dropped, swapped, duplicated and
+* corrupted on the way to the decoder, which must account for every one
+* of them. Profile and health frames are sent in the stream every
+* PROFILE_EVERY frames: the decoder must keep them apart from the samples.
+* A stream of version 1 frames, with one byte dropped every V1_DROP_EVERY
+* frames, must be resynchronised on the header and footer. A health frame
+* of an unknown layout version must be rejected. Raw frames must be
+* converted with the descriptor frame of their data rate.
+*
+* Build from this folder with:
+*   cc -I. -I.. -o PacketReport PacketReport.c PacketDecoder.c ConvertBatch.c ../Packet.c \
+*      ../Crc8.c ../LIS3DH_Convert.c -lm
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "PacketDecoder.h"
+#include "Crc8.h"
+
+#define FRAMES    20000
+#define PERIOD_MS 5
+
+#define PROFILE_EVERY 1000
+
+#define V1_FRAMES     2000
+#define V1_DROP_EVERY 50
+
+static int failures;
+
+static void Check(const char* name, uint32_t value, uint32_t expected)
+{
+    printf("%-12s %6u (expected %6u) %s\n", name, (unsigned)value, (unsigned)expected,
+           value == expected ? "ok" : "FAILED");
+    failures += value != expected;
+}
+
+// A corrupted frame is rejected at least once, more if a sync byte
+// found in its payload starts another candidate
+static void CheckAtLeast(const char* name, uint32_t value, uint32_t expected)
+{
+    printf("%-12s %6u (expected >= %3u) %s\n", name, (unsigned)value, (unsigned)expected,
+           value >= expected ? "ok" : "FAILED");
+    failures += value < expected;
+}
+
+static void SendBytes(PacketDecoder* decoder, const uint8_t* frame, uint16_t length)
+{
+    uint16_t i;
+    for (i = 0; i < length; i++)
+    {
+        PacketDecoder_Push(decoder, frame[i]);
+    }
+}
+
+static void Send(PacketDecoder* decoder, const uint8_t* frame, uint8_t corrupt)
+{
+    uint8_t i;
+    for (i = 0; i < PACKET_V2_LENGTH; i++)
+    {
+        uint8_t byte = frame[i];
+        if (corrupt && i == 7)
+        {
+            byte ^= 0x10;
+        }
+        PacketDecoder_Push(decoder, byte);
+    }
+}
+
+int main(void)
+{
+    static uint8_t frames[FRAMES][PACKET_V2_LENGTH];
+    static PacketDecoder decoder;
+    static uint8_t profile_frame[PACKET_PROFILE_LENGTH(PACKET_PROFILE_MAX_STAGES)];
+    Packet_V2 packet;
+    Packet_V2 parsed;
+    Packet_Profile profile;
+    Packet_Profile profile_parsed;
+    uint16_t profile_length;
+    uint32_t profiles = 0;
+    uint8_t health_frame[PACKET_HEALTH_LENGTH];
+    Packet_Health health;
+    Packet_Health health_parsed;
+    uint32_t lost = 0;
+    uint32_t reordered = 0;
+    uint32_t duplicated = 0;
+    uint32_t corrupted = 0;
+    uint32_t mismatches = 0;
+    uint32_t i;
+
+    // Every 12-bit value of the three axes survives the packing
+    for (i = 0; i < 4096; i++)
+    {
+        packet.seq = (uint8_t)i;
+        packet.timestamp = i * 0x01020304u;
+        packet.x = (int16_t)i - 2048;
+        packet.y = 2047 - (int16_t)i;
+        packet.z = (int16_t)((i * 7) % 4096) - 2048;
+        packet.odr = i % 10;
+        Packet_BuildV2(&packet, frames[0]);
+        if (Packet_ParseV2(frames[0], &parsed) != NO_ERROR ||
+            parsed.x != packet.x || parsed.y != packet.y || parsed.z != packet.z ||
+            parsed.seq != packet.seq || parsed.timestamp != packet.timestamp ||
+            parsed.odr != packet.odr)
+        {
+            mismatches++;
+        }
+    }
+    Check("mismatches", mismatches, 0);
+
+    // Every field of a profile frame of every size survives the packing
+    mismatches = 0;
+    for (i = 1; i <= PACKET_PROFILE_MAX_STAGES; i++)
+    {
+        uint8_t stage;
+
+        profile.count = (uint8_t)i;
+        profile.cycles_per_ms = 64000;
+        for (stage = 0; stage < i; stage++)
+        {
+            profile.stages[stage].calls = 1000u * i + stage;
+            profile.stages[stage].min = 0x01020304u * stage;
+            profile.stages[stage].avg = 0x10203040u + stage;
+            profile.stages[stage].max = 0xFFFFFFF0u + stage;
+        }
+        profile_length = Packet_BuildProfile(&profile, profile_frame);
+        if (profile_length != PACKET_PROFILE_LENGTH(i) ||
+            Packet_ParseProfile(profile_frame, profile_length, &profile_parsed) != NO_ERROR ||
+            profile_parsed.count != profile.count ||
+            profile_parsed.cycles_per_ms != profile.cycles_per_ms)
+        {
+            mismatches++;
+            continue;
+        }
+        for (stage = 0; stage < i; stage++)
+        {
+            const Packet_ProfileStage* a = &profile.stages[stage];
+            const Packet_ProfileStage* b = &profile_parsed.stages[stage];
+            mismatches += a->calls != b->calls || a->min != b->min ||
+                          a->avg != b->avg || a->max != b->max;
+        }
+    }
+    Check("profile", mismatches, 0);
+
+    health.timestamp = 0x89ABCDEFu;
+    health.odr = 9;
+    health.samples = 0x01020304u;
+    health.stale = 0xFFFFFFFFu;
+    health.overrun_x = 1;
+    health.overrun_y = 0x100;
+    health.overrun_z = 0x10000;
+    health.overruns = 0x1000000;
+    health.fifo_overruns = 0x7F7F7F7Fu;
+    health.read_errors = 0x00000080u;
+    health.wakeups = 0x00C0FFEEu;
+    health.sleep_ms = 0x80000000u;
+    health.button_drops = 0x0000FF00u;
+    Packet_BuildHealth(&health, health_frame);
+    mismatches = Packet_ParseHealth(health_frame, &health_parsed) != NO_ERROR ||
+                 health_parsed.timestamp != health.timestamp || health_parsed.odr != health.odr ||
+                 health_parsed.samples != health.samples || health_parsed.stale != health.stale ||
+                 health_parsed.overrun_x != health.overrun_x ||
+                 health_parsed.overrun_y != health.overrun_y ||
+                 health_parsed.overrun_z != health.overrun_z ||
+                 health_parsed.overruns != health.overruns ||
+                 health_parsed.fifo_overruns != health.fifo_overruns ||
+                 health_parsed.read_errors != health.read_errors ||
+                 health_parsed.wakeups != health.wakeups ||
+                 health_parsed.sleep_ms != health.sleep_ms ||
+                 health_parsed.button_drops != health.button_drops;
+    Check("health", mismatches, 0);
+
+    // A health frame of another layout is not decoded, even with a valid
+    // CRC; the next one of this layout is
+    {
+        static PacketDecoder health_decoder;
+        uint8_t other[PACKET_HEALTH_LENGTH];
+
+        memcpy(other, health_frame, PACKET_HEALTH_LENGTH);
+        other[1] = PACKET_HEALTH_VERSION + 1;
+        other[PACKET_HEALTH_LENGTH - 1] = Crc8_Update(CRC8_INIT, other, PACKET_HEALTH_LENGTH - 1);
+        PacketDecoder_Init(&health_decoder);
+        SendBytes(&health_decoder, other, PACKET_HEALTH_LENGTH);
+        Check("other health", health_decoder.stats.healths, 0);
+        SendBytes(&health_decoder, health_frame, PACKET_HEALTH_LENGTH);
+        Check("next health", health_decoder.stats.healths, 1);
+    }
+
+    // Raw frames: the words are received as sent, and converted only
+    // once the descriptor of their data rate has been received
+    {
+        static PacketDecoder raw_decoder;
+        uint8_t raw_frame[PACKET_RAW_LENGTH(PACKET_BATCH_MAX)];
+        uint8_t descriptor_frame[PACKET_DESCRIPTOR_LENGTH];
+        Packet_Descriptor descriptor;
+        Packet_Descriptor descriptor_parsed;
+        const LIS3DH_Sensitivity* sensitivity = &LIS3DH_SensitivityTable[1][LIS3DH_MODE_NORMAL];
+        float expected[3 * PACKET_BATCH_MAX];
+        int16_t words[3 * PACKET_BATCH_MAX];
+        uint16_t raw_length;
+        uint8_t samples;
+        uint8_t s;
+
+        descriptor.odr = 5;
+        descriptor.fs = 1;
+        descriptor.g = 4;
+        descriptor.mode = LIS3DH_MODE_NORMAL;
+        descriptor.shift = sensitivity->shift;
+        descriptor.mg_per_digit = sensitivity->mg_per_digit;
+        descriptor.mms2_q = sensitivity->mms2_q;
+        Packet_BuildDescriptor(&descriptor, descriptor_frame);
+        mismatches = Packet_ParseDescriptor(descriptor_frame, &descriptor_parsed) != NO_ERROR ||
+                     descriptor_parsed.odr != descriptor.odr || descriptor_parsed.fs != descriptor.fs ||
+                     descriptor_parsed.g != descriptor.g || descriptor_parsed.mode != descriptor.mode ||
+                     descriptor_parsed.shift != descriptor.shift ||
+                     descriptor_parsed.mg_per_digit != descriptor.mg_per_digit ||
+                     descriptor_parsed.mms2_q != descriptor.mms2_q;
+
+        for (i = 0; i < 3 * PACKET_BATCH_MAX; i++)
+        {
+            words[i] = (int16_t)(i * 2731 + INT16_MIN);
+        }
+        ConvertBatch_Kernels[0].kernel(words, expected, 3 * PACKET_BATCH_MAX, descriptor.shift,
+                                       ConvertBatch_Scale(sensitivity));
+
+        // The same words twice, before and after the descriptor
+        PacketDecoder_Init(&raw_decoder);
+        Packet_RawStart(raw_frame, 0, 1000, descriptor.odr);
+        for (i = 0; i < PACKET_BATCH_MAX; i++)
+        {
+            Packet_RawAdd(raw_frame, words[3 * i], words[3 * i + 1], words[3 * i + 2]);
+        }
+        raw_length = Packet_RawFinish(raw_frame);
+        SendBytes(&raw_decoder, raw_frame, raw_length);
+        SendBytes(&raw_decoder, descriptor_frame, PACKET_DESCRIPTOR_LENGTH);
+        Packet_RawStart(raw_frame, PACKET_BATCH_MAX, 1000 + PACKET_BATCH_MAX * PERIOD_MS, descriptor.odr);
+        for (i = 0; i < PACKET_BATCH_MAX; i++)
+        {
+            Packet_RawAdd(raw_frame, words[3 * i], words[3 * i + 1], words[3 * i + 2]);
+        }
+        raw_length = Packet_RawFinish(raw_frame);
+        samples = 0;
+        for (i = 0; i < raw_length; i++)
+        {
+            samples += PacketDecoder_Push(&raw_decoder, raw_frame[i]);
+        }
+        mismatches += samples != PACKET_BATCH_MAX;
+        for (s = 0; s < samples && s < PACKET_BATCH_MAX; s++)
+        {
+            const PacketDecoder_Sample* sample = &raw_decoder.samples[s];
+            mismatches += !sample->word || !sample->converted ||
+                          sample->x != words[3 * s] || sample->y != words[3 * s + 1] ||
+                          sample->z != words[3 * s + 2] || sample->ax != expected[3 * s] ||
+                          sample->ay != expected[3 * s + 1] || sample->az != expected[3 * s + 2];
+        }
+        Check("raw", mismatches, 0);
+        Check("unconverted", raw_decoder.stats.unconverted, PACKET_BATCH_MAX);
+        Check("descriptors", raw_decoder.stats.descriptors, 1);
+    }
+
+    // Stream with +-1 ms of jitter on the timestamps
+    srand(1);
+    for (i = 0; i < FRAMES; i++)
+    {
+        packet.seq = (uint8_t)i;
+        packet.timestamp = i * PERIOD_MS + (i % 2);
+        packet.x = packet.y = packet.z = (int16_t)(i & 0x7FF);
+        packet.odr = 5;
+        Packet_BuildV2(&packet, frames[i]);
+    }
+
+    PacketDecoder_Init(&decoder);
+    for (i = 0; i < FRAMES; i++)
+    {
+        int event = rand() % 200;
+        if (i % PROFILE_EVERY == PROFILE_EVERY / 2)
+        {
+            SendBytes(&decoder, profile_frame, profile_length);
+            SendBytes(&decoder, health_frame, PACKET_HEALTH_LENGTH);
+            profiles++;
+        }
+        if (i == 0 || i >= FRAMES - 2 || event > 3)
+        {
+            Send(&decoder, frames[i], 0);
+        }
+        else if (event == 0)
+        {
+            lost++;
+        }
+        else if (event == 1)
+        {
+            Send(&decoder, frames[i + 1], 0);
+            Send(&decoder, frames[i], 0);
+            reordered++;
+            i++;
+        }
+        else if (event == 2)
+        {
+            Send(&decoder, frames[i], 0);
+            Send(&decoder, frames[i], 0);
+            duplicated++;
+        }
+        else
+        {
+            // Lost to the CRC
+            Send(&decoder, frames[i], 1);
+            corrupted++;
+            lost++;
+        }
+    }
+
+    const PacketDecoder_Stats* stats = &decoder.stats;
+    Check("lost", stats->lost, lost);
+    Check("reordered", stats->reordered, reordered);
+    Check("duplicated", stats->duplicated, duplicated);
+    Check("profiles", stats->profiles, profiles);
+    Check("healths", stats->healths, profiles);
+    CheckAtLeast("crc errors", stats->crc_errors, corrupted);
+    printf("period %.3f ms mean, %.3f ms jitter rms (%d ms nominal)\n",
+           PacketDecoder_PeriodMean(stats), PacketDecoder_PeriodJitter(stats), PERIOD_MS);
+
+    // Version 1 stream: X counts the frames, Y is its complement and Z
+    // holds the header and footer values; a frame with a dropped byte is
+    // lost, and so may be the next one, whose first byte completes the
+    // damaged candidate
+    uint32_t v1_decoded = 0;
+    uint32_t v1_damaged = 0;
+    mismatches = 0;
+    PacketDecoder_InitV1(&decoder);
+    for (i = 0; i < V1_FRAMES; i++)
+    {
+        uint8_t v1_frame[PACKET_V1_LENGTH] = {PACKET_V1_HEADER, (uint8_t)i, (uint8_t)(i >> 8),
+                                              (uint8_t)~i, (uint8_t)(~i >> 8), 0xA0, 0xC0,
+                                              PACKET_V1_FOOTER};
+        uint8_t b;
+
+        for (b = 0; b < PACKET_V1_LENGTH; b++)
+        {
+            if (i % V1_DROP_EVERY == V1_DROP_EVERY - 1 && b == 3)
+            {
+                continue;
+            }
+            if (PacketDecoder_Push(&decoder, v1_frame[b]))
+            {
+                v1_decoded++;
+                const PacketDecoder_Sample* sample = &decoder.samples[0];
+                mismatches += sample->y != (int16_t)~sample->x || sample->z != (int16_t)0xC0A0 ||
+                              !sample->mms2;
+            }
+        }
+        v1_damaged += i % V1_DROP_EVERY == V1_DROP_EVERY - 1;
+    }
+    Check("v1 garbled", mismatches, 0);
+    CheckAtLeast("v1 decoded", v1_decoded, V1_FRAMES - 2 * v1_damaged);
+
+    return failures ? 1 : 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,144 @@
+/*
+* MARCO MAESTRONI
+*
+* Test bench of the serial tools: runs a producer with its standard output
+* on the master side of a pseudo-terminal, and a consumer given the path
+* of the slave side, which it opens as it would open a serial port. Once
+* the producer has exited and the consumer has read everything, the
+* master side is closed: the consumer sees the port closed.
+*
+* The slave side is set to raw mode before the producer starts, so that
+* no byte is translated before the consumer sets the port up. The exit
+* status is the one of the consumer, 1 if the producer failed.
+*
+* Build from this folder with:
+*   cc -o PtyPipe PtyPipe.c
+*
+* Usage ({} is replaced by the path of the slave side):
+*   ./PtyPipe env HAL_RUN_MS=2000 ./acquisition -- ./PacketRecord {}
+*/
+
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+// Time given to the consumer to read the last bytes
+#define DRAIN_TIMEOUT_MS 5000
+#define DRAIN_POLL_MS    10
+
+static void Sleep(long ms)
+{
+    struct timespec delay = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&delay, NULL);
+}
+
+static pid_t Start(char** argv, int output)
+{
+    pid_t pid = fork();
+
+    if (pid == 0)
+    {
+        if (output >= 0)
+        {
+            dup2(output, STDOUT_FILENO);
+        }
+        execvp(argv[0], argv);
+        perror(argv[0]);
+        _exit(127);
+    }
+    return pid;
+}
+
+int main(int argc, char** argv)
+{
+    struct termios tty;
+    const char* slave_path;
+    int master;
+    int slave;
+    int separator;
+    int status;
+    int waited;
+    int queued;
+    pid_t producer;
+    pid_t consumer;
+    int i;
+
+    for (separator = 1; separator < argc && strcmp(argv[separator], "--") != 0; separator++)
+    {
+    }
+    if (separator == 1 || separator >= argc - 1)
+    {
+        fprintf(stderr, "usage: %s producer ... -- consumer ... {} ...\n", argv[0]);
+        return 2;
+    }
+    argv[separator] = NULL;
+
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        perror("pseudo-terminal");
+        return 1;
+    }
+    slave_path = ptsname(master);
+    // Kept open, so that the slave side stays configured between the opens.
+    // Neither side is inherited: the master side must be closed here only
+    fcntl(master, F_SETFD, FD_CLOEXEC);
+    slave = open(slave_path, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (slave < 0 || tcgetattr(slave, &tty) != 0)
+    {
+        perror(slave_path);
+        return 1;
+    }
+    cfmakeraw(&tty);
+    tcsetattr(slave, TCSANOW, &tty);
+
+    for (i = separator + 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "{}") == 0)
+        {
+            argv[i] = (char*)slave_path;
+        }
+    }
+    consumer = Start(&argv[separator + 1], -1);
+    producer = Start(&argv[1], master);
+    if (consumer < 0 || producer < 0)
+    {
+        perror("fork");
+        return 1;
+    }
+
+    waitpid(producer, &status, 0);
+    // Wait for the consumer to read what is left in the slave input queue
+    for (waited = 0; waited < DRAIN_TIMEOUT_MS; waited += DRAIN_POLL_MS)
+    {
+        if (ioctl(slave, FIONREAD, &queued) != 0 || queued == 0)
+        {
+            break;
+        }
+        Sleep(DRAIN_POLL_MS);
+    }
+    close(master);
+    close(slave);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        fprintf(stderr, "producer failed\n");
+        kill(consumer, SIGTERM);
+        waitpid(consumer, NULL, 0);
+        return 1;
+    }
+    waitpid(consumer, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+
+/* [] END OF FILE */
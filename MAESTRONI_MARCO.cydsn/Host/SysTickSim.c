@@ -0,0 +1,287 @@
+/*
+* MARCO MAESTRONI
+*
+* Host model of the SysTick timer and of the cy_boot calls of Hal.c
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "SysTickSim.h"
+#include "project.h"
+
+// Core registers read by Hal.c
+#define SYSTICK_SIM_ICSR            0xE000ED04u
+#define SYSTICK_SIM_ICSR_PENDSTSET  0x04000000u
+#define SYSTICK_SIM_SYST_CSR        0xE000E010u
+#define SYSTICK_SIM_CSR_ENABLE      0x00000001u
+#define SYSTICK_SIM_CSR_TICKINT     0x00000002u
+#define SYSTICK_SIM_CSR_CLKSOURCE   0x00000004u
+#define SYSTICK_SIM_CSR_COUNTFLAG   0x00010000u
+
+#define SYSTICK_SIM_RELOAD_MASK     0x00FFFFFFu
+
+static uint64_t now;
+static uint64_t wake_at;
+static uint8_t enabled;
+static uint8_t count_flag;
+static uint8_t pending;
+static uint32_t reload;
+static uint32_t current;
+// Value loaded by the next clock when the counter is at 0
+static uint32_t next_load;
+static cySysTickCallback callback;
+
+// Clock cycles up to the next time the counter reaches 0
+static uint64_t ToZero(void)
+{
+    if (!enabled)
+    {
+        return UINT64_MAX;
+    }
+    if (current > 0)
+    {
+        return current;
+    }
+    // At 0 the next clock loads the reload value
+    if (next_load > 0)
+    {
+        return (uint64_t)next_load + 1;
+    }
+    // A reload value of 0 keeps the counter at 0 without reaching it again:
+    // the clock after the one loading 0 loads the reload value set since
+    return reload > 0 ? (uint64_t)reload + 2 : UINT64_MAX;
+}
+
+// Move on by cycles, at most up to the next time the counter reaches 0
+static void Advance(uint64_t cycles)
+{
+    now += cycles;
+    if (!enabled || cycles == 0)
+    {
+        return;
+    }
+    if (current == 0 && next_load == 0)
+    {
+        // One clock loads 0, with no COUNTFLAG
+        next_load = reload;
+        cycles--;
+        if (cycles == 0 || next_load == 0)
+        {
+            return;
+        }
+    }
+    if (current > 0)
+    {
+        current -= (uint32_t)cycles;
+    }
+    else
+    {
+        current = next_load - (uint32_t)(cycles - 1);
+    }
+    if (current == 0)
+    {
+        count_flag = 1;
+        pending = 1;
+        next_load = reload;
+    }
+}
+
+static void Serve(void)
+{
+    if (pending)
+    {
+        pending = 0;
+        if (callback != NULL)
+        {
+            callback();
+        }
+    }
+}
+
+void SysTickSim_Reset(void)
+{
+    now = 0;
+    wake_at = 0;
+    enabled = 0;
+    count_flag = 0;
+    pending = 0;
+    reload = 0;
+    current = 0;
+    next_load = 0;
+    callback = NULL;
+}
+
+void SysTickSim_Run(uint64_t cycles)
+{
+    const uint64_t end = now + cycles;
+
+    Serve();
+    while (now < end)
+    {
+        uint64_t step = ToZero();
+
+        Advance(step < end - now ? step : end - now);
+        Serve();
+    }
+}
+
+void SysTickSim_WakeAt(uint64_t cycle)
+{
+    wake_at = cycle;
+}
+
+uint64_t SysTickSim_Now(void)
+{
+    return now;
+}
+
+uint32 SysTickSim_ReadRegister(uint32 address)
+{
+    uint32 value = 0;
+
+    if (address == SYSTICK_SIM_ICSR)
+    {
+        value = pending ? SYSTICK_SIM_ICSR_PENDSTSET : 0;
+    }
+    else if (address == SYSTICK_SIM_SYST_CSR)
+    {
+        value = SYSTICK_SIM_CSR_TICKINT | SYSTICK_SIM_CSR_CLKSOURCE;
+        value |= enabled ? SYSTICK_SIM_CSR_ENABLE : 0;
+        value |= count_flag ? SYSTICK_SIM_CSR_COUNTFLAG : 0;
+        // Cleared by the read
+        count_flag = 0;
+    }
+    return value;
+}
+
+void SysTickSim_WriteRegister(uint32 address, uint32 value)
+{
+    // The DWT cycle counter is not modelled
+    (void)address;
+    (void)value;
+}
+
+void SysTickSim_WaitForInterrupt(void)
+{
+    while (!pending && (wake_at == 0 || now < wake_at))
+    {
+        uint64_t step = ToZero();
+
+        if (wake_at != 0 && wake_at - now < step)
+        {
+            step = wake_at - now;
+        }
+        if (step == UINT64_MAX)
+        {
+            printf("SysTickSim: the core sleeps with nothing to wake it up\n");
+            exit(1);
+        }
+        Advance(step);
+    }
+    if (!pending)
+    {
+        wake_at = 0;
+    }
+}
+
+uint8 CyEnterCriticalSection(void)
+{
+    return 0;
+}
+
+void CyExitCriticalSection(uint8 savedIntrStatus)
+{
+    (void)savedIntrStatus;
+}
+
+void CySysTickStart(void)
+{
+    // As cy_boot: a 1 ms period on the CPU clock
+    reload = SYSTICK_SIM_CLOCK_HZ / 1000 - 1;
+    current = 0;
+    CySysTickEnable();
+}
+
+void CySysTickEnable(void)
+{
+    (void)SysTickSim_ReadRegister(SYSTICK_SIM_SYST_CSR);
+    enabled = 1;
+    // The next clock comes before the next instruction: it loads the
+    // reload value set at this time
+    next_load = reload;
+}
+
+void CySysTickStop(void)
+{
+    (void)SysTickSim_ReadRegister(SYSTICK_SIM_SYST_CSR);
+    enabled = 0;
+}
+
+void CySysTickSetReload(uint32 value)
+{
+    reload = value & SYSTICK_SIM_RELOAD_MASK;
+}
+
+uint32 CySysTickGetReload(void)
+{
+    return reload;
+}
+
+uint32 CySysTickGetValue(void)
+{
+    return current;
+}
+
+uint32 CySysTickGetCountFlag(void)
+{
+    return (SysTickSim_ReadRegister(SYSTICK_SIM_SYST_CSR) & SYSTICK_SIM_CSR_COUNTFLAG) != 0;
+}
+
+void CySysTickClear(void)
+{
+    // A write of SYST_CVR clears it and COUNTFLAG
+    current = 0;
+    count_flag = 0;
+}
+
+cySysTickCallback CySysTickSetCallback(uint32 number, cySysTickCallback function)
+{
+    cySysTickCallback previous = callback;
+
+    (void)number;
+    callback = function;
+    return previous;
+}
+
+void isr_Button_StartEx(cySysTickCallback address)
+{
+    (void)address;
+}
+
+void isr_DataReady_StartEx(cySysTickCallback address)
+{
+    (void)address;
+}
+
+uint8 Push_Button_Read(void)
+{
+    // Released: the pull-up holds the pin high
+    return 1;
+}
+
+void UART_Debug_Start(void)
+{
+}
+
+void UART_Debug_PutString(const char* string)
+{
+    (void)string;
+}
+
+void UART_Debug_PutArray(const uint8* string, uint8 byteCount)
+{
+    (void)string;
+    (void)byteCount;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,59 @@
+/**
+*   \file SysTickSim.h
+*   \brief Host model of the SysTick timer of the Cortex-M3, for Hal.c.
+*
+*   The counter is modelled clock by clock as in the ARMv7-M reference:
+*   enabled with a current value of 0 it loads the reload value at the
+*   next clock, which comes before the next instruction, then counts
+*   down; on reaching 0 it sets COUNTFLAG and makes the SysTick interrupt
+*   pending (PENDSTSET). A reload value of 0 is loaded without reaching 0
+*   again: the counter stays at 0 until the reload value is changed, and
+*   the clock after loads the new one. Any read of SYST_CSR
+*   clears COUNTFLAG, the read-modify-write of CySysTickStop and
+*   CySysTickEnable included, and so does a write of SYST_CVR
+*   (CySysTickClear).
+*
+*   The firmware code takes no time: the clock only moves on in
+*   SysTickSim_Run, with the interrupts enabled, and in CY_PM_WFI, up to
+*   the next SysTick interrupt or the interrupt set with SysTickSim_WakeAt.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __SYSTICKSIM_H
+    #define __SYSTICKSIM_H
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief CPU clock of the PSoC 5LP project, in Hz.
+    */
+    #define SYSTICK_SIM_CLOCK_HZ 24000000u
+
+    /**
+    *   \brief Stop the counter and set the time back to 0.
+    */
+    void SysTickSim_Reset(void);
+
+    /**
+    *   \brief Run the code for cycles clock cycles with the interrupts
+    *   enabled.
+    *
+    *   The pending SysTick interrupt is served first, then every one
+    *   raised in the meantime, calling the callback of CySysTickSetCallback.
+    */
+    void SysTickSim_Run(uint64_t cycles);
+
+    /**
+    *   \brief Raise another interrupt at the given time, waking up the
+    *   core if it sleeps; 0 for none. Cleared once it has woken it up.
+    */
+    void SysTickSim_WakeAt(uint64_t cycle);
+
+    /**
+    *   \brief Clock cycles since SysTickSim_Reset.
+    */
+    uint64_t SysTickSim_Now(void);
+
+#endif
+/* [] END OF FILE */
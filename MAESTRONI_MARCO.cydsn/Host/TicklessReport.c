@@ -0,0 +1,123 @@
+/*
+* MARCO MAESTRONI
+*
+* Host check of the tickless sleep of Hal.c on the SysTick model
+* (Host/SysTickSim.h), where COUNTFLAG is cleared by every read of
+* SYST_CSR as on the Cortex-M3. The time base must follow the ticks the
+* counter would have raised:
+* - over sleeps that end on the long SysTick period, at the longest one
+*   the 24-bit counter allows (699 ms at 24 MHz, below
+*   ACQ_LOW_POWER_MAX_SLEEP_MS), as at 1 Hz or with the button only;
+* - over sleeps that another interrupt ends at any cycle of a tick, and
+*   in the last cycles of one, where the rest of the tick period is as
+*   short as 1 cycle.
+* The cycles returned as asleep must be the ones the core slept for.
+*
+* Build from this folder with:
+*   cc -I. -I.. -ICyBoot -o TicklessReport TicklessReport.c SysTickSim.c ../Hal.c \
+*      ../Timebase.c
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "SysTickSim.h"
+#include "project.h"
+#include "Timebase.h"
+
+#define SLEEPS       200
+#define MAX_SLEEP_MS 1000
+// Code run between two sleeps, in cycles
+#define AWAKE_CYCLES 3000
+
+#define PERIOD_CYCLES (SYSTICK_SIM_CLOCK_HZ / 1000)
+
+static int failures;
+
+static void Check(const char* name, int64_t value, int64_t limit)
+{
+    printf("%-22s %8lld (at most %lld) %s\n", name, (long long)value, (long long)limit,
+           value <= limit ? "ok" : "FAILED");
+    failures += value > limit;
+}
+
+static int64_t Drift(void)
+{
+    int64_t drift = (int64_t)Timebase_GetMs() - (int64_t)(SysTickSim_Now() / PERIOD_CYCLES);
+    return drift < 0 ? -drift : drift;
+}
+
+// Sleeps woken by another interrupt after at most wake_max cycles, or
+// only by the SysTick if 0; with boundary set, with 1 to 4 cycles of the
+// tick period left. The largest drift of the time base in ms and
+// of the cycles asleep are returned
+static void Sleeps(uint32_t wake_max, uint8_t boundary,
+                   int64_t* drift_max, int64_t* cycles_max, uint64_t* slept)
+{
+    uint32_t i;
+
+    *drift_max = 0;
+    *cycles_max = 0;
+    *slept = 0;
+    for (i = 0; i < SLEEPS; i++)
+    {
+        uint64_t asleep;
+        int64_t error;
+        uint32_t cycles;
+
+        SysTickSim_Run(AWAKE_CYCLES + i * 37);
+        asleep = SysTickSim_Now();
+        if (boundary)
+        {
+            SysTickSim_WakeAt(asleep + CySysTickGetValue() +
+                              (1 + (uint32_t)rand() % (wake_max / PERIOD_CYCLES)) * PERIOD_CYCLES + 1 - i % 4);
+        }
+        else
+        {
+            SysTickSim_WakeAt(wake_max ? asleep + 1 + (uint32_t)rand() % wake_max : 0);
+        }
+        cycles = Timebase_Sleep(MAX_SLEEP_MS);
+        *slept += SysTickSim_Now() - asleep;
+        error = (int64_t)cycles - (int64_t)(SysTickSim_Now() - asleep);
+        error = error < 0 ? -error : error;
+        *cycles_max = error > *cycles_max ? error : *cycles_max;
+
+        // The interrupts enabled again: the pending tick is counted
+        SysTickSim_Run(0);
+        *drift_max = Drift() > *drift_max ? Drift() : *drift_max;
+    }
+}
+
+int main(void)
+{
+    int64_t drift_max;
+    int64_t cycles_max;
+    uint64_t slept;
+
+    SysTickSim_Reset();
+    Timebase_Start();
+    srand(1);
+
+    Sleeps(0, 0, &drift_max, &cycles_max, &slept);
+    printf("%u sleeps ended by the SysTick, %.1f ms each\n", (unsigned)SLEEPS,
+           (double)slept / SLEEPS / PERIOD_CYCLES);
+    Check("timeout drift ms", drift_max, 1);
+    Check("timeout cycles", cycles_max, 1);
+
+    Sleeps(600 * PERIOD_CYCLES, 0, &drift_max, &cycles_max, &slept);
+    printf("%u sleeps ended by another interrupt, %.1f ms each\n", (unsigned)SLEEPS,
+           (double)slept / SLEEPS / PERIOD_CYCLES);
+    Check("woken drift ms", drift_max, 1);
+    Check("woken cycles", cycles_max, 1);
+
+    Sleeps(600 * PERIOD_CYCLES, 1, &drift_max, &cycles_max, &slept);
+    printf("%u sleeps ended by another interrupt at the end of a tick, %.1f ms each\n",
+           (unsigned)SLEEPS, (double)slept / SLEEPS / PERIOD_CYCLES);
+    Check("boundary drift ms", drift_max, 1);
+    Check("boundary cycles", cycles_max, 1);
+
+    printf("time base %u ms, SysTick %llu ms\n", (unsigned)Timebase_GetMs(),
+           (unsigned long long)(SysTickSim_Now() / PERIOD_CYCLES));
+    return failures ? 1 : 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,29 @@
+/**
+*   \file cytypes.h
+*   \brief Host replacement of the PSoC Creator cytypes.h.
+*
+*   Only the integer types and the interrupt declaration macros used by
+*   the portable firmware modules are provided, so that they can be
+*   compiled on a PC.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __HOST_CYTYPES_H
+    #define __HOST_CYTYPES_H
+
+    #include <stdint.h>
+    #include <stddef.h>
+
+    typedef uint8_t  uint8;
+    typedef uint16_t uint16;
+    typedef uint32_t uint32;
+    typedef int8_t   int8;
+    typedef int16_t  int16;
+    typedef int32_t  int32;
+
+    #define CY_ISR(FuncName)        void FuncName (void)
+    #define CY_ISR_PROTO(FuncName)  void FuncName (void)
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,43 @@
+/*
+* MARCO MAESTRONI
+*
+* I2C bus speed profiles
+*/
+
+#include "I2C_BusProfile.h"
+#include "I2C_BusStats.h"
+#include "LIS3DH_Driver.h"
+#include "LIS3DH_Fifo.h"
+
+// SCL cycles of one STATUS_REG ... OUT_Z_H burst
+#define SINGLE_SAMPLE_CYCLES I2C_BUS_STATS_READ_CYCLES(LIS3DH_SAMPLE_BURST_LENGTH)
+
+// SCL cycles to drain ACQ_FIFO_WATERMARK samples: FIFO_SRC_REG, then one burst
+#define FIFO_BATCH_CYCLES (I2C_BUS_STATS_READ_CYCLES(1) + \
+    I2C_BUS_STATS_READ_CYCLES(ACQ_FIFO_WATERMARK * LIS3DH_FIFO_SAMPLE_SIZE))
+
+#define PROFILE(khz) { \
+    khz, \
+    (uint16_t)((khz) * 1000UL / SINGLE_SAMPLE_CYCLES), \
+    (uint16_t)((khz) * 1000UL * ACQ_FIFO_WATERMARK / FIFO_BATCH_CYCLES) }
+
+const I2C_BusProfile I2C_BusProfiles[I2C_BUS_PROFILE_COUNT] = {
+    PROFILE(100),
+    PROFILE(400)
+};
+
+const I2C_BusProfile* I2C_BusProfile_Selected(void)
+{
+    uint8_t i;
+    for (i = 0; i < I2C_BUS_PROFILE_COUNT; i++)
+    {
+        if (I2C_BusProfiles[i].speed_khz == ACQ_I2C_SPEED_KHZ)
+        {
+            return &I2C_BusProfiles[i];
+        }
+    }
+    // Unknown speed: be conservative
+    return &I2C_BusProfiles[0];
+}
+
+/* [] END OF FILE */
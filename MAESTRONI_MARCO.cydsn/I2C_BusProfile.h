@@ -0,0 +1,41 @@
+/**
+*   \file I2C_BusProfile.h
+*   \brief I2C bus speed profiles.
+*
+*   For every supported bus speed the profile reports the maximum ODR that
+*   the bus can sustain with one burst per sample and with FIFO draining.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __I2C_BUSPROFILE_H
+    #define __I2C_BUSPROFILE_H
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief Bus speed profile.
+    */
+    typedef struct {
+        uint16_t speed_khz;         ///< SCL frequency in kHz
+        uint16_t single_max_odr;    ///< Max ODR (Hz) with one burst per sample
+        uint16_t fifo_max_odr;      ///< Max ODR (Hz) draining the FIFO at the watermark
+    } I2C_BusProfile;
+
+    /**
+    *   \brief Number of supported profiles.
+    */
+    #define I2C_BUS_PROFILE_COUNT 2
+
+    /**
+    *   \brief Supported profiles, from the slowest to the fastest.
+    */
+    extern const I2C_BusProfile I2C_BusProfiles[I2C_BUS_PROFILE_COUNT];
+
+    /**
+    *   \brief Profile selected with ACQ_I2C_SPEED_KHZ.
+    */
+    const I2C_BusProfile* I2C_BusProfile_Selected(void);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,36 @@
+/*
+* MARCO MAESTRONI
+*
+* I2C bus usage counters
+*/
+
+#include "I2C_BusStats.h"
+
+static I2C_BusStats bus_stats;
+
+void I2C_BusStats_Record(uint8_t conditions, uint16_t bytes)
+{
+    bus_stats.transactions++;
+    bus_stats.conditions += conditions;
+    bus_stats.bytes += bytes;
+}
+
+void I2C_BusStats_Get(I2C_BusStats* stats)
+{
+    *stats = bus_stats;
+}
+
+void I2C_BusStats_Reset(void)
+{
+    bus_stats.transactions = 0;
+    bus_stats.conditions = 0;
+    bus_stats.bytes = 0;
+}
+
+uint32_t I2C_BusStats_Cycles(const I2C_BusStats* stats)
+{
+    return stats->bytes * I2C_BUS_STATS_CYCLES_PER_BYTE
+         + stats->conditions * I2C_BUS_STATS_CYCLES_PER_CONDITION;
+}
+
+/* [] END OF FILE */
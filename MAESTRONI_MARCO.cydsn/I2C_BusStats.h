@@ -0,0 +1,80 @@
+/**
+*   \file I2C_BusStats.h
+*   \brief I2C bus usage counters.
+*
+*   Every transaction performed through the functions of I2C_Interface.h
+*   is accounted here, so that the cost of an access pattern can be
+*   measured in SCL clock cycles independently from the platform the
+*   interface is implemented on.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __I2C_BUSSTATS_H
+    #define __I2C_BUSSTATS_H
+
+    #include "cytypes.h"
+    #include "AcquisitionConfig.h"
+
+    /**
+    *   \brief SCL clock cycles needed by one byte (8 data bits + ACK/NAK).
+    */
+    #define I2C_BUS_STATS_CYCLES_PER_BYTE       9
+
+    /**
+    *   \brief SCL clock cycles accounted for a START, RESTART or STOP condition.
+    */
+    #define I2C_BUS_STATS_CYCLES_PER_CONDITION  1
+
+    /**
+    *   \brief SCL clock cycles of a complete read of count registers.
+    *
+    *   START, address, register address, RESTART, address, data, STOP.
+    */
+    #define I2C_BUS_STATS_READ_CYCLES(count) \
+        (((count) + 3) * I2C_BUS_STATS_CYCLES_PER_BYTE + 3 * I2C_BUS_STATS_CYCLES_PER_CONDITION)
+
+    /**
+    *   \brief I2C bus usage counters.
+    */
+    typedef struct {
+        uint32_t transactions;  ///< Complete START ... STOP sequences
+        uint32_t conditions;    ///< START, RESTART and STOP conditions
+        uint32_t bytes;         ///< Address and data bytes on the bus
+    } I2C_BusStats;
+
+    /**
+    *   \brief Account one complete transaction.
+    *
+    *   \param conditions Number of START, RESTART and STOP conditions.
+    *   \param bytes Number of address and data bytes.
+    */
+    void I2C_BusStats_Record(uint8_t conditions, uint16_t bytes);
+
+    /**
+    *   \brief Copy the current counters.
+    *   \param stats Pointer to the structure where the counters will be saved.
+    */
+    void I2C_BusStats_Get(I2C_BusStats* stats);
+
+    /**
+    *   \brief Reset all the counters to zero.
+    */
+    void I2C_BusStats_Reset(void);
+
+    /**
+    *   \brief Number of SCL clock cycles spent on the bus.
+    *   \param stats Counters to be converted.
+    *   \retval Estimated bus time in SCL clock cycles.
+    */
+    uint32_t I2C_BusStats_Cycles(const I2C_BusStats* stats);
+
+    #if I2C_BUS_STATS_ENABLED
+        #define I2C_BUS_STATS_RECORD(conditions, bytes) \
+            I2C_BusStats_Record((conditions), (bytes))
+    #else
+        #define I2C_BUS_STATS_RECORD(conditions, bytes)
+    #endif
+
+#endif
+/* [] END OF FILE */
@@ -19,7 +19,34 @@
 #endif
 
 #include "I2C_Interface.h" 
+#include "I2C_BusStats.h"
 #include "I2C_Master.h"
+#include "AcquisitionConfig.h"
+
+#if defined(I2C_Master_DATA_RATE) && (I2C_Master_DATA_RATE != ACQ_I2C_SPEED_KHZ)
+    #warning "ACQ_I2C_SPEED_KHZ does not match the Data rate of I2C_Master in TopDesign"
+#endif
+
+/**
+*   \brief Steps of an asynchronous transfer.
+*/
+#define ASYNC_STEP_IDLE         0   ///< No transfer in progress
+#define ASYNC_STEP_WRITE        1   ///< Register address (and data) being written
+#define ASYNC_STEP_READ         2   ///< Data being read after the restart
+#define ASYNC_STEP_COMPLETE     3   ///< Completion not reported yet
+
+/**
+*   \brief Asynchronous transfer in progress.
+*/
+static struct {
+    uint8_t step;
+    uint8_t device_address;
+    uint8_t write_buffer[2];    ///< Register address and data to be written
+    uint8_t* read_data;         ///< NULL for write transfers
+    uint8_t read_count;
+    I2C_AsyncCallback callback;
+    ErrorCode error;
+} async_transfer;
 
     ErrorCode I2C_Peripheral_Start(void) 
     {
@@ -62,6 +89,8 @@
         }
         // Send stop condition
         I2C_Master_MasterSendStop();
+        // START, RESTART, STOP -- two address bytes, register address, data
+        I2C_BUS_STATS_RECORD(3, 4);
         // Return error code
         return error ? ERROR : NO_ERROR;
     }
@@ -100,6 +129,8 @@
         }
         // Send stop condition
         I2C_Master_MasterSendStop();
+        // START, RESTART, STOP -- two address bytes, register address, data
+        I2C_BUS_STATS_RECORD(3, 3 + register_count);
         // Return error code
         return error ? ERROR : NO_ERROR;
     }
@@ -122,6 +153,8 @@
         }
         // Send stop condition
         I2C_Master_MasterSendStop();
+        // START, STOP -- address byte, register address, data
+        I2C_BUS_STATS_RECORD(2, 3);
         // Return error code
         return error ? ERROR : NO_ERROR;
     }
@@ -150,6 +183,7 @@
                     {
                         // Send stop condition
                         I2C_Master_MasterSendStop();
+                        I2C_BUS_STATS_RECORD(2, 2 + register_count - counter + 1);
                         // Return error code
                         return ERROR;
                     }
@@ -159,16 +193,157 @@
         }
         // Send stop condition in case something didn't work out correctly
         I2C_Master_MasterSendStop();
+        // START, STOP -- address byte, register address, data
+        I2C_BUS_STATS_RECORD(2, 2 + register_count);
         // Return error code
         return error ? ERROR : NO_ERROR;
     }
     
     
+    ErrorCode I2C_Peripheral_ReadRegisterMultiAsync(uint8_t device_address,
+                                                    uint8_t register_address,
+                                                    uint8_t register_count,
+                                                    uint8_t* data,
+                                                    I2C_AsyncCallback callback)
+    {
+        if (async_transfer.step != ASYNC_STEP_IDLE)
+        {
+            return ERROR;
+        }
+        // Write address of register to be read with the MSb equal to 1 -- autoincrement
+        async_transfer.write_buffer[0] = register_address | 0x80;
+        async_transfer.device_address = device_address;
+        async_transfer.read_data = data;
+        async_transfer.read_count = register_count;
+        async_transfer.callback = callback;
+        
+        // Write the register address without stop: the read follows with a restart
+        I2C_Master_MasterClearStatus();
+        uint8_t error = I2C_Master_MasterWriteBuf(device_address,
+                                                  async_transfer.write_buffer,
+                                                  1,
+                                                  I2C_Master_MODE_NO_STOP);
+        if (error != I2C_Master_MSTR_NO_ERROR)
+        {
+            return ERROR;
+        }
+        async_transfer.step = ASYNC_STEP_WRITE;
+        return NO_ERROR;
+    }
+    
+    ErrorCode I2C_Peripheral_WriteRegisterAsync(uint8_t device_address,
+                                                uint8_t register_address,
+                                                uint8_t data,
+                                                I2C_AsyncCallback callback)
+    {
+        if (async_transfer.step != ASYNC_STEP_IDLE)
+        {
+            return ERROR;
+        }
+        async_transfer.write_buffer[0] = register_address;
+        async_transfer.write_buffer[1] = data;
+        async_transfer.device_address = device_address;
+        async_transfer.read_data = 0;
+        async_transfer.read_count = 0;
+        async_transfer.callback = callback;
+        
+        I2C_Master_MasterClearStatus();
+        uint8_t error = I2C_Master_MasterWriteBuf(device_address,
+                                                  async_transfer.write_buffer,
+                                                  2,
+                                                  I2C_Master_MODE_COMPLETE_XFER);
+        if (error != I2C_Master_MSTR_NO_ERROR)
+        {
+            return ERROR;
+        }
+        async_transfer.step = ASYNC_STEP_WRITE;
+        return NO_ERROR;
+    }
+    
+    I2C_AsyncStatus I2C_Peripheral_AsyncPoll(void)
+    {
+        uint8_t status = I2C_Master_MasterStatus();
+        
+        switch (async_transfer.step)
+        {
+            case ASYNC_STEP_IDLE:
+                return I2C_ASYNC_IDLE;
+            
+            case ASYNC_STEP_WRITE:
+                if (status & I2C_Master_MSTAT_ERR_XFER)
+                {
+                    async_transfer.error = ERROR;
+                    async_transfer.step = ASYNC_STEP_COMPLETE;
+                }
+                else if (status & I2C_Master_MSTAT_WR_CMPLT)
+                {
+                    if (async_transfer.read_data == 0)
+                    {
+                        // START, STOP -- address byte, register address, data
+                        I2C_BUS_STATS_RECORD(2, 3);
+                        async_transfer.error = NO_ERROR;
+                        async_transfer.step = ASYNC_STEP_COMPLETE;
+                    }
+                    else
+                    {
+                        // Send restart condition and read the data
+                        I2C_Master_MasterClearStatus();
+                        uint8_t error = I2C_Master_MasterReadBuf(async_transfer.device_address,
+                                                                 async_transfer.read_data,
+                                                                 async_transfer.read_count,
+                                                                 I2C_Master_MODE_REPEAT_START);
+                        if (error == I2C_Master_MSTR_NO_ERROR)
+                        {
+                            async_transfer.step = ASYNC_STEP_READ;
+                        }
+                        else
+                        {
+                            async_transfer.error = ERROR;
+                            async_transfer.step = ASYNC_STEP_COMPLETE;
+                        }
+                    }
+                }
+                break;
+            
+            case ASYNC_STEP_READ:
+                if (status & I2C_Master_MSTAT_ERR_XFER)
+                {
+                    async_transfer.error = ERROR;
+                    async_transfer.step = ASYNC_STEP_COMPLETE;
+                }
+                else if (status & I2C_Master_MSTAT_RD_CMPLT)
+                {
+                    // START, RESTART, STOP -- two address bytes, register address, data
+                    I2C_BUS_STATS_RECORD(3, 3 + async_transfer.read_count);
+                    async_transfer.error = NO_ERROR;
+                    async_transfer.step = ASYNC_STEP_COMPLETE;
+                }
+                break;
+            
+            default:
+                break;
+        }
+        
+        if (async_transfer.step != ASYNC_STEP_COMPLETE)
+        {
+            return I2C_ASYNC_BUSY;
+        }
+        
+        // Report the completion once
+        async_transfer.step = ASYNC_STEP_IDLE;
+        if (async_transfer.callback != 0)
+        {
+            async_transfer.callback(async_transfer.error);
+        }
+        return async_transfer.error == NO_ERROR ? I2C_ASYNC_DONE : I2C_ASYNC_FAILED;
+    }
+    
     uint8_t I2C_Peripheral_IsDeviceConnected(uint8_t device_address)
     {
         // Send a start condition followed by a stop condition
         uint8_t error = I2C_Master_MasterSendStart(device_address, I2C_Master_WRITE_XFER_MODE);
         I2C_Master_MasterSendStop();
+        I2C_BUS_STATS_RECORD(2, 1);
         // If no error generated during stop, device is connected
         if (error == I2C_Master_MSTR_NO_ERROR)
         {
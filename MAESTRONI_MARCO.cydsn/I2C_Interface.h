@@ -83,6 +83,71 @@
                                             uint8_t register_count,
                                             uint8_t* data);
     
+    /**
+    *   \brief State of an asynchronous transfer.
+    */
+    typedef enum {
+        I2C_ASYNC_IDLE,     ///< No transfer started
+        I2C_ASYNC_BUSY,     ///< Transfer on the bus
+        I2C_ASYNC_DONE,     ///< Transfer completed without errors
+        I2C_ASYNC_FAILED    ///< Transfer completed with an error
+    } I2C_AsyncStatus;
+    
+    /**
+    *   \brief Function called when an asynchronous transfer completes.
+    *   \param error NO_ERROR if the transfer completed successfully.
+    */
+    typedef void (*I2C_AsyncCallback)(ErrorCode error);
+    
+    /** 
+    *   \brief Start reading multiple bytes over I2C without blocking.
+    *   
+    *   This function starts a reading operation over I2C from multiple
+    *   registers and returns immediately: the transfer is carried out by
+    *   the I2C interrupt while the CPU does other work. Only one transfer
+    *   can be in progress and the blocking functions must not be used
+    *   until it completes.
+    *   \param device_address I2C address of the device to talk to.
+    *   \param register_address Address of the first register to be read.
+    *   \param register_count Number of registers we want to read.
+    *   \param data Pointer to an array where data will be saved. It must
+    *   stay valid until the transfer completes.
+    *   \param callback Function called by I2C_Peripheral_AsyncPoll when the
+    *   transfer completes (can be 0).
+    */
+    ErrorCode I2C_Peripheral_ReadRegisterMultiAsync(uint8_t device_address,
+                                                    uint8_t register_address,
+                                                    uint8_t register_count,
+                                                    uint8_t* data,
+                                                    I2C_AsyncCallback callback);
+    
+    /** 
+    *   \brief Start writing a byte over I2C without blocking.
+    *   
+    *   Same as I2C_Peripheral_WriteRegister, but the function returns as
+    *   soon as the transfer is started.
+    *   \param device_address I2C address of the device to talk to.
+    *   \param register_address Address of the register to be written.
+    *   \param data Data to be written
+    *   \param callback Function called by I2C_Peripheral_AsyncPoll when the
+    *   transfer completes (can be 0).
+    */
+    ErrorCode I2C_Peripheral_WriteRegisterAsync(uint8_t device_address,
+                                                uint8_t register_address,
+                                                uint8_t data,
+                                                I2C_AsyncCallback callback);
+    
+    /**
+    *   \brief Advance the asynchronous transfer.
+    *
+    *   This function must be called periodically while a transfer is in
+    *   progress. It returns I2C_ASYNC_DONE or I2C_ASYNC_FAILED once, when
+    *   the transfer completes (after calling the callback), and then
+    *   I2C_ASYNC_IDLE.
+    *   \retval State of the transfer.
+    */
+    I2C_AsyncStatus I2C_Peripheral_AsyncPoll(void);
+    
     /**
     *   \brief Check if device is connected over I2C.
     *
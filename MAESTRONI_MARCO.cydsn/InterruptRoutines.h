@@ -10,20 +10,20 @@
  * ========================================
 */
 
-extern int state;
-extern int newstate;
-
 #ifndef _INTERRUPT_ROUTINES_H_
     // Header guard
     #define _INTERRUPT_ROUTINES_H_
     
-    #include "project.h"
+    #include "Hal.h"
+    
+    //set by the data-ready ISR, cleared by the main loop
+    extern volatile uint8_t data_ready;
     
     /**
     *   \brief ISR Code.
     */
     
-    CY_ISR_PROTO(ChangeFreq);
+    CY_ISR_PROTO(DataReady);
     
 #endif
 
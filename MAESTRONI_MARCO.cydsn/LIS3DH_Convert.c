@@ -0,0 +1,44 @@
+/*
+* MARCO MAESTRONI
+*
+* Fixed-point conversion of the LIS3DH outputs to m/s^2
+*/
+
+#include "LIS3DH_Convert.h"
+#include "LIS3DH_Registers.h"
+
+#define FULL_SCALE(fs, g) { (fs) << LIS3DH_CTRL_REG4_FS_SHIFT, (g) }
+
+const LIS3DH_FullScale LIS3DH_FullScaleTable[LIS3DH_FULL_SCALE_COUNT] = {
+    FULL_SCALE(0,  2),
+    FULL_SCALE(1,  4),
+    FULL_SCALE(2,  8),
+    FULL_SCALE(3, 16)
+};
+
+// bits of the output and mg/digit; mm/s^2 per digit in Q format,
+// rounded to nearest
+#define SENSITIVITY(bits, mg) { \
+    16 - (bits), \
+    (mg), \
+    (int32_t)(((mg) * (int64_t)LIS3DH_CONVERT_GRAVITY_MMS2 * (1L << LIS3DH_CONVERT_Q) + 500) / 1000) }
+
+// Datasheet "mechanical characteristics": low-power, normal, high resolution
+const LIS3DH_Sensitivity LIS3DH_SensitivityTable[LIS3DH_FULL_SCALE_COUNT][LIS3DH_MODE_COUNT] = {
+    { SENSITIVITY(8,  16), SENSITIVITY(10,  4), SENSITIVITY(12,  1) },
+    { SENSITIVITY(8,  32), SENSITIVITY(10,  8), SENSITIVITY(12,  2) },
+    { SENSITIVITY(8,  64), SENSITIVITY(10, 16), SENSITIVITY(12,  4) },
+    { SENSITIVITY(8, 192), SENSITIVITY(10, 48), SENSITIVITY(12, 12) }
+};
+
+int32_t LIS3DH_ConvertMms2(const LIS3DH_Sensitivity* sensitivity, int16_t raw)
+{
+    int64_t product = (int64_t)(raw >> sensitivity->shift) * sensitivity->mms2_q;
+
+    // Truncate toward zero: negative products are rounded up before the
+    // arithmetic shift, without a branch
+    product += (product >> 63) & ((1L << LIS3DH_CONVERT_Q) - 1);
+    return (int32_t)(product >> LIS3DH_CONVERT_Q);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,114 @@
+/**
+*   \file LIS3DH_Convert.h
+*   \brief Fixed-point conversion of the LIS3DH outputs to m/s^2.
+*
+*   The outputs are converted to mm/s^2 (m/s^2 with 3 decimals) with a
+*   shift, one integer multiplication by a Q16 factor and one shift, all
+*   taken from a constant table entry per full-scale range and operating
+*   mode. No floating point is used, since the Cortex-M3 has no FPU.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __LIS3DH_CONVERT_H
+    #define __LIS3DH_CONVERT_H
+
+    #include "cytypes.h"
+    #include "AcquisitionConfig.h"
+
+    /**
+    *   \brief Fractional bits of the conversion factors.
+    *
+    *   The product is computed on 64 bits (one SMULL on the Cortex-M3).
+    */
+    #define LIS3DH_CONVERT_Q 16
+
+    /**
+    *   \brief Standard gravity used by the conversion, in mm/s^2.
+    */
+    #define LIS3DH_CONVERT_GRAVITY_MMS2 9810
+
+    /**
+    *   \brief Low-power mode: 8-bit outputs (CTRL_REG1 LPen set).
+    */
+    #define LIS3DH_MODE_LOW_POWER       0
+
+    /**
+    *   \brief Normal mode: 10-bit outputs (LPen and CTRL_REG4 HR clear).
+    */
+    #define LIS3DH_MODE_NORMAL          1
+
+    /**
+    *   \brief High-resolution mode: 12-bit outputs (CTRL_REG4 HR set).
+    */
+    #define LIS3DH_MODE_HIGH_RESOLUTION 2
+
+    /**
+    *   \brief Number of operating modes.
+    */
+    #define LIS3DH_MODE_COUNT 3
+
+    /**
+    *   \brief Description of one full-scale range.
+    */
+    typedef struct {
+        uint8_t ctrl_reg4_fs;   ///< CTRL_REG4 FS[1:0] bits
+        uint8_t g;              ///< Range in g
+    } LIS3DH_FullScale;
+
+    /**
+    *   \brief Sensitivity of one full-scale range in one operating mode.
+    *
+    *   The outputs are left-justified in 16 bits: shifting right by
+    *   shift gives the output in digits of mg_per_digit.
+    */
+    typedef struct {
+        uint8_t shift;          ///< Right shift of the 16-bit output word
+        uint8_t mg_per_digit;   ///< Sensitivity in mg/digit
+        int32_t mms2_q;         ///< mm/s^2 per digit, LIS3DH_CONVERT_Q fractional bits
+    } LIS3DH_Sensitivity;
+
+    /**
+    *   \brief Number of entries of the full-scale table.
+    */
+    #define LIS3DH_FULL_SCALE_COUNT 4
+
+    /**
+    *   \brief Full-scale table, indexed by FS[1:0].
+    */
+    extern const LIS3DH_FullScale LIS3DH_FullScaleTable[LIS3DH_FULL_SCALE_COUNT];
+
+    /**
+    *   \brief Sensitivity table, indexed by FS[1:0] and operating mode.
+    */
+    extern const LIS3DH_Sensitivity LIS3DH_SensitivityTable[LIS3DH_FULL_SCALE_COUNT][LIS3DH_MODE_COUNT];
+
+    /**
+    *   \brief Index in LIS3DH_FullScaleTable of ACQ_FULL_SCALE_G.
+    */
+    #if ACQ_FULL_SCALE_G == 2
+        #define LIS3DH_FULL_SCALE_SELECTED 0
+    #elif ACQ_FULL_SCALE_G == 4
+        #define LIS3DH_FULL_SCALE_SELECTED 1
+    #elif ACQ_FULL_SCALE_G == 8
+        #define LIS3DH_FULL_SCALE_SELECTED 2
+    #elif ACQ_FULL_SCALE_G == 16
+        #define LIS3DH_FULL_SCALE_SELECTED 3
+    #else
+        #error "ACQ_FULL_SCALE_G must be 2, 4, 8 or 16"
+    #endif
+
+    /**
+    *   \brief Convert an output word to mm/s^2.
+    *
+    *   Shift and scale are taken from the descriptor, so the same code
+    *   serves every range and mode. The result is truncated toward zero
+    *   like the float conversion it replaces, and is within 1 mm/s^2 of it.
+    *   \param sensitivity Range and mode the output was measured with.
+    *   \param raw Left-justified output word (OUT_X_H:OUT_X_L).
+    *   \retval Acceleration in mm/s^2.
+    */
+    int32_t LIS3DH_ConvertMms2(const LIS3DH_Sensitivity* sensitivity, int16_t raw);
+
+#endif
+/* [] END OF FILE */
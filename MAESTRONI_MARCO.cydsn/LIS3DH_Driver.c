@@ -0,0 +1,63 @@
+/*
+* MARCO MAESTRONI
+*
+* LIS3DH data acquisition functions
+*/
+
+#include "LIS3DH_Driver.h"
+#include "I2C_Interface.h"
+
+ErrorCode LIS3DH_ReadSample(LIS3DH_Sample* sample)
+{
+    uint8_t buffer[LIS3DH_SAMPLE_BURST_LENGTH];
+
+    // One auto-increment read from STATUS_REG to OUT_Z_H
+    ErrorCode error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS,
+                                                       LIS3DH_STATUS_REG,
+                                                       LIS3DH_SAMPLE_BURST_LENGTH,
+                                                       buffer);
+    if (error == NO_ERROR)
+    {
+        LIS3DH_DecodeSample(buffer, sample);
+    }
+    return error;
+}
+
+// Burst buffer of the asynchronous read, written by the I2C interrupt
+static uint8_t async_buffer[LIS3DH_SAMPLE_BURST_LENGTH];
+
+ErrorCode LIS3DH_ReadSampleStart(void)
+{
+    return I2C_Peripheral_ReadRegisterMultiAsync(LIS3DH_DEVICE_ADDRESS,
+                                                 LIS3DH_STATUS_REG,
+                                                 LIS3DH_SAMPLE_BURST_LENGTH,
+                                                 async_buffer,
+                                                 0);
+}
+
+ErrorCode LIS3DH_ReadSampleWait(LIS3DH_Sample* sample)
+{
+    I2C_AsyncStatus status;
+
+    do
+    {
+        status = I2C_Peripheral_AsyncPoll();
+    } while (status == I2C_ASYNC_BUSY);
+
+    if (status != I2C_ASYNC_DONE)
+    {
+        return ERROR;
+    }
+    LIS3DH_DecodeSample(async_buffer, sample);
+    return NO_ERROR;
+}
+
+void LIS3DH_DecodeSample(const uint8_t* buffer, LIS3DH_Sample* sample)
+{
+    sample->status = buffer[0];
+    sample->x = (int16_t)(buffer[1] | (buffer[2] << 8));
+    sample->y = (int16_t)(buffer[3] | (buffer[4] << 8));
+    sample->z = (int16_t)(buffer[5] | (buffer[6] << 8));
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,69 @@
+/**
+*   \file LIS3DH_Driver.h
+*   \brief LIS3DH data acquisition functions.
+*
+*   Functions built on top of I2C_Interface.h to read the accelerometer
+*   output with as few bus transactions as possible.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __LIS3DH_DRIVER_H
+    #define __LIS3DH_DRIVER_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+    #include "LIS3DH_Registers.h"
+
+    /**
+    *   \brief Number of registers read by a single sample burst.
+    *
+    *   STATUS_REG (0x27) followed by OUT_X_L ... OUT_Z_H (0x28 ... 0x2D).
+    */
+    #define LIS3DH_SAMPLE_BURST_LENGTH (LIS3DH_OUT_Z_H - LIS3DH_STATUS_REG + 1)
+
+    /**
+    *   \brief One sample of the three axes.
+    *
+    *   The outputs are left-justified as in the OUT_x_H:OUT_x_L registers.
+    */
+    typedef struct {
+        uint8_t status;     ///< STATUS_REG read in the same burst as the outputs
+        int16_t x;          ///< X axis raw output
+        int16_t y;          ///< Y axis raw output
+        int16_t z;          ///< Z axis raw output
+    } LIS3DH_Sample;
+
+    /**
+    *   \brief Read the status register and the three axes in one burst.
+    *
+    *   This function reads STATUS_REG through OUT_Z_H with a single
+    *   auto-increment transaction and decodes all three axes.
+    *   \param sample Pointer to the structure where the sample will be saved.
+    */
+    ErrorCode LIS3DH_ReadSample(LIS3DH_Sample* sample);
+
+    /**
+    *   \brief Start the burst read of a sample without blocking.
+    *
+    *   The sample is read by the I2C interrupt while the CPU does other
+    *   work; LIS3DH_ReadSampleWait collects it.
+    */
+    ErrorCode LIS3DH_ReadSampleStart(void);
+
+    /**
+    *   \brief Wait for the burst started by LIS3DH_ReadSampleStart.
+    *   \param sample Pointer to the structure where the sample will be saved.
+    */
+    ErrorCode LIS3DH_ReadSampleWait(LIS3DH_Sample* sample);
+
+    /**
+    *   \brief Decode a sample from the burst buffer.
+    *
+    *   \param buffer LIS3DH_SAMPLE_BURST_LENGTH bytes starting from STATUS_REG.
+    *   \param sample Pointer to the structure where the sample will be saved.
+    */
+    void LIS3DH_DecodeSample(const uint8_t* buffer, LIS3DH_Sample* sample);
+
+#endif
+/* [] END OF FILE */
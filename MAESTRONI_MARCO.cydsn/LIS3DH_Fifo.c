@@ -0,0 +1,134 @@
+/*
+* MARCO MAESTRONI
+*
+* LIS3DH FIFO acquisition functions
+*/
+
+#include "LIS3DH_Fifo.h"
+#include "I2C_Interface.h"
+
+ErrorCode LIS3DH_FifoStart(uint8_t watermark, uint8_t route_int1)
+{
+    uint8_t ctrl_reg3;
+    uint8_t ctrl_reg5;
+    ErrorCode error;
+
+    // Restart from bypass mode so that the FIFO is emptied
+    error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
+                                         LIS3DH_FIFO_CTRL_REG,
+                                         LIS3DH_FIFO_CTRL_REG_BYPASS);
+    if (error != NO_ERROR)
+    {
+        return error;
+    }
+
+    error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_CTRL_REG5, &ctrl_reg5);
+    if (error != NO_ERROR)
+    {
+        return error;
+    }
+    error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
+                                         LIS3DH_CTRL_REG5,
+                                         ctrl_reg5 | LIS3DH_CTRL_REG5_FIFO_EN);
+    if (error != NO_ERROR)
+    {
+        return error;
+    }
+
+    error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
+                                         LIS3DH_FIFO_CTRL_REG,
+                                         LIS3DH_FIFO_CTRL_REG_STREAM |
+                                         (watermark & LIS3DH_FIFO_CTRL_REG_FTH));
+    if (error != NO_ERROR)
+    {
+        return error;
+    }
+
+    ctrl_reg3 = route_int1 ? LIS3DH_CTRL_REG3_I1_WTM : 0;
+    return I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_CTRL_REG3, ctrl_reg3);
+}
+
+ErrorCode LIS3DH_FifoStop(void)
+{
+    uint8_t ctrl_reg5;
+    ErrorCode error;
+
+    error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
+                                         LIS3DH_FIFO_CTRL_REG,
+                                         LIS3DH_FIFO_CTRL_REG_BYPASS);
+    if (error != NO_ERROR)
+    {
+        return error;
+    }
+    error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_CTRL_REG5, &ctrl_reg5);
+    if (error != NO_ERROR)
+    {
+        return error;
+    }
+    return I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
+                                        LIS3DH_CTRL_REG5,
+                                        ctrl_reg5 & ~LIS3DH_CTRL_REG5_FIFO_EN);
+}
+
+uint8_t LIS3DH_FifoLevel(uint8_t fifo_src)
+{
+    // FSS[4:0] cannot represent a full FIFO: it is flagged by OVRN_FIFO
+    if (fifo_src & LIS3DH_FIFO_SRC_REG_OVRN_FIFO)
+    {
+        return LIS3DH_FIFO_DEPTH;
+    }
+    return fifo_src & LIS3DH_FIFO_SRC_REG_FSS;
+}
+
+ErrorCode LIS3DH_FifoDrain(LIS3DH_Sample* samples,
+                           uint8_t max_samples,
+                           uint8_t* count,
+                           uint8_t* fifo_src)
+{
+    uint8_t buffer[LIS3DH_FIFO_DEPTH * LIS3DH_FIFO_SAMPLE_SIZE];
+    uint8_t src;
+    uint8_t level;
+    uint8_t i;
+    ErrorCode error;
+
+    *count = 0;
+    error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_FIFO_SRC_REG, &src);
+    *fifo_src = src;
+    if (error != NO_ERROR)
+    {
+        return error;
+    }
+
+    level = LIS3DH_FifoLevel(src);
+    if (level > max_samples)
+    {
+        level = max_samples;
+    }
+    if (level == 0)
+    {
+        return NO_ERROR;
+    }
+
+    // One burst for all the stored samples
+    error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS,
+                                             LIS3DH_OUT_X_L,
+                                             level * LIS3DH_FIFO_SAMPLE_SIZE,
+                                             buffer);
+    if (error != NO_ERROR)
+    {
+        return error;
+    }
+
+    for (i = 0; i < level; i++)
+    {
+        const uint8_t* raw = &buffer[i * LIS3DH_FIFO_SAMPLE_SIZE];
+        samples[i].status = LIS3DH_STATUS_REG_NEW_DATA;
+        samples[i].x = (int16_t)(raw[0] | (raw[1] << 8));
+        samples[i].y = (int16_t)(raw[2] | (raw[3] << 8));
+        samples[i].z = (int16_t)(raw[4] | (raw[5] << 8));
+    }
+    *count = level;
+    return NO_ERROR;
+}
+
+/* [] END OF FILE */
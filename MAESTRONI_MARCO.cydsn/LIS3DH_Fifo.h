@@ -0,0 +1,62 @@
+/**
+*   \file LIS3DH_Fifo.h
+*   \brief LIS3DH FIFO acquisition functions.
+*
+*   In stream mode the LIS3DH buffers up to 32 samples; when the
+*   watermark is reached INT1 is raised and all the stored samples are
+*   read back with a single auto-increment burst.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __LIS3DH_FIFO_H
+    #define __LIS3DH_FIFO_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+    #include "LIS3DH_Driver.h"
+
+    /**
+    *   \brief Bytes of one sample stored in the FIFO (OUT_X_L ... OUT_Z_H).
+    */
+    #define LIS3DH_FIFO_SAMPLE_SIZE (LIS3DH_OUT_Z_H - LIS3DH_OUT_X_L + 1)
+
+    /**
+    *   \brief Enable the FIFO in stream mode.
+    *
+    *   \param watermark Number of samples (1 ... 31) that raises the
+    *   watermark flag and, if routed, INT1.
+    *   \param route_int1 If not zero the watermark interrupt is routed on INT1.
+    */
+    ErrorCode LIS3DH_FifoStart(uint8_t watermark, uint8_t route_int1);
+
+    /**
+    *   \brief Disable the FIFO and go back to bypass mode.
+    */
+    ErrorCode LIS3DH_FifoStop(void);
+
+    /**
+    *   \brief Number of samples stored in the FIFO.
+    *   \param fifo_src Value of FIFO_SRC_REG.
+    */
+    uint8_t LIS3DH_FifoLevel(uint8_t fifo_src);
+
+    /**
+    *   \brief Read all the samples stored in the FIFO.
+    *
+    *   FIFO_SRC_REG is read first to know how many samples are available,
+    *   then they are read in one burst of 6xN bytes from OUT_X_L (in FIFO
+    *   mode the address rolls over from OUT_Z_H to OUT_X_L).
+    *   \param samples Array of at least max_samples elements.
+    *   \param max_samples Maximum number of samples to be read.
+    *   \param count Pointer to a variable where the number of samples read
+    *   will be saved.
+    *   \param fifo_src Pointer to a variable where FIFO_SRC_REG will be saved.
+    */
+    ErrorCode LIS3DH_FifoDrain(LIS3DH_Sample* samples,
+                               uint8_t max_samples,
+                               uint8_t* count,
+                               uint8_t* fifo_src);
+
+#endif
+/* [] END OF FILE */
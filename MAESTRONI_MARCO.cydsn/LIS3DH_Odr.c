@@ -0,0 +1,107 @@
+/*
+* MARCO MAESTRONI
+*
+* LIS3DH output data rate table
+*/
+
+#include "LIS3DH_Odr.h"
+#include "LIS3DH_Registers.h"
+#include "I2C_Interface.h"
+#include "AcquisitionConfig.h"
+#include "LIS3DH_Convert.h"
+
+// UART bytes per second: 1 start bit, 8 data bits, 1 stop bit
+#define UART_BYTES_PER_SECOND (ACQ_UART_BAUD_RATE / 10UL)
+
+// Above 400 Hz an ODR code selects another rate in low-power mode
+#define LOW_POWER_SAME_RATE_MAX_HZ 400
+
+#define ODR(code, hz, low_power) { \
+    ((code) << LIS3DH_CTRL_REG1_ODR_SHIFT) | \
+        ((low_power) ? LIS3DH_CTRL_REG1_LPEN : 0) | LIS3DH_CTRL_REG1_XYZ_EN, \
+    (low_power), \
+    (hz), \
+    1000000UL / (hz), \
+    (uint16_t)(UART_BYTES_PER_SECOND / (hz)) }
+
+const LIS3DH_OdrDescriptor LIS3DH_OdrTable[LIS3DH_ODR_COUNT] = {
+    ODR(0x1,    1, 0),
+    ODR(0x2,   10, 0),
+    ODR(0x3,   25, 0),
+    ODR(0x4,   50, 0),
+    ODR(0x5,  100, 0),
+    ODR(0x6,  200, 0),
+    ODR(0x7,  400, 0),
+    ODR(0x9, 1344, 0),
+    ODR(0x8, 1600, 1),
+    ODR(0x9, 5376, 1)
+};
+
+uint8_t LIS3DH_OdrCycleLength(void)
+{
+    uint8_t count = 0;
+    while (count < LIS3DH_ODR_COUNT && LIS3DH_OdrTable[count].hz <= ACQ_ODR_MAX_HZ)
+    {
+        count++;
+    }
+    // At least the slowest rate
+    return count ? count : 1;
+}
+
+int8_t LIS3DH_OdrFind(uint8_t ctrl_reg1)
+{
+    uint8_t count = LIS3DH_OdrCycleLength();
+    uint8_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (LIS3DH_OdrTable[i].ctrl_reg1 == ctrl_reg1)
+        {
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
+
+uint8_t LIS3DH_OdrMode(const LIS3DH_OdrDescriptor* odr)
+{
+    if (odr->low_power)
+    {
+        return LIS3DH_MODE_LOW_POWER;
+    }
+#if ACQ_LOW_POWER
+    if (odr->hz <= LOW_POWER_SAME_RATE_MAX_HZ &&
+        LIS3DH_SensitivityTable[LIS3DH_FULL_SCALE_SELECTED][LIS3DH_MODE_LOW_POWER].mg_per_digit <=
+            ACQ_LOW_POWER_PRECISION_MG)
+    {
+        return LIS3DH_MODE_LOW_POWER;
+    }
+#endif
+    return ACQ_HIGH_RESOLUTION ? LIS3DH_MODE_HIGH_RESOLUTION : LIS3DH_MODE_NORMAL;
+}
+
+ErrorCode LIS3DH_SetOdr(const LIS3DH_OdrDescriptor* odr)
+{
+    uint8_t mode = LIS3DH_OdrMode(odr);
+    // High resolution and low-power mode cannot be enabled together
+    uint8_t ctrl_reg4 = mode == LIS3DH_MODE_HIGH_RESOLUTION ?
+                        LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG4 : 0;
+    // The table entry is kept as the EEPROM record of the rate
+    uint8_t ctrl_reg1 = mode == LIS3DH_MODE_LOW_POWER ?
+                        odr->ctrl_reg1 | LIS3DH_CTRL_REG1_LPEN : odr->ctrl_reg1;
+
+    ctrl_reg4 |= LIS3DH_FullScaleTable[LIS3DH_FULL_SCALE_SELECTED].ctrl_reg4_fs;
+
+    ErrorCode error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
+                                                   LIS3DH_CTRL_REG4,
+                                                   ctrl_reg4);
+    if (error != NO_ERROR)
+    {
+        return error;
+    }
+    return I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
+                                        LIS3DH_CTRL_REG1,
+                                        ctrl_reg1);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,76 @@
+/**
+*   \file LIS3DH_Odr.h
+*   \brief LIS3DH output data rate table.
+*
+*   Every data rate supported by the LIS3DH is described by one constant
+*   entry: switching rate is a lookup, no code is needed per rate.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __LIS3DH_ODR_H
+    #define __LIS3DH_ODR_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief Description of one output data rate.
+    */
+    typedef struct {
+        uint8_t ctrl_reg1;      ///< CTRL_REG1 value: ODR[3:0], LPen, axes enabled
+        uint8_t low_power;      ///< 1 if only available in low-power (8 bit) mode
+        uint16_t hz;            ///< Output data rate in Hz
+        uint32_t period_us;     ///< Expected sample period in microseconds
+        uint16_t packet_budget; ///< UART bytes that can be sent in one sample period
+    } LIS3DH_OdrDescriptor;
+
+    /**
+    *   \brief Number of entries of the ODR table.
+    */
+    #define LIS3DH_ODR_COUNT 10
+
+    /**
+    *   \brief ODR table, sorted by increasing rate.
+    */
+    extern const LIS3DH_OdrDescriptor LIS3DH_OdrTable[LIS3DH_ODR_COUNT];
+
+    /**
+    *   \brief Number of table entries the push button cycles through.
+    *
+    *   The button cycles through the rates up to ACQ_ODR_MAX_HZ.
+    */
+    uint8_t LIS3DH_OdrCycleLength(void);
+
+    /**
+    *   \brief Find the data rate selected by a CTRL_REG1 value.
+    *
+    *   Only the rates the push button cycles through are accepted.
+    *   \param ctrl_reg1 CTRL_REG1 value, e.g. read from the EEPROM.
+    *   \retval Index of the rate in LIS3DH_OdrTable, -1 if not valid.
+    */
+    int8_t LIS3DH_OdrFind(uint8_t ctrl_reg1);
+
+    /**
+    *   \brief Operating mode the LIS3DH is set to at a data rate.
+    *
+    *   Low-power at the low-power only rates, and with ACQ_LOW_POWER at
+    *   the rates up to 400 Hz if ACQ_LOW_POWER_PRECISION_MG allows it;
+    *   high resolution at the other ones, or normal if ACQ_HIGH_RESOLUTION
+    *   is 0.
+    *   \param odr Descriptor of the data rate.
+    *   \retval One of the LIS3DH_MODE_ values of LIS3DH_Convert.h.
+    */
+    uint8_t LIS3DH_OdrMode(const LIS3DH_OdrDescriptor* odr);
+
+    /**
+    *   \brief Write CTRL_REG1 and CTRL_REG4 to select a data rate.
+    *
+    *   The operating mode is the one of LIS3DH_OdrMode (LPen is set in
+    *   CTRL_REG1 if needed) and the full-scale range is ACQ_FULL_SCALE_G.
+    *   \param odr Descriptor of the data rate.
+    */
+    ErrorCode LIS3DH_SetOdr(const LIS3DH_OdrDescriptor* odr);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,141 @@
+/**
+*   \file LIS3DH_Registers.h
+*   \brief LIS3DH register map.
+*
+*   This file contains the addresses and the bit masks of the LIS3DH
+*   registers used throughout the firmware.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __LIS3DH_REGISTERS_H
+    #define __LIS3DH_REGISTERS_H
+
+    /**
+    *   \brief 7-bit I2C address of the slave device.
+    *   SDO connected to ground
+    */
+    #define LIS3DH_DEVICE_ADDRESS 0x18
+
+    /**
+    *   \brief Address of the WHO AM I register
+    */
+    #define LIS3DH_WHO_AM_I_REG_ADDR 0x0F
+
+    /**
+    *   \brief Address of the Control register 1
+    */
+    #define LIS3DH_CTRL_REG1 0x20
+
+    /**
+    *   \brief Address of the Control register 2
+    */
+    #define LIS3DH_CTRL_REG2 0x21
+
+    /**
+    *   \brief Address of the Control register 3
+    */
+    #define LIS3DH_CTRL_REG3 0x22
+
+    //ZYXDA (data-ready) interrupt routed on INT1 pin
+    #define LIS3DH_CTRL_REG3_I1_ZYXDA 0x10
+
+    //FIFO watermark interrupt routed on INT1 pin
+    #define LIS3DH_CTRL_REG3_I1_WTM 0x04
+
+    //FIFO overrun interrupt routed on INT1 pin
+    #define LIS3DH_CTRL_REG3_I1_OVERRUN 0x02
+
+    /**
+    *   \brief Address of the Control register 4
+    */
+    #define LIS3DH_CTRL_REG4 0x23
+
+    /**
+    *   \brief Address of the Control register 5
+    */
+    #define LIS3DH_CTRL_REG5 0x24
+
+    //FIFO enable
+    #define LIS3DH_CTRL_REG5_FIFO_EN 0x40
+
+    /**
+    *   \brief Address of the Control register 6
+    */
+    #define LIS3DH_CTRL_REG6 0x25
+
+    /**
+    *   \brief Address of the Status register
+    */
+    #define LIS3DH_STATUS_REG 0x27
+
+    //new set of X, Y and Z data available in status register (ZYXDA, bit 3)
+    #define LIS3DH_STATUS_REG_NEW_DATA  0x08
+    //a new set of X, Y and Z data overwrote the previous one before it was read (ZYXOR, bit 7)
+    #define LIS3DH_STATUS_REG_OVERRUN   0x80
+    //new X, Y, Z data overwrote the previous one of that axis (XOR, YOR, ZOR, bits 4 ... 6)
+    #define LIS3DH_STATUS_REG_X_OVERRUN 0x10
+    #define LIS3DH_STATUS_REG_Y_OVERRUN 0x20
+    #define LIS3DH_STATUS_REG_Z_OVERRUN 0x40
+
+    /**
+    *   \ Address of HIGH RESOLUTION MODE in control registers
+    */
+    #define LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG1 0x07
+    #define LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG4 0x08
+
+    //fields of control register 4
+    #define LIS3DH_CTRL_REG4_FS_SHIFT 4     //FS[1:0] full-scale selection
+
+    //fields of control register 1
+    #define LIS3DH_CTRL_REG1_ODR_SHIFT 4    //ODR[3:0] data rate selection
+    #define LIS3DH_CTRL_REG1_LPEN      0x08 //low-power mode enable
+    #define LIS3DH_CTRL_REG1_XYZ_EN    0x07 //X, Y and Z axes enabled
+
+    /**
+    *   \brief Address of the X,Y and Z output LSB register
+    */
+    #define LIS3DH_OUT_X_L 0x28
+    #define LIS3DH_OUT_Y_L 0x2A
+    #define LIS3DH_OUT_Z_L 0x2C
+
+    /**
+    *   \brief Address of the Z output MSB register (last output register)
+    */
+    #define LIS3DH_OUT_Z_H 0x2D
+
+    /**
+    *   \brief Address of the FIFO control register
+    */
+    #define LIS3DH_FIFO_CTRL_REG 0x2E
+
+    //FIFO mode selection FM[1:0]
+    #define LIS3DH_FIFO_CTRL_REG_BYPASS 0x00
+    #define LIS3DH_FIFO_CTRL_REG_FIFO   0x40
+    #define LIS3DH_FIFO_CTRL_REG_STREAM 0x80
+    #define LIS3DH_FIFO_CTRL_REG_MODE   0xC0
+
+    //FIFO watermark threshold FTH[4:0]
+    #define LIS3DH_FIFO_CTRL_REG_FTH    0x1F
+
+    /**
+    *   \brief Address of the FIFO source register
+    */
+    #define LIS3DH_FIFO_SRC_REG 0x2F
+
+    //FIFO content exceeds the watermark level
+    #define LIS3DH_FIFO_SRC_REG_WTM       0x80
+    //FIFO is full (32 samples): in stream mode the next sample overwrites the oldest one
+    #define LIS3DH_FIFO_SRC_REG_OVRN_FIFO 0x40
+    //FIFO is empty
+    #define LIS3DH_FIFO_SRC_REG_EMPTY     0x20
+    //number of unread samples FSS[4:0]
+    #define LIS3DH_FIFO_SRC_REG_FSS       0x1F
+
+    /**
+    *   \brief Number of samples the LIS3DH FIFO can store.
+    */
+    #define LIS3DH_FIFO_DEPTH 32
+
+#endif
+/* [] END OF FILE */
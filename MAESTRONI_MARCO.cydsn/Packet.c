@@ -0,0 +1,375 @@
+/*
+* MARCO MAESTRONI
+*
+* Binary frames sent over UART
+*/
+
+#include "Packet.h"
+#include "Crc8.h"
+
+// Sign extension of a 12-bit value
+#define SIGN_EXTEND_12(value) ((int16_t)((uint16_t)(value) << 4) >> 4)
+
+void Packet_BuildV2(const Packet_V2* packet, uint8_t* frame)
+{
+    frame[0] = PACKET_V2_SYNC;
+    frame[1] = packet->seq;
+    frame[2] = (uint8_t)packet->timestamp;
+    frame[3] = (uint8_t)(packet->timestamp >> 8);
+    frame[4] = (uint8_t)(packet->timestamp >> 16);
+    frame[5] = (uint8_t)(packet->timestamp >> 24);
+    frame[6] = (uint8_t)(packet->x >> 4);
+    frame[7] = (uint8_t)(packet->y >> 4);
+    frame[8] = (uint8_t)(packet->z >> 4);
+    frame[9] = (uint8_t)(((packet->x & 0x0F) << 4) | (packet->y & 0x0F));
+    frame[10] = (uint8_t)(((packet->z & 0x0F) << 4) | (packet->odr & 0x0F));
+    frame[11] = Crc8_Update(CRC8_INIT, frame, PACKET_V2_LENGTH - 1);
+}
+
+ErrorCode Packet_ParseV2(const uint8_t* frame, Packet_V2* packet)
+{
+    if (frame[0] != PACKET_V2_SYNC ||
+        frame[PACKET_V2_LENGTH - 1] != Crc8_Update(CRC8_INIT, frame, PACKET_V2_LENGTH - 1))
+    {
+        return ERROR;
+    }
+    packet->seq = frame[1];
+    packet->timestamp = (uint32_t)frame[2] |
+                        ((uint32_t)frame[3] << 8) |
+                        ((uint32_t)frame[4] << 16) |
+                        ((uint32_t)frame[5] << 24);
+    packet->x = SIGN_EXTEND_12((frame[6] << 4) | (frame[9] >> 4));
+    packet->y = SIGN_EXTEND_12((frame[7] << 4) | (frame[9] & 0x0F));
+    packet->z = SIGN_EXTEND_12((frame[8] << 4) | (frame[10] >> 4));
+    packet->odr = frame[10] & 0x0F;
+    return NO_ERROR;
+}
+
+#define BATCH_SEQ_POS       1
+#define BATCH_TIMESTAMP_POS 3
+#define BATCH_COUNT_POS     7
+#define BATCH_ODR_POS       8
+
+// Samples are packed as nibbles: sample i starts at nibble 9 * i
+#define SAMPLE_NIBBLES      9
+
+static void PutNibbles(uint8_t* data, uint16_t nibble, uint16_t value, uint8_t count)
+{
+    while (count--)
+    {
+        uint8_t bits = (value >> (4 * count)) & 0x0F;
+        if (nibble & 1)
+        {
+            data[nibble >> 1] = (data[nibble >> 1] & 0xF0) | bits;
+        }
+        else
+        {
+            data[nibble >> 1] = (data[nibble >> 1] & 0x0F) | (bits << 4);
+        }
+        nibble++;
+    }
+}
+
+static uint16_t GetNibbles(const uint8_t* data, uint16_t nibble, uint8_t count)
+{
+    uint16_t value = 0;
+    while (count--)
+    {
+        uint8_t byte = data[nibble >> 1];
+        value = (value << 4) | ((nibble & 1) ? (byte & 0x0F) : (byte >> 4));
+        nibble++;
+    }
+    return value;
+}
+
+void Packet_BatchStart(uint8_t* frame, uint16_t seq, uint32_t timestamp, uint8_t odr)
+{
+    frame[0] = PACKET_BATCH_SYNC;
+    frame[BATCH_SEQ_POS] = (uint8_t)seq;
+    frame[BATCH_SEQ_POS + 1] = (uint8_t)(seq >> 8);
+    frame[BATCH_TIMESTAMP_POS] = (uint8_t)timestamp;
+    frame[BATCH_TIMESTAMP_POS + 1] = (uint8_t)(timestamp >> 8);
+    frame[BATCH_TIMESTAMP_POS + 2] = (uint8_t)(timestamp >> 16);
+    frame[BATCH_TIMESTAMP_POS + 3] = (uint8_t)(timestamp >> 24);
+    frame[BATCH_COUNT_POS] = 0;
+    frame[BATCH_ODR_POS] = odr;
+}
+
+uint8_t Packet_BatchAdd(uint8_t* frame, int16_t x, int16_t y, int16_t z)
+{
+    uint8_t count = frame[BATCH_COUNT_POS];
+    uint8_t* data = &frame[PACKET_BATCH_HEADER_LENGTH];
+    uint16_t nibble = (uint16_t)count * SAMPLE_NIBBLES;
+
+    PutNibbles(data, nibble, (uint16_t)x & 0xFFF, 3);
+    PutNibbles(data, nibble + 3, (uint16_t)y & 0xFFF, 3);
+    PutNibbles(data, nibble + 6, (uint16_t)z & 0xFFF, 3);
+    frame[BATCH_COUNT_POS] = ++count;
+    return count;
+}
+
+uint16_t Packet_BatchFinish(uint8_t* frame)
+{
+    uint8_t count = frame[BATCH_COUNT_POS];
+    uint16_t length = PACKET_BATCH_LENGTH(count);
+
+    // Unused low nibble of an odd count
+    if (count & 1)
+    {
+        PutNibbles(&frame[PACKET_BATCH_HEADER_LENGTH], (uint16_t)count * SAMPLE_NIBBLES, 0, 1);
+    }
+    frame[length - 1] = Crc8_Update(CRC8_INIT, frame, length - 1);
+    return length;
+}
+
+ErrorCode Packet_ParseBatch(const uint8_t* frame, uint16_t length, Packet_Batch* batch)
+{
+    const uint8_t* data = &frame[PACKET_BATCH_HEADER_LENGTH];
+    uint8_t count;
+    uint8_t i;
+
+    if (length < PACKET_BATCH_LENGTH(1) || frame[0] != PACKET_BATCH_SYNC)
+    {
+        return ERROR;
+    }
+    count = frame[BATCH_COUNT_POS];
+    if (count == 0 || count > PACKET_BATCH_MAX || length < PACKET_BATCH_LENGTH(count) ||
+        frame[PACKET_BATCH_LENGTH(count) - 1] !=
+            Crc8_Update(CRC8_INIT, frame, PACKET_BATCH_LENGTH(count) - 1))
+    {
+        return ERROR;
+    }
+
+    batch->seq = (uint16_t)(frame[BATCH_SEQ_POS] | (frame[BATCH_SEQ_POS + 1] << 8));
+    batch->timestamp = (uint32_t)frame[BATCH_TIMESTAMP_POS] |
+                       ((uint32_t)frame[BATCH_TIMESTAMP_POS + 1] << 8) |
+                       ((uint32_t)frame[BATCH_TIMESTAMP_POS + 2] << 16) |
+                       ((uint32_t)frame[BATCH_TIMESTAMP_POS + 3] << 24);
+    batch->count = count;
+    batch->odr = frame[BATCH_ODR_POS];
+    for (i = 0; i < count; i++)
+    {
+        uint16_t nibble = (uint16_t)i * SAMPLE_NIBBLES;
+        batch->x[i] = SIGN_EXTEND_12(GetNibbles(data, nibble, 3));
+        batch->y[i] = SIGN_EXTEND_12(GetNibbles(data, nibble + 3, 3));
+        batch->z[i] = SIGN_EXTEND_12(GetNibbles(data, nibble + 6, 3));
+    }
+    return NO_ERROR;
+}
+
+static void PutUint32(uint8_t* data, uint32_t value)
+{
+    data[0] = (uint8_t)value;
+    data[1] = (uint8_t)(value >> 8);
+    data[2] = (uint8_t)(value >> 16);
+    data[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t GetUint32(const uint8_t* data)
+{
+    return (uint32_t)data[0] |
+           ((uint32_t)data[1] << 8) |
+           ((uint32_t)data[2] << 16) |
+           ((uint32_t)data[3] << 24);
+}
+
+// The raw frame has the header of the batch frame
+void Packet_RawStart(uint8_t* frame, uint16_t seq, uint32_t timestamp, uint8_t odr)
+{
+    Packet_BatchStart(frame, seq, timestamp, odr);
+    frame[0] = PACKET_RAW_SYNC;
+}
+
+uint8_t Packet_RawAdd(uint8_t* frame, int16_t x, int16_t y, int16_t z)
+{
+    uint8_t count = frame[BATCH_COUNT_POS];
+    uint8_t* data = &frame[PACKET_BATCH_HEADER_LENGTH + (uint16_t)count * 6];
+
+    data[0] = (uint8_t)x;
+    data[1] = (uint8_t)((uint16_t)x >> 8);
+    data[2] = (uint8_t)y;
+    data[3] = (uint8_t)((uint16_t)y >> 8);
+    data[4] = (uint8_t)z;
+    data[5] = (uint8_t)((uint16_t)z >> 8);
+    frame[BATCH_COUNT_POS] = ++count;
+    return count;
+}
+
+uint16_t Packet_RawFinish(uint8_t* frame)
+{
+    uint16_t length = PACKET_RAW_LENGTH(frame[BATCH_COUNT_POS]);
+
+    frame[length - 1] = Crc8_Update(CRC8_INIT, frame, length - 1);
+    return length;
+}
+
+ErrorCode Packet_ParseRaw(const uint8_t* frame, uint16_t length, Packet_Batch* batch)
+{
+    const uint8_t* data = &frame[PACKET_BATCH_HEADER_LENGTH];
+    uint8_t count;
+    uint8_t i;
+
+    if (length < PACKET_RAW_LENGTH(1) || frame[0] != PACKET_RAW_SYNC)
+    {
+        return ERROR;
+    }
+    count = frame[BATCH_COUNT_POS];
+    if (count == 0 || count > PACKET_BATCH_MAX || length < PACKET_RAW_LENGTH(count) ||
+        frame[PACKET_RAW_LENGTH(count) - 1] !=
+            Crc8_Update(CRC8_INIT, frame, PACKET_RAW_LENGTH(count) - 1))
+    {
+        return ERROR;
+    }
+
+    batch->seq = (uint16_t)(frame[BATCH_SEQ_POS] | (frame[BATCH_SEQ_POS + 1] << 8));
+    batch->timestamp = GetUint32(&frame[BATCH_TIMESTAMP_POS]);
+    batch->count = count;
+    batch->odr = frame[BATCH_ODR_POS];
+    for (i = 0; i < count; i++)
+    {
+        batch->x[i] = (int16_t)(data[0] | data[1] << 8);
+        batch->y[i] = (int16_t)(data[2] | data[3] << 8);
+        batch->z[i] = (int16_t)(data[4] | data[5] << 8);
+        data += 6;
+    }
+    return NO_ERROR;
+}
+
+void Packet_BuildDescriptor(const Packet_Descriptor* descriptor, uint8_t* frame)
+{
+    frame[0] = PACKET_DESCRIPTOR_SYNC;
+    frame[1] = descriptor->odr;
+    frame[2] = descriptor->fs;
+    frame[3] = descriptor->g;
+    frame[4] = descriptor->mode;
+    frame[5] = descriptor->shift;
+    frame[6] = descriptor->mg_per_digit;
+    PutUint32(&frame[7], (uint32_t)descriptor->mms2_q);
+    frame[PACKET_DESCRIPTOR_LENGTH - 1] = Crc8_Update(CRC8_INIT, frame, PACKET_DESCRIPTOR_LENGTH - 1);
+}
+
+ErrorCode Packet_ParseDescriptor(const uint8_t* frame, Packet_Descriptor* descriptor)
+{
+    if (frame[0] != PACKET_DESCRIPTOR_SYNC ||
+        frame[PACKET_DESCRIPTOR_LENGTH - 1] != Crc8_Update(CRC8_INIT, frame, PACKET_DESCRIPTOR_LENGTH - 1))
+    {
+        return ERROR;
+    }
+    descriptor->odr = frame[1];
+    descriptor->fs = frame[2];
+    descriptor->g = frame[3];
+    descriptor->mode = frame[4];
+    descriptor->shift = frame[5];
+    descriptor->mg_per_digit = frame[6];
+    descriptor->mms2_q = (int32_t)GetUint32(&frame[7]);
+    return NO_ERROR;
+}
+
+#define PROFILE_COUNT_POS   1
+#define PROFILE_CLOCK_POS   2
+
+uint16_t Packet_BuildProfile(const Packet_Profile* profile, uint8_t* frame)
+{
+    uint16_t length = PACKET_PROFILE_LENGTH(profile->count);
+    uint8_t* data = &frame[PACKET_PROFILE_HEADER_LENGTH];
+    uint8_t i;
+
+    frame[0] = PACKET_PROFILE_SYNC;
+    frame[PROFILE_COUNT_POS] = profile->count;
+    PutUint32(&frame[PROFILE_CLOCK_POS], profile->cycles_per_ms);
+    for (i = 0; i < profile->count; i++)
+    {
+        PutUint32(&data[0], profile->stages[i].calls);
+        PutUint32(&data[4], profile->stages[i].min);
+        PutUint32(&data[8], profile->stages[i].avg);
+        PutUint32(&data[12], profile->stages[i].max);
+        data += 16;
+    }
+    frame[length - 1] = Crc8_Update(CRC8_INIT, frame, length - 1);
+    return length;
+}
+
+ErrorCode Packet_ParseProfile(const uint8_t* frame, uint16_t length, Packet_Profile* profile)
+{
+    const uint8_t* data = &frame[PACKET_PROFILE_HEADER_LENGTH];
+    uint8_t count;
+    uint8_t i;
+
+    if (length < PACKET_PROFILE_LENGTH(1) || frame[0] != PACKET_PROFILE_SYNC)
+    {
+        return ERROR;
+    }
+    count = frame[PROFILE_COUNT_POS];
+    if (count == 0 || count > PACKET_PROFILE_MAX_STAGES || length < PACKET_PROFILE_LENGTH(count) ||
+        frame[PACKET_PROFILE_LENGTH(count) - 1] !=
+            Crc8_Update(CRC8_INIT, frame, PACKET_PROFILE_LENGTH(count) - 1))
+    {
+        return ERROR;
+    }
+
+    profile->count = count;
+    profile->cycles_per_ms = GetUint32(&frame[PROFILE_CLOCK_POS]);
+    for (i = 0; i < count; i++)
+    {
+        profile->stages[i].calls = GetUint32(&data[0]);
+        profile->stages[i].min = GetUint32(&data[4]);
+        profile->stages[i].avg = GetUint32(&data[8]);
+        profile->stages[i].max = GetUint32(&data[12]);
+        data += 16;
+    }
+    return NO_ERROR;
+}
+
+#define HEALTH_VERSION_POS   1
+#define HEALTH_TIMESTAMP_POS 2
+#define HEALTH_ODR_POS       6
+#define HEALTH_COUNTERS_POS  7
+
+void Packet_BuildHealth(const Packet_Health* health, uint8_t* frame)
+{
+    uint8_t* data = &frame[HEALTH_COUNTERS_POS];
+
+    frame[0] = PACKET_HEALTH_SYNC;
+    frame[HEALTH_VERSION_POS] = PACKET_HEALTH_VERSION;
+    PutUint32(&frame[HEALTH_TIMESTAMP_POS], health->timestamp);
+    frame[HEALTH_ODR_POS] = health->odr;
+    PutUint32(&data[0], health->samples);
+    PutUint32(&data[4], health->stale);
+    PutUint32(&data[8], health->overrun_x);
+    PutUint32(&data[12], health->overrun_y);
+    PutUint32(&data[16], health->overrun_z);
+    PutUint32(&data[20], health->overruns);
+    PutUint32(&data[24], health->fifo_overruns);
+    PutUint32(&data[28], health->read_errors);
+    PutUint32(&data[32], health->wakeups);
+    PutUint32(&data[36], health->sleep_ms);
+    PutUint32(&data[40], health->button_drops);
+    frame[PACKET_HEALTH_LENGTH - 1] = Crc8_Update(CRC8_INIT, frame, PACKET_HEALTH_LENGTH - 1);
+}
+
+ErrorCode Packet_ParseHealth(const uint8_t* frame, Packet_Health* health)
+{
+    const uint8_t* data = &frame[HEALTH_COUNTERS_POS];
+
+    if (frame[0] != PACKET_HEALTH_SYNC || frame[HEALTH_VERSION_POS] != PACKET_HEALTH_VERSION ||
+        frame[PACKET_HEALTH_LENGTH - 1] != Crc8_Update(CRC8_INIT, frame, PACKET_HEALTH_LENGTH - 1))
+    {
+        return ERROR;
+    }
+    health->timestamp = GetUint32(&frame[HEALTH_TIMESTAMP_POS]);
+    health->odr = frame[HEALTH_ODR_POS];
+    health->samples = GetUint32(&data[0]);
+    health->stale = GetUint32(&data[4]);
+    health->overrun_x = GetUint32(&data[8]);
+    health->overrun_y = GetUint32(&data[12]);
+    health->overrun_z = GetUint32(&data[16]);
+    health->overruns = GetUint32(&data[20]);
+    health->fifo_overruns = GetUint32(&data[24]);
+    health->read_errors = GetUint32(&data[28]);
+    health->wakeups = GetUint32(&data[32]);
+    health->sleep_ms = GetUint32(&data[36]);
+    health->button_drops = GetUint32(&data[40]);
+    return NO_ERROR;
+}
+
+/* [] END OF FILE */
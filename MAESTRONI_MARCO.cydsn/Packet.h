@@ -0,0 +1,424 @@
+/**
+*   \file Packet.h
+*   \brief Binary frames sent over UART.
+*
+*   Version 2 frame (PACKET_V2_LENGTH bytes):
+*
+*   | Byte  | Content                                           |
+*   |-------|---------------------------------------------------|
+*   | 0     | sync, PACKET_V2_SYNC                              |
+*   | 1     | sequence number, +1 at every frame                |
+*   | 2..5  | timestamp of the sample in ms, little endian      |
+*   | 6     | X[11:4]                                           |
+*   | 7     | Y[11:4]                                           |
+*   | 8     | Z[11:4]                                           |
+*   | 9     | X[3:0] << 4, Y[3:0]                               |
+*   | 10    | Z[3:0] << 4, ODR code (index in LIS3DH_OdrTable)  |
+*   | 11    | CRC-8 (Crc8.h) of bytes 0 ... 10                  |
+*
+*   The three 12-bit raw outputs take 4.5 bytes; the high bytes come
+*   first so that a plotter reading bytes 6 ... 8 as signed 8-bit values
+*   gets every axis with 16 digits resolution. The frame carries no
+*   full-scale range: the digits are the 1 mg ones of the +-2 g range,
+*   the only one allowed with this frame and the batch frame
+*   (AcquisitionConfig.h). The Bridge Control Panel configuration thus
+*   plots 16 mg/digit, against the 1 mg/digit of the version 1 frames;
+*   the full resolution needs the host decoder.
+*
+*   Batch frame (PACKET_BATCH_LENGTH(count) bytes), count samples with
+*   one header and one CRC:
+*
+*   | Byte  | Content                                             |
+*   |-------|-----------------------------------------------------|
+*   | 0     | sync, PACKET_BATCH_SYNC                             |
+*   | 1..2  | sequence number of the first sample, little endian  |
+*   | 3..6  | timestamp of the first sample in ms                 |
+*   | 7     | count, 1 ... PACKET_BATCH_MAX                       |
+*   | 8     | ODR code (index in LIS3DH_OdrTable)                 |
+*   | 9..   | samples, 9 nibbles each: X, Y, Z, high nibble first |
+*   | last  | CRC-8 of all the previous bytes                     |
+*
+*   The sequence number counts samples, so that the receiver can tell
+*   how many were lost; the samples of a frame are one ODR period apart.
+*
+*   Raw frame (PACKET_RAW_LENGTH(count) bytes), the batch frame with the
+*   output words as read from OUT_X_L ... OUT_Z_H, left-justified and not
+*   converted: the receiver converts them with the descriptor frame.
+*
+*   | Byte  | Content                                             |
+*   |-------|-----------------------------------------------------|
+*   | 0     | sync, PACKET_RAW_SYNC                               |
+*   | 1..8  | as in the batch frame                               |
+*   | 9..   | samples, 6 bytes each: X, Y, Z little endian        |
+*   | last  | CRC-8 of all the previous bytes                     |
+*
+*   Descriptor frame (PACKET_DESCRIPTOR_LENGTH bytes), what the receiver
+*   needs to convert the raw frames of a data rate:
+*
+*   | Byte  | Content                                             |
+*   |-------|-----------------------------------------------------|
+*   | 0     | sync, PACKET_DESCRIPTOR_SYNC                        |
+*   | 1     | ODR code (index in LIS3DH_OdrTable)                 |
+*   | 2     | full-scale range, FS[1:0]                           |
+*   | 3     | full-scale range in g                               |
+*   | 4     | operating mode, LIS3DH_MODE_ (LIS3DH_Convert.h)     |
+*   | 5     | right shift of the output words                     |
+*   | 6     | sensitivity in mg/digit                             |
+*   | 7..10 | mm/s^2 per digit, Q16, little endian                |
+*   | 11    | CRC-8 of bytes 0 ... 10                             |
+*
+*   Profile frame (PACKET_PROFILE_LENGTH(count) bytes), the time spent in
+*   count stages of the main loop (Profile.h), sent besides the samples:
+*
+*   | Byte  | Content                                             |
+*   |-------|-----------------------------------------------------|
+*   | 0     | sync, PACKET_PROFILE_SYNC                           |
+*   | 1     | count of stages, 1 ... PACKET_PROFILE_MAX_STAGES    |
+*   | 2..5  | CPU clock cycles per ms, little endian              |
+*   | 6..   | per stage, 4 bytes each little endian: calls,       |
+*   |       | minimum, average and maximum cycles of a call       |
+*   | last  | CRC-8 of all the previous bytes                     |
+*
+*   Health frame (PACKET_HEALTH_LENGTH bytes), the loss and power
+*   counters of the acquisition since startup (Health.h), sent besides
+*   the samples. The version gives the layout, and so the length: a
+*   receiver rejects the versions it does not know.
+*
+*   | Byte  | Content                                             |
+*   |-------|-----------------------------------------------------|
+*   | 0     | sync, PACKET_HEALTH_SYNC                            |
+*   | 1     | layout version, PACKET_HEALTH_VERSION               |
+*   | 2..5  | time of the frame in ms, little endian              |
+*   | 6     | ODR code (index in LIS3DH_OdrTable)                 |
+*   | 7..50 | 4 bytes each little endian: samples read, stale     |
+*   |       | reads, X, Y, Z and ZYX overruns, FIFO overruns,     |
+*   |       | failed reads, wake-ups, ms asleep (Power.h), button |
+*   |       | events dropped (Button.h)                           |
+*   | 51    | CRC-8 of bytes 0 ... 50                             |
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __PACKET_H
+    #define __PACKET_H
+
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+
+    /**
+    *   \brief First byte of a version 2 frame.
+    */
+    #define PACKET_V2_SYNC   0xA2
+
+    /**
+    *   \brief Bytes of a version 2 frame.
+    */
+    #define PACKET_V2_LENGTH 12
+
+    /**
+    *   \brief Full-scale range in g of the version 2 and batch frames, the
+    *   only one they are sent at (AcquisitionConfig.h).
+    */
+    #define PACKET_V2_FULL_SCALE_G 2
+
+    /**
+    *   \brief Sensitivity in mg/digit of the 12-bit outputs of the version
+    *   2 and batch frames.
+    */
+    #define PACKET_V2_MG_PER_DIGIT 1
+
+    /**
+    *   \brief First byte of a batch frame.
+    */
+    #define PACKET_BATCH_SYNC   0xA3
+
+    /**
+    *   \brief Maximum number of samples of a batch frame.
+    */
+    #define PACKET_BATCH_MAX    32
+
+    /**
+    *   \brief Bytes of the batch frame header.
+    */
+    #define PACKET_BATCH_HEADER_LENGTH 9
+
+    /**
+    *   \brief Bytes of a batch frame of count samples.
+    */
+    #define PACKET_BATCH_LENGTH(count) (PACKET_BATCH_HEADER_LENGTH + ((count) * 9 + 1) / 2 + 1)
+
+    /**
+    *   \brief First byte of a raw frame.
+    */
+    #define PACKET_RAW_SYNC 0xA6
+
+    /**
+    *   \brief Bytes of a raw frame of count samples.
+    */
+    #define PACKET_RAW_LENGTH(count) (PACKET_BATCH_HEADER_LENGTH + (count) * 6 + 1)
+
+    /**
+    *   \brief First byte of a descriptor frame.
+    */
+    #define PACKET_DESCRIPTOR_SYNC 0xA7
+
+    /**
+    *   \brief Bytes of a descriptor frame.
+    */
+    #define PACKET_DESCRIPTOR_LENGTH 12
+
+    /**
+    *   \brief First byte of a profile frame.
+    */
+    #define PACKET_PROFILE_SYNC 0xA4
+
+    /**
+    *   \brief Maximum number of stages of a profile frame.
+    */
+    #define PACKET_PROFILE_MAX_STAGES 8
+
+    /**
+    *   \brief Bytes of the profile frame header.
+    */
+    #define PACKET_PROFILE_HEADER_LENGTH 6
+
+    /**
+    *   \brief Bytes of a profile frame of count stages.
+    */
+    #define PACKET_PROFILE_LENGTH(count) (PACKET_PROFILE_HEADER_LENGTH + (count) * 16 + 1)
+
+    /**
+    *   \brief First byte of a health frame.
+    */
+    #define PACKET_HEALTH_SYNC 0xA5
+
+    /**
+    *   \brief Layout version of the health frames, raised at every change
+    *   of their content.
+    */
+    #define PACKET_HEALTH_VERSION 3
+
+    /**
+    *   \brief Bytes of a health frame of PACKET_HEALTH_VERSION.
+    */
+    #define PACKET_HEALTH_LENGTH 52
+
+    /**
+    *   \brief Content of a version 2 frame.
+    */
+    typedef struct {
+        uint8_t seq;            ///< Sequence number
+        uint32_t timestamp;     ///< Time of the sample in ms
+        int16_t x;              ///< X axis, 12-bit right-justified raw output
+        int16_t y;              ///< Y axis, 12-bit right-justified raw output
+        int16_t z;              ///< Z axis, 12-bit right-justified raw output
+        uint8_t odr;            ///< Index of the data rate in LIS3DH_OdrTable
+    } Packet_V2;
+
+    /**
+    *   \brief Content of a batch frame.
+    */
+    typedef struct {
+        uint16_t seq;                   ///< Sequence number of the first sample
+        uint32_t timestamp;             ///< Time of the first sample in ms
+        uint8_t count;                  ///< Number of samples
+        uint8_t odr;                    ///< Index of the data rate in LIS3DH_OdrTable
+        int16_t x[PACKET_BATCH_MAX];    ///< X axis, 12-bit right-justified raw outputs
+        int16_t y[PACKET_BATCH_MAX];    ///< Y axis, 12-bit right-justified raw outputs
+        int16_t z[PACKET_BATCH_MAX];    ///< Z axis, 12-bit right-justified raw outputs
+    } Packet_Batch;
+
+    /**
+    *   \brief Content of a descriptor frame.
+    */
+    typedef struct {
+        uint8_t odr;            ///< Index of the data rate in LIS3DH_OdrTable
+        uint8_t fs;             ///< Full-scale range, FS[1:0]
+        uint8_t g;              ///< Full-scale range in g
+        uint8_t mode;           ///< Operating mode, LIS3DH_MODE_
+        uint8_t shift;          ///< Right shift of the output words
+        uint8_t mg_per_digit;   ///< Sensitivity in mg/digit
+        int32_t mms2_q;         ///< mm/s^2 per digit, Q16
+    } Packet_Descriptor;
+
+    /**
+    *   \brief Time spent in one stage, in CPU clock cycles.
+    */
+    typedef struct {
+        uint32_t calls;         ///< Times the stage was run
+        uint32_t min;           ///< Shortest run
+        uint32_t avg;           ///< Average run
+        uint32_t max;           ///< Longest run
+    } Packet_ProfileStage;
+
+    /**
+    *   \brief Content of a profile frame.
+    */
+    typedef struct {
+        uint8_t count;                  ///< Number of stages
+        uint32_t cycles_per_ms;         ///< CPU clock cycles per ms
+        Packet_ProfileStage stages[PACKET_PROFILE_MAX_STAGES]; ///< Stages, in the order of Profile.h
+    } Packet_Profile;
+
+    /**
+    *   \brief Content of a health frame.
+    */
+    typedef struct {
+        uint32_t timestamp;     ///< Time of the frame in ms
+        uint8_t odr;            ///< Index of the data rate in LIS3DH_OdrTable
+        uint32_t samples;       ///< Samples read with new data
+        uint32_t stale;         ///< Reads that found no new data
+        uint32_t overrun_x;     ///< Reads with XOR set
+        uint32_t overrun_y;     ///< Reads with YOR set
+        uint32_t overrun_z;     ///< Reads with ZOR set
+        uint32_t overruns;      ///< Reads with ZYXOR set: at least one sample lost each
+        uint32_t fifo_overruns; ///< FIFO drains finding the FIFO full (OVRN_FIFO)
+        uint32_t read_errors;   ///< Sample reads, FIFO drains or rate changes failed on the I2C bus
+        uint32_t wakeups;       ///< Times the CPU woke up from a sleep
+        uint32_t sleep_ms;      ///< Time spent asleep, measured with ACQ_LOW_POWER only
+        uint32_t button_drops;  ///< Button events dropped with the ring full
+    } Packet_Health;
+
+    /**
+    *   \brief Build a version 2 frame.
+    *
+    *   \param packet Content of the frame.
+    *   \param frame Array of PACKET_V2_LENGTH bytes where the frame will be saved.
+    */
+    void Packet_BuildV2(const Packet_V2* packet, uint8_t* frame);
+
+    /**
+    *   \brief Decode a version 2 frame.
+    *
+    *   \param frame PACKET_V2_LENGTH bytes.
+    *   \param packet Pointer to the structure where the content will be saved.
+    *   \retval ERROR if the sync byte or the CRC are wrong.
+    */
+    ErrorCode Packet_ParseV2(const uint8_t* frame, Packet_V2* packet);
+
+    /**
+    *   \brief Start a batch frame with no samples.
+    *
+    *   The samples are packed in the frame as they are added, so that
+    *   no copy is needed when it is sent.
+    *   \param frame Array of PACKET_BATCH_LENGTH(PACKET_BATCH_MAX) bytes.
+    *   \param seq Sequence number of the first sample.
+    *   \param timestamp Time of the first sample in ms.
+    *   \param odr Index of the data rate in LIS3DH_OdrTable.
+    */
+    void Packet_BatchStart(uint8_t* frame, uint16_t seq, uint32_t timestamp, uint8_t odr);
+
+    /**
+    *   \brief Add a sample to a batch frame.
+    *
+    *   \param x, y, z 12-bit right-justified raw outputs.
+    *   \retval Number of samples in the frame.
+    */
+    uint8_t Packet_BatchAdd(uint8_t* frame, int16_t x, int16_t y, int16_t z);
+
+    /**
+    *   \brief Complete a batch frame with its CRC.
+    *   \retval Bytes of the frame to be sent.
+    */
+    uint16_t Packet_BatchFinish(uint8_t* frame);
+
+    /**
+    *   \brief Decode a batch frame.
+    *
+    *   \param frame The frame, starting from the sync byte.
+    *   \param length Bytes available in frame.
+    *   \param batch Pointer to the structure where the content will be saved.
+    *   \retval ERROR if the sync byte, the count, the length or the CRC are wrong.
+    */
+    ErrorCode Packet_ParseBatch(const uint8_t* frame, uint16_t length, Packet_Batch* batch);
+
+    /**
+    *   \brief Start a raw frame with no samples.
+    *
+    *   \param frame Array of PACKET_RAW_LENGTH(PACKET_BATCH_MAX) bytes.
+    *   \param seq Sequence number of the first sample.
+    *   \param timestamp Time of the first sample in ms.
+    *   \param odr Index of the data rate in LIS3DH_OdrTable.
+    */
+    void Packet_RawStart(uint8_t* frame, uint16_t seq, uint32_t timestamp, uint8_t odr);
+
+    /**
+    *   \brief Add a sample to a raw frame.
+    *
+    *   \param x, y, z Left-justified output words.
+    *   \retval Number of samples in the frame.
+    */
+    uint8_t Packet_RawAdd(uint8_t* frame, int16_t x, int16_t y, int16_t z);
+
+    /**
+    *   \brief Complete a raw frame with its CRC.
+    *   \retval Bytes of the frame to be sent.
+    */
+    uint16_t Packet_RawFinish(uint8_t* frame);
+
+    /**
+    *   \brief Decode a raw frame.
+    *
+    *   \param frame The frame, starting from the sync byte.
+    *   \param length Bytes available in frame.
+    *   \param batch Pointer to the structure where the content will be
+    *   saved; x, y and z are the left-justified output words.
+    *   \retval ERROR if the sync byte, the count, the length or the CRC are wrong.
+    */
+    ErrorCode Packet_ParseRaw(const uint8_t* frame, uint16_t length, Packet_Batch* batch);
+
+    /**
+    *   \brief Build a descriptor frame.
+    *
+    *   \param descriptor Content of the frame.
+    *   \param frame Array of PACKET_DESCRIPTOR_LENGTH bytes where the frame will be saved.
+    */
+    void Packet_BuildDescriptor(const Packet_Descriptor* descriptor, uint8_t* frame);
+
+    /**
+    *   \brief Decode a descriptor frame.
+    *
+    *   \param frame PACKET_DESCRIPTOR_LENGTH bytes.
+    *   \param descriptor Pointer to the structure where the content will be saved.
+    *   \retval ERROR if the sync byte or the CRC are wrong.
+    */
+    ErrorCode Packet_ParseDescriptor(const uint8_t* frame, Packet_Descriptor* descriptor);
+
+    /**
+    *   \brief Build a profile frame.
+    *
+    *   \param profile Content of the frame.
+    *   \param frame Array of PACKET_PROFILE_LENGTH(profile->count) bytes.
+    *   \retval Bytes of the frame to be sent.
+    */
+    uint16_t Packet_BuildProfile(const Packet_Profile* profile, uint8_t* frame);
+
+    /**
+    *   \brief Decode a profile frame.
+    *
+    *   \param frame The frame, starting from the sync byte.
+    *   \param length Bytes available in frame.
+    *   \param profile Pointer to the structure where the content will be saved.
+    *   \retval ERROR if the sync byte, the count, the length or the CRC are wrong.
+    */
+    ErrorCode Packet_ParseProfile(const uint8_t* frame, uint16_t length, Packet_Profile* profile);
+
+    /**
+    *   \brief Build a health frame.
+    *
+    *   \param health Content of the frame.
+    *   \param frame Array of PACKET_HEALTH_LENGTH bytes where the frame will be saved.
+    */
+    void Packet_BuildHealth(const Packet_Health* health, uint8_t* frame);
+
+    /**
+    *   \brief Decode a health frame.
+    *
+    *   \param frame PACKET_HEALTH_LENGTH bytes.
+    *   \param health Pointer to the structure where the content will be saved.
+    *   \retval ERROR if the sync byte, the version or the CRC are wrong.
+    */
+    ErrorCode Packet_ParseHealth(const uint8_t* frame, Packet_Health* health);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,39 @@
+/*
+* MARCO MAESTRONI
+*
+* Sleep of the main loop between the interrupts
+*/
+
+#include "Power.h"
+#include "AcquisitionConfig.h"
+#include "Timebase.h"
+#include "Hal.h"
+
+static Power_Stats stats;
+
+#if ACQ_LOW_POWER
+// Cycles asleep not yet accounted in whole milliseconds
+static uint32_t sleep_cycles;
+#endif
+
+void Power_Sleep(uint32_t max_ms)
+{
+#if ACQ_LOW_POWER
+    uint32_t cycles_per_ms = Timebase_CyclesPerMs();
+
+    sleep_cycles += Timebase_Sleep(max_ms);
+    stats.sleep_ms += sleep_cycles / cycles_per_ms;
+    sleep_cycles %= cycles_per_ms;
+#else
+    (void)max_ms;
+    Hal_WaitForInterrupt();
+#endif
+    stats.wakeups++;
+}
+
+void Power_GetStats(Power_Stats* copy)
+{
+    *copy = stats;
+}
+
+/* [] END OF FILE */
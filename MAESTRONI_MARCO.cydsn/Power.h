@@ -0,0 +1,50 @@
+/**
+*   \file Power.h
+*   \brief Sleep of the main loop between the interrupts.
+*
+*   With ACQ_LOW_POWER the CPU sleeps with the millisecond tick stopped
+*   (Timebase_Sleep), so that it is only woken up by INT1, the push button
+*   or ACQ_LOW_POWER_MAX_SLEEP_MS elapsing; otherwise it sleeps until the
+*   next interrupt, the tick included. The wake-ups and, with
+*   ACQ_LOW_POWER, the time spent asleep are counted, for the duty cycle
+*   reported in the health frames.
+*
+*   The PSoC stays in Active mode with the CPU halted (WFI): in Sleep or
+*   Alternate Active mode the clocks of the UART and of SysTick stop,
+*   which would break the frames being sent and the time base.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __POWER_H
+    #define __POWER_H
+
+    #include "cytypes.h"
+
+    /**
+    *   \brief Wake-up and sleep counters since startup.
+    */
+    typedef struct {
+        uint32_t wakeups;   ///< Times the CPU woke up from a sleep
+        uint32_t sleep_ms;  ///< Time spent asleep (ACQ_LOW_POWER only)
+    } Power_Stats;
+
+    /**
+    *   \brief Sleep until an interrupt is pending.
+    *
+    *   To be called with the interrupts disabled, after checking that
+    *   there is nothing to do: an interrupt raised in between wakes up
+    *   the CPU anyway.
+    *   \param max_ms Longest sleep with ACQ_LOW_POWER; below 2 the tick
+    *   is not stopped.
+    */
+    void Power_Sleep(uint32_t max_ms);
+
+    /**
+    *   \brief Copy the counters.
+    *   \param stats Pointer to the structure where the counters will be saved.
+    */
+    void Power_GetStats(Power_Stats* stats);
+
+#endif
+/* [] END OF FILE */
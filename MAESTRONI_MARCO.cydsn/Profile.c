@@ -0,0 +1,110 @@
+/*
+* MARCO MAESTRONI
+*
+* Cycle-accurate profiling of the main loop stages
+*/
+
+#include "Profile.h"
+#include "Timebase.h"
+#include "UartTx.h"
+
+// Empty laps timed to measure the cost of a record
+#define PROFILE_CALIBRATION_LAPS 8
+
+typedef struct {
+    uint32_t calls;
+    uint32_t min;
+    uint32_t max;
+    uint32_t sum;
+} Profile_Entry;
+
+static Profile_Entry table[PROFILE_STAGES];
+static uint32_t overhead;
+static uint32_t window_start;
+
+static void Clear(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < PROFILE_STAGES; i++)
+    {
+        table[i].calls = 0;
+        table[i].min = UINT32_MAX;
+        table[i].max = 0;
+        table[i].sum = 0;
+    }
+    window_start = Timebase_GetMs();
+}
+
+void Profile_Start(void)
+{
+    uint8_t i;
+
+    Hal_CycleCounterStart();
+
+    // The shortest empty lap is what reading the counter costs
+    overhead = 0;
+    Clear();
+    for (i = 0; i < PROFILE_CALIBRATION_LAPS; i++)
+    {
+        Profile_Lap(PROFILE_STAGE_I2C_READ, Hal_CycleCounter());
+    }
+    overhead = table[PROFILE_STAGE_I2C_READ].min;
+    Clear();
+}
+
+uint32_t Profile_Lap(Profile_Stage stage, uint32_t start)
+{
+    uint32_t cycles = Hal_CycleCounter() - start;
+    Profile_Entry* entry = &table[stage];
+
+    cycles = cycles > overhead ? cycles - overhead : 0;
+    entry->calls++;
+    // No overflow within a window of up to a minute at 64 MHz
+    entry->sum += cycles;
+    if (cycles < entry->min)
+    {
+        entry->min = cycles;
+    }
+    if (cycles > entry->max)
+    {
+        entry->max = cycles;
+    }
+    // Read again: the accounting is not charged to the next stage
+    return Hal_CycleCounter();
+}
+
+void Profile_Get(Packet_Profile* profile)
+{
+    uint8_t i;
+
+    profile->count = PROFILE_STAGES;
+    profile->cycles_per_ms = Timebase_CyclesPerMs();
+    for (i = 0; i < PROFILE_STAGES; i++)
+    {
+        Packet_ProfileStage* stage = &profile->stages[i];
+
+        stage->calls = table[i].calls;
+        stage->min = table[i].calls ? table[i].min : 0;
+        stage->avg = table[i].calls ? table[i].sum / table[i].calls : 0;
+        stage->max = table[i].max;
+    }
+}
+
+void Profile_Task(void)
+{
+    Packet_Profile profile;
+    uint8_t* frame;
+
+    if (Timebase_GetMs() - window_start < ACQ_PROFILE_PERIOD_MS)
+    {
+        return;
+    }
+
+    Profile_Get(&profile);
+    frame = UartTx_Reserve();
+    UartTx_Commit(frame, Packet_BuildProfile(&profile, frame));
+    Clear();
+}
+
+/* [] END OF FILE */
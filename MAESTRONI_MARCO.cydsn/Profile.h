@@ -0,0 +1,89 @@
+/**
+*   \file Profile.h
+*   \brief Cycle-accurate profiling of the main loop stages.
+*
+*   With ACQ_PROFILE enabled the stages of the acquisition loop are timed
+*   with the CPU cycle counter (DWT CYCCNT on the PSoC 5LP), and their
+*   number of calls, minimum, average and maximum cycles are sent in a
+*   profile frame (Packet.h) every ACQ_PROFILE_PERIOD_MS, between the
+*   sample frames. The cost of reading the counter is measured once and
+*   taken off every record; the interrupts served during a stage are
+*   counted in it.
+*
+*   A stage is timed by taking a start point and then recording a lap at
+*   the end of each stage, the end of one being the start of the next:
+*
+*       PROFILE_START(cycles);
+*       ...
+*       PROFILE_LAP(PROFILE_STAGE_BUILD, cycles);
+*
+*   With ACQ_PROFILE set to 0 both macros expand to nothing.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __PROFILE_H
+    #define __PROFILE_H
+
+    #include "cytypes.h"
+    #include "AcquisitionConfig.h"
+    #include "Hal.h"
+    #include "Packet.h"
+
+    /**
+    *   \brief Stages of the main loop.
+    */
+    typedef enum {
+        PROFILE_STAGE_I2C_READ,     ///< Sample or FIFO read from the LIS3DH
+        PROFILE_STAGE_CONVERT,      ///< Conversion of the outputs for the frame
+        PROFILE_STAGE_RESERVE,      ///< Slot taken from the UART transmit ring
+        PROFILE_STAGE_BUILD,        ///< Frame built in its slot
+        PROFILE_STAGE_ENQUEUE,      ///< Frame queued on the UART
+        PROFILE_STAGES
+    } Profile_Stage;
+
+    /**
+    *   \brief Names of the stages, in the order of Profile_Stage.
+    */
+    #define PROFILE_STAGE_NAMES { "i2c read", "convert", "reserve", "build", "enqueue" }
+
+    /**
+    *   \brief Start the cycle counter, measure its overhead and clear the table.
+    */
+    void Profile_Start(void);
+
+    /**
+    *   \brief Record the cycles of a stage from start to now.
+    *
+    *   \param stage Stage ended.
+    *   \param start Cycle counter at the start of the stage.
+    *   \retval Cycle counter now, the start of the next stage.
+    */
+    uint32_t Profile_Lap(Profile_Stage stage, uint32_t start);
+
+    /**
+    *   \brief Copy the table of the current window.
+    *   \param profile Pointer to the structure where the table will be saved.
+    */
+    void Profile_Get(Packet_Profile* profile);
+
+    /**
+    *   \brief Send the table in a profile frame and clear it, once
+    *   ACQ_PROFILE_PERIOD_MS have elapsed.
+    *
+    *   To be called at every main loop pass.
+    */
+    void Profile_Task(void);
+
+    #if ACQ_PROFILE
+        #define PROFILE_START(cycles) \
+            uint32_t cycles = Hal_CycleCounter()
+        #define PROFILE_LAP(stage, cycles) \
+            cycles = Profile_Lap((stage), (cycles))
+    #else
+        #define PROFILE_START(cycles)
+        #define PROFILE_LAP(stage, cycles)
+    #endif
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,67 @@
+/*
+* MARCO MAESTRONI
+*
+* Millisecond time base on the SysTick timer
+*/
+
+#include "Timebase.h"
+#include "Hal.h"
+
+static volatile uint32_t milliseconds;
+static Hal_Handler tick_handler;
+
+static void Timebase_Tick(void)
+{
+    milliseconds++;
+    if (tick_handler != NULL)
+    {
+        tick_handler();
+    }
+}
+
+void Timebase_Start(void)
+{
+    Hal_TickStart(Timebase_Tick);
+}
+
+void Timebase_SetTickHandler(Hal_Handler handler)
+{
+    tick_handler = handler;
+}
+
+uint32_t Timebase_GetMs(void)
+{
+    return milliseconds;
+}
+
+uint32_t Timebase_GetCycles(void)
+{
+    uint32_t ms;
+    uint32_t elapsed;
+
+    // read again if the millisecond tick happened in between
+    do
+    {
+        ms = milliseconds;
+        elapsed = Hal_TickElapsedCycles();
+    }
+    while (ms != milliseconds);
+
+    return ms * Hal_TickPeriodCycles() + elapsed;
+}
+
+uint32_t Timebase_CyclesPerMs(void)
+{
+    return Hal_TickPeriodCycles();
+}
+
+uint32_t Timebase_Sleep(uint32_t max_ms)
+{
+    uint32_t cycles;
+
+    // The tick handler cannot run in between: the interrupts are disabled
+    milliseconds += Hal_SleepTickless(max_ms, &cycles);
+    return cycles;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,62 @@
+/**
+*   \file Timebase.h
+*   \brief Millisecond time base.
+*
+*   The tick of the HAL (SysTick on the PSoC) interrupts every millisecond
+*   and increments a 32-bit counter used to time-stamp and rate the
+*   acquisition. The cycles elapsed since the last tick give the time
+*   within the millisecond, to measure short code paths.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __TIMEBASE_H
+    #define __TIMEBASE_H
+
+    #include "cytypes.h"
+    #include "Hal.h"
+
+    /**
+    *   \brief Start the SysTick timer and the millisecond counter.
+    */
+    void Timebase_Start(void);
+
+    /**
+    *   \brief Call handler from the tick interrupt, after the counter is
+    *   incremented.
+    *
+    *   The handler is not called for the milliseconds slept with the tick
+    *   stopped (Timebase_Sleep).
+    */
+    void Timebase_SetTickHandler(Hal_Handler handler);
+
+    /**
+    *   \brief Milliseconds elapsed since Timebase_Start.
+    */
+    uint32_t Timebase_GetMs(void);
+
+    /**
+    *   \brief CPU clock cycles elapsed since Timebase_Start.
+    *
+    *   The count wraps around: only differences between two readings are
+    *   meaningful.
+    */
+    uint32_t Timebase_GetCycles(void);
+
+    /**
+    *   \brief CPU clock cycles per millisecond.
+    */
+    uint32_t Timebase_CyclesPerMs(void);
+
+    /**
+    *   \brief Sleep with the tick stopped until another interrupt, for at
+    *   most max_ms milliseconds.
+    *
+    *   The milliseconds elapsed while sleeping are added to the counter
+    *   on wake-up. To be called with the interrupts disabled.
+    *   \retval CPU clock cycles spent asleep.
+    */
+    uint32_t Timebase_Sleep(uint32_t max_ms);
+
+#endif
+/* [] END OF FILE */
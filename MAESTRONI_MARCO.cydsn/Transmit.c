@@ -0,0 +1,305 @@
+/*
+* MARCO MAESTRONI
+*
+* Frames sent to the Bridge Control Panel or to the host decoder
+*/
+
+#include "Transmit.h"
+#include "Packet.h"
+#include "LIS3DH_Odr.h"
+#include "LIS3DH_Convert.h"
+#include "UartTx.h"
+#include "Timebase.h"
+#include "Profile.h"
+
+static Transmit_Stats stats;
+static uint8_t odr_index;
+
+// Queue a frame built in a slot of the transmit ring
+static void Send(uint8_t* frame, uint16_t length, uint8_t samples)
+{
+    UartTx_Commit(frame, length);
+    stats.frames++;
+    stats.samples += samples;
+    stats.bytes += length;
+}
+
+#if ACQ_PACKET_FORMAT == ACQ_PACKET_FORMAT_V1
+
+void Transmit_Start(void)
+{
+    UartTx_Start();
+    Transmit_ResetStats();
+}
+
+// Sensitivity of the range and operating mode of the current data rate
+static const LIS3DH_Sensitivity* sensitivity =
+    &LIS3DH_SensitivityTable[LIS3DH_FULL_SCALE_SELECTED][LIS3DH_MODE_HIGH_RESOLUTION];
+
+void Transmit_SetOdr(uint8_t odr)
+{
+    odr_index = odr;
+    sensitivity = &LIS3DH_SensitivityTable[LIS3DH_FULL_SCALE_SELECTED]
+                                          [LIS3DH_OdrMode(&LIS3DH_OdrTable[odr])];
+}
+
+// m/s^2 x 1000 fit the int16 of the frame up to +-2 g: larger ranges saturate
+static int16 ConvertAxis(int16_t raw)
+{
+    int32_t mms2 = LIS3DH_ConvertMms2(sensitivity, raw);
+
+    if (mms2 > INT16_MAX)
+    {
+        return INT16_MAX;
+    }
+    if (mms2 < INT16_MIN)
+    {
+        return INT16_MIN;
+    }
+    return (int16)mms2;
+}
+
+static void AddSample(const LIS3DH_Sample* sample, uint32_t timestamp)
+{
+    //the outputs are sent in m/s^2 x 1000 (mm/s^2), so that the BCP receives
+    //int values to rescale. The conversion is done in fixed point
+    //(LIS3DH_Convert.h): the Cortex-M3 has no FPU
+    PROFILE_START(cycles);
+    uint8_t* OutArray = UartTx_Reserve();
+    int16 XDataOut, YDataOut, ZDataOut;
+
+    PROFILE_LAP(PROFILE_STAGE_RESERVE, cycles);
+    (void)timestamp;
+
+    //XDataOut, YDataOut and ZDataOut are left-justified: 8, 10 or 12 bit
+    //long depending on the operating mode
+    XDataOut = ConvertAxis(sample->x);
+    YDataOut = ConvertAxis(sample->y);
+    ZDataOut = ConvertAxis(sample->z);
+    PROFILE_LAP(PROFILE_STAGE_CONVERT, cycles);
+
+    OutArray[0] = 0xA0;
+    OutArray[1] = (uint8_t)(XDataOut & 0xFF);
+    OutArray[2] = (uint8_t)(XDataOut >> 8);
+    OutArray[3] = (uint8_t)(YDataOut & 0xFF);
+    OutArray[4] = (uint8_t)(YDataOut >> 8);
+    OutArray[5] = (uint8_t)(ZDataOut & 0xFF);
+    OutArray[6] = (uint8_t)(ZDataOut >> 8);
+    OutArray[7] = 0xC0;
+    PROFILE_LAP(PROFILE_STAGE_BUILD, cycles);
+
+    Send(OutArray, 8, 1);
+    PROFILE_LAP(PROFILE_STAGE_ENQUEUE, cycles);
+}
+
+void Transmit_Flush(void)
+{
+}
+
+#elif ACQ_PACKET_FORMAT == ACQ_PACKET_FORMAT_V2
+
+static Packet_V2 packet;
+
+void Transmit_Start(void)
+{
+    packet.seq = 0;
+    UartTx_Start();
+    Transmit_ResetStats();
+}
+
+void Transmit_SetOdr(uint8_t odr)
+{
+    odr_index = odr;
+}
+
+static void AddSample(const LIS3DH_Sample* sample, uint32_t timestamp)
+{
+    PROFILE_START(cycles);
+    uint8_t* frame = UartTx_Reserve();
+
+    PROFILE_LAP(PROFILE_STAGE_RESERVE, cycles);
+    packet.timestamp = timestamp;
+    packet.x = sample->x >> 4;
+    packet.y = sample->y >> 4;
+    packet.z = sample->z >> 4;
+    packet.odr = odr_index;
+    PROFILE_LAP(PROFILE_STAGE_CONVERT, cycles);
+    Packet_BuildV2(&packet, frame);
+    PROFILE_LAP(PROFILE_STAGE_BUILD, cycles);
+    Send(frame, PACKET_V2_LENGTH, 1);
+    PROFILE_LAP(PROFILE_STAGE_ENQUEUE, cycles);
+    packet.seq++;
+}
+
+void Transmit_Flush(void)
+{
+}
+
+#else
+
+#if ACQ_PACKET_FORMAT == ACQ_PACKET_FORMAT_RAW
+    // The output words go out as read: no shift, no packing
+    #define SAMPLE_SHIFT 0
+    #define FrameStart   Packet_RawStart
+    #define FrameAdd     Packet_RawAdd
+    #define FrameFinish  Packet_RawFinish
+    #define FrameLength  PACKET_RAW_LENGTH
+#else
+    // 12-bit outputs, right-justified
+    #define SAMPLE_SHIFT 4
+    #define FrameStart   Packet_BatchStart
+    #define FrameAdd     Packet_BatchAdd
+    #define FrameFinish  Packet_BatchFinish
+    #define FrameLength  PACKET_BATCH_LENGTH
+#endif
+
+// Bytes of a frame of count samples on the line
+#if ACQ_FRAMING == ACQ_FRAMING_COBS
+    #define LineLength(count) COBS_ENCODED_LENGTH(FrameLength(count))
+#else
+    #define LineLength(count) FrameLength(count)
+#endif
+
+// Frame being filled in its ring slot, sent when it holds batch_size samples
+static uint8_t* batch_frame;
+static uint8_t batch_count;
+static uint8_t batch_size;
+static uint16_t batch_seq;
+
+#if ACQ_PACKET_FORMAT == ACQ_PACKET_FORMAT_RAW
+
+static uint32_t descriptor_ms;
+
+// Range and sensitivity of the current data rate, for the receiver to
+// convert the words
+static void SendDescriptor(void)
+{
+    Packet_Descriptor descriptor;
+    const LIS3DH_Sensitivity* sensitivity;
+    uint8_t* frame = UartTx_Reserve();
+
+    descriptor.odr = odr_index;
+    descriptor.fs = LIS3DH_FULL_SCALE_SELECTED;
+    descriptor.g = LIS3DH_FullScaleTable[LIS3DH_FULL_SCALE_SELECTED].g;
+    descriptor.mode = LIS3DH_OdrMode(&LIS3DH_OdrTable[odr_index]);
+    sensitivity = &LIS3DH_SensitivityTable[LIS3DH_FULL_SCALE_SELECTED][descriptor.mode];
+    descriptor.shift = sensitivity->shift;
+    descriptor.mg_per_digit = sensitivity->mg_per_digit;
+    descriptor.mms2_q = sensitivity->mms2_q;
+    Packet_BuildDescriptor(&descriptor, frame);
+    UartTx_Commit(frame, PACKET_DESCRIPTOR_LENGTH);
+    descriptor_ms = Timebase_GetMs();
+}
+
+#endif
+
+void Transmit_Start(void)
+{
+    batch_count = 0;
+    batch_seq = 0;
+    batch_size = 1;
+    UartTx_Start();
+    Transmit_ResetStats();
+}
+
+void Transmit_SetOdr(uint8_t odr)
+{
+    Transmit_Flush();
+    odr_index = odr;
+#if ACQ_PACKET_FORMAT == ACQ_PACKET_FORMAT_RAW
+    SendDescriptor();
+#endif
+
+    // A batch must not span more than ACQ_PACKET_BATCH_MAX_MS
+    uint32_t size = (uint32_t)LIS3DH_OdrTable[odr].hz * ACQ_PACKET_BATCH_MAX_MS / 1000;
+    if (size > ACQ_PACKET_BATCH_SIZE)
+    {
+        size = ACQ_PACKET_BATCH_SIZE;
+    }
+#if !ACQ_UART_DMA && ACQ_MODE != ACQ_MODE_FIFO
+    // Hal_UartPutArray blocks the loop until the frame is in the TX FIFO,
+    // and a sample not read within its period is overwritten in the
+    // sensor: a frame must go out within one period (10 bits per byte)
+    while (size > 1 &&
+           (uint32_t)LineLength(size) * 10 * LIS3DH_OdrTable[odr].hz > ACQ_UART_BAUD_RATE)
+    {
+        size--;
+    }
+#endif
+    batch_size = size ? (uint8_t)size : 1;
+}
+
+static void AddSample(const LIS3DH_Sample* sample, uint32_t timestamp)
+{
+    PROFILE_START(cycles);
+    int16_t x, y, z;
+
+    x = sample->x >> SAMPLE_SHIFT;
+    y = sample->y >> SAMPLE_SHIFT;
+    z = sample->z >> SAMPLE_SHIFT;
+    PROFILE_LAP(PROFILE_STAGE_CONVERT, cycles);
+    if (batch_count == 0)
+    {
+#if ACQ_PACKET_FORMAT == ACQ_PACKET_FORMAT_RAW
+        if (Timebase_GetMs() - descriptor_ms >= ACQ_DESCRIPTOR_PERIOD_MS)
+        {
+            SendDescriptor();
+        }
+#endif
+        batch_frame = UartTx_Reserve();
+        PROFILE_LAP(PROFILE_STAGE_RESERVE, cycles);
+        FrameStart(batch_frame, batch_seq, timestamp, odr_index);
+    }
+    batch_count = FrameAdd(batch_frame, x, y, z);
+    PROFILE_LAP(PROFILE_STAGE_BUILD, cycles);
+    if (batch_count >= batch_size)
+    {
+        Transmit_Flush();
+    }
+}
+
+void Transmit_Flush(void)
+{
+    uint16_t length;
+
+    if (batch_count == 0)
+    {
+        return;
+    }
+    PROFILE_START(cycles);
+    length = FrameFinish(batch_frame);
+    PROFILE_LAP(PROFILE_STAGE_BUILD, cycles);
+    Send(batch_frame, length, batch_count);
+    PROFILE_LAP(PROFILE_STAGE_ENQUEUE, cycles);
+    batch_seq += batch_count;
+    batch_count = 0;
+}
+
+#endif
+
+void Transmit_Sample(const LIS3DH_Sample* sample, uint32_t timestamp)
+{
+#if ACQ_BENCHMARK
+    uint32_t start = Timebase_GetCycles();
+
+    AddSample(sample, timestamp);
+    stats.cycles += Timebase_GetCycles() - start;
+#else
+    AddSample(sample, timestamp);
+#endif
+}
+
+void Transmit_GetStats(Transmit_Stats* copy)
+{
+    *copy = stats;
+}
+
+void Transmit_ResetStats(void)
+{
+    stats.frames = 0;
+    stats.samples = 0;
+    stats.bytes = 0;
+    stats.cycles = 0;
+}
+
+/* [] END OF FILE */
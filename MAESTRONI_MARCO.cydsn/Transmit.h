@@ -0,0 +1,79 @@
+/**
+*   \file Transmit.h
+*   \brief Frames sent to the Bridge Control Panel or to the host decoder.
+*
+*   The samples are framed in the format selected by ACQ_PACKET_FORMAT
+*   and queued on the UART transmit ring (UartTx.h). In batch and raw
+*   formats they are accumulated and sent with one header every
+*   ACQ_PACKET_BATCH_SIZE samples; in raw format the descriptor frames
+*   are sent from here too.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __TRANSMIT_H
+    #define __TRANSMIT_H
+
+    #include "cytypes.h"
+    #include "AcquisitionConfig.h"
+    #include "LIS3DH_Driver.h"
+
+    /**
+    *   \brief Nibbles of sample data carried per sample by the frames.
+    */
+    #if ACQ_PACKET_FORMAT == ACQ_PACKET_FORMAT_V1 || ACQ_PACKET_FORMAT == ACQ_PACKET_FORMAT_RAW
+        #define TRANSMIT_PAYLOAD_NIBBLES 12
+    #else
+        #define TRANSMIT_PAYLOAD_NIBBLES 9
+    #endif
+
+    /**
+    *   \brief Transmit counters.
+    */
+    typedef struct {
+        uint32_t frames;    ///< Frames sent
+        uint32_t samples;   ///< Samples sent
+        uint32_t bytes;     ///< Bytes sent, headers included
+        uint32_t cycles;    ///< CPU clock cycles spent in Transmit_Sample, measured with ACQ_BENCHMARK only
+    } Transmit_Stats;
+
+    /**
+    *   \brief Start the transmit ring, reset the sequence number and the counters.
+    */
+    void Transmit_Start(void);
+
+    /**
+    *   \brief Select the data rate of the next samples.
+    *
+    *   A batch in progress is sent first, since a batch has one rate. In
+    *   raw format the descriptor of the new rate is sent next.
+    *   \param odr Index of the data rate in LIS3DH_OdrTable.
+    */
+    void Transmit_SetOdr(uint8_t odr);
+
+    /**
+    *   \brief Send a sample, or add it to the batch in progress.
+    *
+    *   \param sample Sample read from the LIS3DH.
+    *   \param timestamp Time of the sample in ms.
+    */
+    void Transmit_Sample(const LIS3DH_Sample* sample, uint32_t timestamp);
+
+    /**
+    *   \brief Send the batch in progress, if any.
+    */
+    void Transmit_Flush(void);
+
+    /**
+    *   \brief Copy the counters.
+    *   \param stats Pointer to the structure where the counters will be saved.
+    */
+    void Transmit_GetStats(Transmit_Stats* stats);
+
+    /**
+    *   \brief Reset the counters to zero.
+    */
+    void Transmit_ResetStats(void);
+
+#endif
+/* [] END OF FILE */
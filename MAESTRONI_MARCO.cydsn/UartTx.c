@@ -0,0 +1,183 @@
+/*
+* MARCO MAESTRONI
+*
+* Transmit ring of pre-allocated UART frames
+*/
+
+#include "UartTx.h"
+#include "Hal.h"
+
+#if ACQ_UART_TX_FRAMES < 2 || ACQ_UART_TX_FRAMES > 32
+    #error "ACQ_UART_TX_FRAMES must be between 2 and 32"
+#endif
+
+#if ACQ_FRAMING == ACQ_FRAMING_COBS
+    #if UART_TX_FRAME_SIZE > COBS_MAX_LENGTH
+        #error "The frames are too long to be COBS-encoded in place"
+    #endif
+    // The frame is built after the code byte of its encoding
+    #define FRAME_OFFSET COBS_OFFSET
+#else
+    #define FRAME_OFFSET 0
+#endif
+
+static uint8_t slots[ACQ_UART_TX_FRAMES][UART_TX_SLOT_SIZE];
+// Bit i set: slot i can be reserved. Given back by the DMA done ISR
+static volatile uint32_t free_slots;
+static uint32_t stalls;
+
+// Encode the frame in its slot: returns the bytes to send from the start
+// of the slot
+static uint16_t Encode(uint8_t* frame, uint16_t length)
+{
+#if ACQ_FRAMING == ACQ_FRAMING_COBS
+    return Cobs_Encode(frame - FRAME_OFFSET, length);
+#else
+    (void)frame;
+    return length;
+#endif
+}
+
+// End the strings sent before the first frame
+static void Delimit(void)
+{
+#if ACQ_FRAMING == ACQ_FRAMING_COBS
+    static const uint8_t delimiter = COBS_DELIMITER;
+    Hal_UartPutArray(&delimiter, 1);
+#endif
+}
+
+#if ACQ_UART_DMA
+
+// The DMA channel is only available on the PSoC
+#include "project.h"
+
+// Queued slots and lengths, the one being sent at queue_tail
+static uint8_t queue[ACQ_UART_TX_FRAMES];
+static uint16_t lengths[ACQ_UART_TX_FRAMES];
+static uint8_t queue_head;
+static volatile uint8_t queue_tail;
+static volatile uint8_t queued;
+
+static uint8_t channel;
+static uint8_t td;
+
+// One byte per "TX FIFO not full" request, nrq raised at the end
+static void StartTransfer(uint8_t slot, uint16_t length)
+{
+    CyDmaChSetExtendedAddress(channel, HI16((uint32)slots[slot]), HI16((uint32)UART_Debug_TXDATA_PTR));
+    CyDmaTdSetConfiguration(td, length, CY_DMA_DISABLE_TD,
+                            CY_DMA_TD_INC_SRC_ADR | DMA_UartTx__TD_TERMOUT_EN);
+    CyDmaTdSetAddress(td, LO16((uint32)slots[slot]), LO16((uint32)UART_Debug_TXDATA_PTR));
+    CyDmaChSetInitialTd(channel, td);
+    CyDmaChEnable(channel, 1);
+}
+
+// The frame at queue_tail has been copied into the TX FIFO: free its
+// slot and start the next one
+static CY_ISR(UartTx_Done)
+{
+    free_slots |= (uint32_t)1 << queue[queue_tail];
+    queue_tail = (queue_tail + 1) % ACQ_UART_TX_FRAMES;
+    queued--;
+    if (queued)
+    {
+        StartTransfer(queue[queue_tail], lengths[queue_tail]);
+    }
+}
+
+void UartTx_Start(void)
+{
+    Delimit();
+    channel = DMA_UartTx_DmaInitialize(1, 1, HI16(CYDEV_SRAM_BASE), HI16(CYDEV_PERIPH_BASE));
+    td = CyDmaTdAllocate();
+    queue_head = 0;
+    queue_tail = 0;
+    queued = 0;
+    free_slots = ((uint32_t)1 << (ACQ_UART_TX_FRAMES - 1) << 1) - 1;
+    stalls = 0;
+    isr_UartTxDone_StartEx(UartTx_Done);
+}
+
+void UartTx_Commit(uint8_t* frame, uint16_t length)
+{
+    uint8_t slot = (uint8_t)((frame - slots[0]) / UART_TX_SLOT_SIZE);
+    uint8_t interrupts;
+
+    length = Encode(frame, length);
+    interrupts = Hal_EnterCritical();
+
+    queue[queue_head] = slot;
+    lengths[queue_head] = length;
+    queue_head = (queue_head + 1) % ACQ_UART_TX_FRAMES;
+    queued++;
+    // The channel is idle: nothing else would start this frame
+    if (queued == 1)
+    {
+        StartTransfer(slot, length);
+    }
+    Hal_ExitCritical(interrupts);
+}
+
+#else
+
+void UartTx_Start(void)
+{
+    Delimit();
+    free_slots = ((uint32_t)1 << (ACQ_UART_TX_FRAMES - 1) << 1) - 1;
+    stalls = 0;
+}
+
+void UartTx_Commit(uint8_t* frame, uint16_t length)
+{
+    uint8_t slot = (uint8_t)((frame - slots[0]) / UART_TX_SLOT_SIZE);
+
+    Hal_UartPutArray(slots[slot], Encode(frame, length));
+    free_slots |= (uint32_t)1 << slot;
+}
+
+#endif
+
+uint8_t* UartTx_Reserve(void)
+{
+    uint8_t slot = 0;
+    uint8_t interrupts;
+
+    if (free_slots == 0)
+    {
+        stalls++;
+        while (free_slots == 0)
+        {
+        }
+    }
+
+    interrupts = Hal_EnterCritical();
+    while (!(free_slots & ((uint32_t)1 << slot)))
+    {
+        slot++;
+    }
+    free_slots &= ~((uint32_t)1 << slot);
+    Hal_ExitCritical(interrupts);
+
+    return slots[slot] + FRAME_OFFSET;
+}
+
+void UartTx_PutString(const char* string)
+{
+    uint8_t* frame = UartTx_Reserve();
+    uint16_t length = 0;
+
+    while (string[length] != '\0' && length < UART_TX_FRAME_SIZE)
+    {
+        frame[length] = (uint8_t)string[length];
+        length++;
+    }
+    UartTx_Commit(frame, length);
+}
+
+uint32_t UartTx_Stalls(void)
+{
+    return stalls;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,83 @@
+/**
+*   \file UartTx.h
+*   \brief Transmit ring of pre-allocated UART frames.
+*
+*   A frame is written in place into a slot taken from the ring and then
+*   queued: only its pointer and length are enqueued. With ACQ_UART_DMA
+*   the queued frames are sent one after the other by the DMA_UartTx
+*   channel, and the slot is given back when its transfer completes;
+*   otherwise the frame is copied into the UART buffer (Hal_UartPutArray)
+*   when queued.
+*
+*   With ACQ_FRAMING_COBS every frame is encoded in its slot when queued
+*   and followed by the delimiter; one delimiter is also sent at start,
+*   to end the strings sent before.
+*
+*   \author Marco Maestroni
+*/
+
+#ifndef __UART_TX_H
+    #define __UART_TX_H
+
+    #include "cytypes.h"
+    #include "AcquisitionConfig.h"
+    #include "Packet.h"
+    #include "Cobs.h"
+
+    /**
+    *   \brief Bytes of a frame that fit a slot: the longest batch or raw frame.
+    */
+    #if ACQ_PACKET_FORMAT == ACQ_PACKET_FORMAT_RAW
+        #define UART_TX_FRAME_SIZE PACKET_RAW_LENGTH(PACKET_BATCH_MAX)
+    #else
+        #define UART_TX_FRAME_SIZE PACKET_BATCH_LENGTH(PACKET_BATCH_MAX)
+    #endif
+
+    /**
+    *   \brief Size in bytes of a slot, framing included.
+    */
+    #if ACQ_FRAMING == ACQ_FRAMING_COBS
+        #define UART_TX_SLOT_SIZE COBS_ENCODED_LENGTH(UART_TX_FRAME_SIZE)
+    #else
+        #define UART_TX_SLOT_SIZE UART_TX_FRAME_SIZE
+    #endif
+
+    /**
+    *   \brief Start the DMA channel, if used, and free all the slots.
+    */
+    void UartTx_Start(void);
+
+    /**
+    *   \brief Take a free slot for a frame of up to UART_TX_FRAME_SIZE bytes.
+    *
+    *   Waits for a transfer to complete if all the slots are in use.
+    *   More than one slot can be taken before queueing them.
+    *   \return Pointer to the slot.
+    */
+    uint8_t* UartTx_Reserve(void);
+
+    /**
+    *   \brief Queue a slot taken with UartTx_Reserve.
+    *
+    *   The frames are sent in the order they are queued.
+    *   \param frame Pointer to the slot.
+    *   \param length Number of bytes to send.
+    */
+    void UartTx_Commit(uint8_t* frame, uint16_t length);
+
+    /**
+    *   \brief Queue a string, truncated to UART_TX_FRAME_SIZE characters.
+    *
+    *   To be used instead of Hal_UartPutString once the frames are sent
+    *   through the ring, so that the strings do not break into a frame.
+    *   \param string String to send.
+    */
+    void UartTx_PutString(const char* string);
+
+    /**
+    *   \brief Number of times UartTx_Reserve had to wait for a free slot.
+    */
+    uint32_t UartTx_Stalls(void);
+
+#endif
+/* [] END OF FILE */
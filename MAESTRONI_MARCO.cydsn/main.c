@@ -12,477 +12,348 @@
 // Include required header files
 #include "InterruptRoutines.h"
 #include "I2C_Interface.h"
-#include "project.h"
+#include "LIS3DH_Driver.h"
+#include "LIS3DH_Fifo.h"
+#include "LIS3DH_Odr.h"
+#include "AcquisitionConfig.h"
+#include "I2C_BusProfile.h"
+#include "Benchmark.h"
+#include "Profile.h"
+#include "Health.h"
+#include "Power.h"
+#include "Timebase.h"
+#include "Button.h"
+#include "ConfigStore.h"
+#include "Transmit.h"
+#include "Hal.h"
 #include "stdio.h"
 
 
-/**
-*   \brief 7-bit I2C address of the slave device.
-*   SDO connected to ground
-*/
-#define LIS3DH_DEVICE_ADDRESS 0x18
-
-/**
-*   \brief Address of the WHO AM I register
-*/
-#define LIS3DH_WHO_AM_I_REG_ADDR 0x0F
-
-/**
-*   \brief Address of the Status register
-*/
-#define LIS3DH_STATUS_REG 0x27
-
-//new data available in status register (bit 5)
-#define LIS3DH_STATUS_REG_NEW_DATA  0x08
-
-/**
-*   \brief Address of the Control register 1
-*/
-#define LIS3DH_CTRL_REG1 0x20
-
-/**
-*   \brief Address of the Control register 4
-*/
-#define LIS3DH_CTRL_REG4 0x23
-
-/**
-*   \ Address of HIGH RESOLUTION MODE in control registers
-*/
-#define LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG1 0x07
-#define LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG4 0x08 
-
-//address of different frequencies in control register 1
-
-#define LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG1_FREQ_1_HZ    0x17
-#define LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG1_FREQ_10_HZ   0x27
-#define LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG1_FREQ_25_HZ   0x37
-#define LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG1_FREQ_50_HZ   0x47
-#define LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG1_FREQ_100_HZ  0x57
-#define LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG1_FREQ_200_HZ  0x67
-
-
-/**
-*   \brief Address of the Control register 4
-*/
-#define LIS3DH_CTRL_REG4 0x23
-
-/**
-*   \brief Address of the X,Y and Z output LSB register
-*/
-#define LIS3DH_OUT_X_L 0x28
-#define LIS3DH_OUT_Y_L 0x2A
-#define LIS3DH_OUT_Z_L 0x2C
-
-
-// EEPROM startup register
-
-#define EEPROM_STARTUP_ADDRESS   0x00
-
-//define states
-#define FREQ_1_HZ          1
-#define FREQ_10_HZ         2
-#define FREQ_25_HZ         3
-#define FREQ_50_HZ         4
-#define FREQ_100_HZ        5
-#define FREQ_200_HZ        6
-
 //init variables
-int state=1;
-int newstate=1;
+//state and newstate are indexes of LIS3DH_OdrTable: state is the rate the
+//sensor is configured at (-1 before the first configuration), newstate the
+//one selected with the push button. Both are only used by the main loop:
+//the button events reach it through the queue of Button.h
+static int state=-1;
+static int newstate=0;
+//first read done without waiting: INT1 could already be high at startup
+volatile uint8_t data_ready=1;
 
 int main(void)
 {
-    CyGlobalIntEnable; /* Enable global interrupts. */
+    Hal_InterruptsEnable(); /* Enable global interrupts. */
 
-    isr_Button_StartEx(ChangeFreq);
+    //started first: the boot time is measured from here
+    Timebase_Start();
+    Button_Start();
     I2C_Peripheral_Start();
-    UART_Debug_Start();
-    EEPROM_Start();
+    Hal_UartStart();
+    
+    //configuration saved in the EEPROM (startup register)
+    ConfigStore_Config config;
            
     // String to print out messages on the UART
-    char message[50] = {'\0'};
+    char message[80] = {'\0'};
+    
+    //I2C bus speed profile and maximum ODR it can sustain
+    const I2C_BusProfile* bus_profile = I2C_BusProfile_Selected();
+    sprintf(message, "I2C bus at %d kHz: max ODR %u Hz single, %u Hz FIFO\r\n",
+            bus_profile->speed_khz, bus_profile->single_max_odr, bus_profile->fifo_max_odr);
+    Hal_UartPutString(message);
     
     //-------------------------------------------------------
     //set registers
     // ----------------------------------------------
-    //set HIGH RESOLUTION MODE 
+    //the sensor is brought up directly at the rate of the startup register,
+    //if it is one of the rates of the ODR table, otherwise at the slowest one.
+    //The firmware before the configuration store saved CTRL_REG1 as a single
+    //byte at the startup address: it is still accepted
+    int8_t stored_odr = -1;
+    
+    if (ConfigStore_Start(&config) == NO_ERROR)
+    {
+        stored_odr = LIS3DH_OdrFind(config.ctrl_reg1);
+    }
+    else
+    {
+        stored_odr = LIS3DH_OdrFind(ConfigStore_LegacyStartupRegister());
+    }
+    newstate = stored_odr >= 0 ? stored_odr : 0;
+    
+    //CTRL_REG1 and CTRL_REG4: data rate, operating mode (low-power at the
+    //low-power rates, HIGH RESOLUTION or normal at the others) and full-scale
+    //range ACQ_FULL_SCALE_G (LIS3DH_Convert.h)
+    const LIS3DH_OdrDescriptor* startup_odr = &LIS3DH_OdrTable[newstate];
     
-    //CTRL_REG1
-    uint8_t ctrl_reg1; 
+    ErrorCode error = LIS3DH_SetOdr(startup_odr);
     
-    //I set ODR[3:0]=0000 because I will set the data rate later based on the cycling of states of the switch button
-    ctrl_reg1=LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG1;
+    if (error == NO_ERROR)
+    {
+        state = newstate;
+        //the record is rewritten only if it was missing or invalid
+        config.ctrl_reg1 = startup_odr->ctrl_reg1;
+        ConfigStore_Save(&config);
+        
+        sprintf(message, "Startup rate %u Hz (%s), CONTROL REGISTER 1: 0x%02X\r\n",
+                startup_odr->hz, stored_odr >= 0 ? "EEPROM" : "default", startup_odr->ctrl_reg1);
+        Hal_UartPutString(message); 
+    }
+    else
+    {
+        //state stays -1: the main loop tries again
+        Hal_UartPutString("Error occurred during I2C comm to set control registers 1 and 4\r\n");   
+    }
+    //------------------------------------------------------------------------------
     
-    ErrorCode error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
-                                                   LIS3DH_CTRL_REG1,
-                                                   ctrl_reg1);
+#if ACQ_MODE == ACQ_MODE_FIFO
+    //FIFO in stream mode, watermark interrupt routed on INT1
+    error = LIS3DH_FifoStart(ACQ_FIFO_WATERMARK, 1);
     
     if (error == NO_ERROR)
     {
-        sprintf(message, "CONTROL REGISTER 1 successfully written as: 0x%02X\r\n", ctrl_reg1);
-        UART_Debug_PutString(message); 
+        sprintf(message, "FIFO enabled with watermark: %d\r\n", ACQ_FIFO_WATERMARK);
+        Hal_UartPutString(message); 
     }
     else
     {
-        UART_Debug_PutString("Error occurred during I2C comm to set control register 1\r\n");   
+        Hal_UartPutString("Error occurred during I2C comm to enable the FIFO\r\n");   
     }
     
-    //------------------------------------------------------------------------------------
-    //CTRL_REG4
-    //FS=+-2g (seen in datasheet "mechanical characteristhics")
-    uint8_t ctrl_reg4;
+    Hal_DataReadyStart(DataReady);
+    //------------------------------------------------------------------------------
+#elif ACQ_MODE == ACQ_MODE_DATA_READY
+    //CTRL_REG3
+    //route the data-ready signal (ZYXDA) on INT1 to wake up the main loop
+    uint8_t ctrl_reg3;
     
-    ctrl_reg4=LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG4;
+    ctrl_reg3=LIS3DH_CTRL_REG3_I1_ZYXDA;
     
     error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
-                                              LIS3DH_CTRL_REG4,
-                                                    ctrl_reg4);
+                                              LIS3DH_CTRL_REG3,
+                                                    ctrl_reg3);
     
     if (error == NO_ERROR)
     {
-        sprintf(message, "CONTROL REGISTER 4 successfully written as: 0x%02X\r\n", ctrl_reg4);
-        UART_Debug_PutString(message); 
+        sprintf(message, "CONTROL REGISTER 3 successfully written as: 0x%02X\r\n", ctrl_reg3);
+        Hal_UartPutString(message); 
     }
     else
     {
-        UART_Debug_PutString("Error occurred during I2C comm to set control register 4\r\n");   
+        Hal_UartPutString("Error occurred during I2C comm to set control register 3\r\n");   
     }
-    //------------------------------------------------------------------------------
     
+    Hal_DataReadyStart(DataReady);
+    //------------------------------------------------------------------------------
+#endif
     
     //CyDelay(5); //"The boot procedure is complete about 5 milliseconds after device power-up."
       
     
-    uint8_t header = 0xA0;
-    uint8_t footer = 0xC0;
-    uint8_t OutArray [8];
-    OutArray[0] = header;
-    OutArray[7] = footer;
-    //since the sensitivity is set to 1 mg/digit
-    //because FS=+-2g (seen in datasheet "mechanical characteristhics"), we have:
-    //
-    //    1 digit= 1 mg= 9.8 * 10^-3 m/s^2  
-    //
-    //we set the conversion factor in the following way:
-    float conversion = 0.00981; //9.8 * 10^-3
-    int dirtytrick = 1000; // in order to send int values to rescale in BCP
-    
-    float XDataOutConv;
-    float YDataOutConv;
-    float ZDataOutConv;
-      
-    uint8_t XData[2];
-    uint8_t YData[2];
-    uint8_t ZData[2];
+    //frames in the format selected by ACQ_PACKET_FORMAT (Transmit.h)
+    Transmit_Start();
+    //overrun and stale read counters, sent in the health frames
+    Health_Start();
+    if (state >= 0)
+    {
+        Transmit_SetOdr((uint8_t)state);
+        Health_SetOdr((uint8_t)state);
+    }
     
-    int16 XDataOut=0;
-    int16 YDataOut=0;
-    int16 ZDataOut=0;
+    //samples read in this loop pass: one (status register and the 3 axis,
+    //read together in one I2C burst) or the whole FIFO content
+    LIS3DH_Sample samples[LIS3DH_FIFO_DEPTH];
+    uint8_t count=0;
+    uint8_t i;
+#if ACQ_MODE == ACQ_MODE_FIFO
+    uint8_t fifo_src;
+#endif
+    //time (ms) at which the samples were read
+    uint32_t read_ms=0;
     
-    //at startup I read the address of the EEPROM where it's stored the address of the control register 1 setting the frequency.
-    //I do not set any frequency here because anyway I'll enter in a if condition later that sets the frequency.
+    //at startup the frequency has already been set from the EEPROM startup register:
+    //the if condition below only runs again when the push button selects another one
 
 
+#if ACQ_BENCHMARK
+    Benchmark_Start();
+#endif
+#if ACQ_PROFILE
+    Profile_Start();
+#endif
+
     for(;;)
     {
+#if ACQ_BENCHMARK
+        //report samples/s and bus utilisation once per second
+        Benchmark_Task();
+#endif
+#if ACQ_PROFILE
+        //send the cycles spent in each stage every ACQ_PROFILE_PERIOD_MS
+        Profile_Task();
+#endif
+#if ACQ_HEALTH_PERIOD_MS
+        //send the loss counters every ACQ_HEALTH_PERIOD_MS
+        Health_Task();
+#endif
         //CyDelay(100);
         
-        //based on the frequency set by the switch,
-        //I set the right frequency in control register and I update the value of the EEPROM
-        
-        if(newstate==FREQ_1_HZ)
+        //a press selects the next rate of the ODR table, a long press the
+        //previous one; both wrap around
+        Button_Event event;
+        while ((event = Button_GetEvent()) != BUTTON_EVENT_NONE)
         {
-            state=FREQ_1_HZ;
-            //CHECK -- UART_Debug_PutString("Sampling frequency: 1 Hz \r\n");
+            uint8_t rates = LIS3DH_OdrCycleLength();
             
-            //write the specified address in the EEPROM startup address
-            EEPROM_UpdateTemperature();
-            EEPROM_WriteByte(LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG1_FREQ_1_HZ,
-                                                     EEPROM_STARTUP_ADDRESS);
-            //read the specified address in the EEPROM startup address,
-            //and write it on control register 1 to set the frequency
-            ctrl_reg1=EEPROM_ReadByte(EEPROM_STARTUP_ADDRESS);
-       
-            error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
-                                                      LIS3DH_CTRL_REG1,
-                                                            ctrl_reg1);
-            /*---CHECK ---
-            if (error == NO_ERROR)
+            if (event == BUTTON_EVENT_PRESS)
             {
-                sprintf(message, "CONTROL REGISTER 1 successfully written as: 0x%02X\r\n", ctrl_reg1);
-                UART_Debug_PutString(message); 
+                newstate = (newstate + 1) % rates;
             }
             else
             {
-                UART_Debug_PutString("Error occurred during I2C comm to set control register 1\r\n");   
-            }  
-            ---------*/
-        }
-        
-        if(newstate==FREQ_10_HZ)
-        {
-            state=FREQ_10_HZ;
-            //CHECK -- UART_Debug_PutString("Sampling frequency: 10 Hz \r\n");
-            
-            //write the specified address in the EEPROM startup address
-            EEPROM_UpdateTemperature();
-            EEPROM_WriteByte(LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG1_FREQ_10_HZ,
-                                                     EEPROM_STARTUP_ADDRESS);
-            //read the specified address in the EEPROM startup address,
-            //and write it on control register 1 to set the frequency
-            ctrl_reg1=EEPROM_ReadByte(EEPROM_STARTUP_ADDRESS);
-       
-            error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
-                                                      LIS3DH_CTRL_REG1,
-                                                            ctrl_reg1);
-            /*---CHECK ---
-            if (error == NO_ERROR)
-            {
-                sprintf(message, "CONTROL REGISTER 1 successfully written as: 0x%02X\r\n", ctrl_reg1);
-                UART_Debug_PutString(message); 
+                newstate = (newstate + rates - 1) % rates;
             }
-            else
-            {
-                UART_Debug_PutString("Error occurred during I2C comm to set control register 1\r\n");   
-            }  
-            ---------*/
         }
         
-        if(newstate==FREQ_25_HZ)
-        {
-            state=FREQ_25_HZ;
-            //CHECK -- UART_Debug_PutString("Sampling frequency: 25 Hz \r\n");
-            
-            //write the specified address in the EEPROM startup address
-            EEPROM_UpdateTemperature();
-            EEPROM_WriteByte(LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG1_FREQ_25_HZ,
-                                                     EEPROM_STARTUP_ADDRESS);
-            //read the specified address in the EEPROM startup address,
-            //and write it on control register 1 to set the frequency
-            ctrl_reg1=EEPROM_ReadByte(EEPROM_STARTUP_ADDRESS);
-       
-            error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
-                                                      LIS3DH_CTRL_REG1,
-                                                            ctrl_reg1);
-            /*---CHECK ---
-            if (error == NO_ERROR)
-            {
-                sprintf(message, "CONTROL REGISTER 1 successfully written as: 0x%02X\r\n", ctrl_reg1);
-                UART_Debug_PutString(message); 
-            }
-            else
-            {
-                UART_Debug_PutString("Error occurred during I2C comm to set control register 1\r\n");   
-            }  
-            ---------*/
-        }
+        //based on the frequency set by the switch, I set the right frequency
+        //in the control registers and I update the value of the EEPROM.
+        //This is done only when the state changes, and only once the sensor
+        //took the new rate: after an I2C error state is left as it is and
+        //the next pass tries again
         
-        if(newstate==FREQ_50_HZ)
+        if(newstate!=state)
         {
-            state=FREQ_50_HZ;
-            //CHECK -- UART_Debug_PutString("Sampling frequency: 50 Hz \r\n");
+            const LIS3DH_OdrDescriptor* odr = &LIS3DH_OdrTable[newstate];
             
-            //write the specified address in the EEPROM startup address
-            EEPROM_UpdateTemperature();
-            EEPROM_WriteByte(LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG1_FREQ_50_HZ,
-                                                     EEPROM_STARTUP_ADDRESS);
-            //read the specified address in the EEPROM startup address,
-            //and write it on control register 1 to set the frequency
-            ctrl_reg1=EEPROM_ReadByte(EEPROM_STARTUP_ADDRESS);
-       
-            error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
-                                                      LIS3DH_CTRL_REG1,
-                                                            ctrl_reg1);
-            /*---CHECK ---
+            //write control registers 1 and 4 to set the frequency
+            error = LIS3DH_SetOdr(odr);
             if (error == NO_ERROR)
             {
-                sprintf(message, "CONTROL REGISTER 1 successfully written as: 0x%02X\r\n", ctrl_reg1);
-                UART_Debug_PutString(message); 
+                state=newstate;
+                
+                //save the control register 1 value in the EEPROM startup register:
+                //the record is written in the background (ConfigStore_Task) and
+                //only if the value changed
+                config.ctrl_reg1 = odr->ctrl_reg1;
+                ConfigStore_Save(&config);
+                
+                Transmit_SetOdr((uint8_t)state);
+                Health_SetOdr((uint8_t)state);
             }
             else
             {
-                UART_Debug_PutString("Error occurred during I2C comm to set control register 1\r\n");   
-            }  
-            ---------*/
+                Health_ReadError();
+            }
         }
         
-        if(newstate==FREQ_100_HZ)
+        //complete the EEPROM write started above, if any
+        ConfigStore_Task();
+        
+#if ACQ_MODE != ACQ_MODE_POLLING
+        //sleep until the LIS3DH flags new data on INT1.
+        //Interrupts are masked while checking the flag so that an INT1 edge
+        //cannot be lost between the check and the WFI (a pending interrupt
+        //wakes up the core even when masked).
+        //With ACQ_LOW_POWER the millisecond tick is stopped while sleeping,
+        //except while an EEPROM write has to be polled or the push button
+        //is sampled on the tick
+        Hal_InterruptsDisable();
+        if(!data_ready)
         {
-            state=FREQ_100_HZ;
-            //CHECK -- UART_Debug_PutString("Sampling frequency: 100 Hz \r\n");
-            
-            //write the specified address in the EEPROM startup address
-            EEPROM_UpdateTemperature();
-            EEPROM_WriteByte(LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG1_FREQ_100_HZ,
-                                                     EEPROM_STARTUP_ADDRESS);
-            //read the specified address in the EEPROM startup address,
-            //and write it on control register 1 to set the frequency
-            ctrl_reg1=EEPROM_ReadByte(EEPROM_STARTUP_ADDRESS);
-       
-            error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
-                                                      LIS3DH_CTRL_REG1,
-                                                            ctrl_reg1);
-            /*---CHECK ---
-            if (error == NO_ERROR)
-            {
-                sprintf(message, "CONTROL REGISTER 1 successfully written as: 0x%02X\r\n", ctrl_reg1);
-                UART_Debug_PutString(message); 
-            }
-            else
-            {
-                UART_Debug_PutString("Error occurred during I2C comm to set control register 1\r\n");   
-            }  
-            ---------*/
+            Power_Sleep((ConfigStore_Busy() || Button_Busy()) ? 1 : ACQ_LOW_POWER_MAX_SLEEP_MS);
         }
+        Hal_InterruptsEnable();
         
-        if(newstate==FREQ_200_HZ)
+        if(!data_ready)
         {
-            state=FREQ_200_HZ;
-            //CHECK -- UART_Debug_PutString("Sampling frequency: 200 Hz \r\n");
-            
-            //write the specified address in the EEPROM startup address
-            EEPROM_UpdateTemperature();
-            EEPROM_WriteByte(LIS3DH_HIGH_RESOLUTION_MODE_CTRL_REG1_FREQ_200_HZ,
-                                                     EEPROM_STARTUP_ADDRESS);
-            //read the specified address in the EEPROM startup address,
-            //and write it on control register 1 to set the frequency
-            ctrl_reg1=EEPROM_ReadByte(EEPROM_STARTUP_ADDRESS);
-       
-            error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
-                                                      LIS3DH_CTRL_REG1,
-                                                            ctrl_reg1);
-            /*---CHECK ---
-            if (error == NO_ERROR)
-            {
-                sprintf(message, "CONTROL REGISTER 1 successfully written as: 0x%02X\r\n", ctrl_reg1);
-                UART_Debug_PutString(message); 
-            }
-            else
-            {
-                UART_Debug_PutString("Error occurred during I2C comm to set control register 1\r\n");   
-            }  
-            ---------*/
+            //woken up by another interrupt source
+            continue;
         }
+        data_ready=0;
+#endif
         
-        //I read the registers where the output (12 bit)of the accelerometer is stored
-        
-        //XData read
-        
-        error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS,
-                                                        LIS3DH_OUT_X_L,
-                                                                     2,
-                                                                XData);
+#if ACQ_MODE == ACQ_MODE_FIFO
+        //read all the samples stored in the FIFO with one burst of 6xN bytes
+        PROFILE_START(read_cycles);
+        error = LIS3DH_FifoDrain(samples, LIS3DH_FIFO_DEPTH, &count, &fifo_src);
+        PROFILE_LAP(PROFILE_STAGE_I2C_READ, read_cycles);
+        read_ms = Timebase_GetMs();
         
+        //a full FIFO means the oldest samples are being overwritten
         if (error == NO_ERROR)
         {
-            /*--CHECK --
-            sprintf(message, "XData is: %s\r\n", XData);
-            UART_Debug_PutString(message); 
-            ----*/
-            
-            //XDataOut is 12 bit long
-            XDataOut = (int16)((XData[0] | (XData[1]<<8)))>>4;
-            XDataOutConv = XDataOut * conversion;
-        
-            XDataOut = (int16) (XDataOutConv * dirtytrick);   
+            Health_Fifo(fifo_src, count);
         }
         else
         {
-            //UART_Debug_PutString("Error");   
-        }  
-        
+            Health_ReadError();
+        }
         
-        //YData read
-        error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS,
-                                                        LIS3DH_OUT_Y_L,
-                                                                     2,
-                                                                YData);
+        //if new samples reached the watermark while draining, INT1 stays high
+        //and no new edge would wake up the loop: drain again right away
+        if (error != NO_ERROR || count >= ACQ_FIFO_WATERMARK)
+        {
+            data_ready=1;
+        }
+#elif ACQ_I2C_ASYNC
+        //the next sample goes on the wire while the previous one (read in the
+        //last loop pass) is converted and sent over UART below.
+        //If the transfer cannot be started it is read synchronously after
+        //the transmission, below: the failure is counted only if that read
+        //fails too
+        error = LIS3DH_ReadSampleStart();
+#else
+        //I read the status register and the registers where the output (12 bit)
+        //of the accelerometer is stored with a single auto-increment burst
+        //(STATUS_REG ... OUT_Z_H) instead of four separate I2C transactions
         
+        PROFILE_START(read_cycles);
+        error = LIS3DH_ReadSample(&samples[0]);
+        PROFILE_LAP(PROFILE_STAGE_I2C_READ, read_cycles);
+        read_ms = Timebase_GetMs();
         
+        //every packet must carry unique data: a sample is sent only if the
+        //status register (read in the same burst) flags a new set of X, Y, Z.
+        //Its overrun flags tell if samples were overwritten before this read
         if (error == NO_ERROR)
         {
-            /*---CHECK ---
-            sprintf(message, "YData is: %s\r\n", YData);
-            UART_Debug_PutString(message); 
-            ---------*/
-            //YDataOut is 12 bit long
-            YDataOut = (int16)((YData[0] | (YData[1]<<8)))>>4;
-            YDataOutConv = YDataOut * conversion;
-        
-            YDataOut = (int16) (YDataOutConv * dirtytrick);
+            Health_Status(samples[0].status);
         }
         else
         {
-            //UART_Debug_PutString("Error");   
-        }  
-        
-        
-        //ZData read
-        error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS,
-                                                        LIS3DH_OUT_Z_L,
-                                                                     2,
-                                                                ZData);
-        
+            Health_ReadError();
+        }
+        count = (error == NO_ERROR && (samples[0].status & LIS3DH_STATUS_REG_NEW_DATA)) ? 1 : 0;
+#endif
         
-        if (error == NO_ERROR)
+        for(i=0; i<count; i++)
         {
-            /*---CHECK ---
-            sprintf(message, "ZData is: %s\r\n", ZData);
-            UART_Debug_PutString(message);
-            ---------*/
-            //ZDataOut is 12 bit long
-            ZDataOut = (int16)((ZData[0] | (ZData[1]<<8)))>>4;
-            ZDataOutConv = ZDataOut * conversion;
-        
-            ZDataOut = (int16) (ZDataOutConv * dirtytrick);
-       
+            //the samples of a FIFO burst are back-dated by one sample period
+            //each from the time of the read, the newest being the last one
+            Transmit_Sample(&samples[i],
+                            read_ms - (uint32_t)(count - 1 - i) * LIS3DH_OdrTable[state].period_us / 1000);
         }
-        else
-        {
-            //UART_Debug_PutString("Error");   
-        }  
+#if ACQ_BENCHMARK
+        Benchmark_SamplesSent(count);
+#endif
         
-        //read of the status register to see if a set of new data is available
-        //STATUS_REG
-        uint8_t status_reg;  
-    
-        error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                                LIS3DH_STATUS_REG,
-                                                     &status_reg);
-    
-        /*--CHECK---
+#if ACQ_MODE != ACQ_MODE_FIFO && ACQ_I2C_ASYNC
+        //collect the sample read while transmitting, it is sent in the next pass:
+        //only the time still to wait for the transfer is profiled
+        PROFILE_START(read_cycles);
+        error = (error == NO_ERROR) ? LIS3DH_ReadSampleWait(&samples[0])
+                                    : LIS3DH_ReadSample(&samples[0]);
+        PROFILE_LAP(PROFILE_STAGE_I2C_READ, read_cycles);
+        read_ms = Timebase_GetMs();
         if (error == NO_ERROR)
         {
-            sprintf(message, "STATUS REGISTER 0x%02X\r\n", status_reg);
-            UART_Debug_PutString(message); 
+            Health_Status(samples[0].status);
         }
         else
         {
-            UART_Debug_PutString("Error\r\n");   
+            Health_ReadError();
         }
-        ----*/
-        
-        //------------------
-        //if(status_reg & LIS3DH_STATUS_REG_NEW_DATA)
-        //{
-            //put together the array of X,Y and Z data to send to BCP
-            OutArray[1] = (uint8_t)(XDataOut & 0xFF);
-            OutArray[2] = (uint8_t)(XDataOut >> 8);
-            
-            OutArray[3] = (uint8_t)(YDataOut & 0xFF);
-            OutArray[4] = (uint8_t)(YDataOut >> 8);
-            
-            OutArray[5] = (uint8_t)(ZDataOut & 0xFF);
-            OutArray[6] = (uint8_t)(ZDataOut >> 8);
-            
-       
-            UART_Debug_PutArray(OutArray, 8);  
-        //}
-        //else
-        //{
-            //UART_Debug_PutString("no new data available\r\n"); 
-            //UART_Debug_PutArray(OutArrayOld, 8);  
-        //}
+        count = (error == NO_ERROR && (samples[0].status & LIS3DH_STATUS_REG_NEW_DATA)) ? 1 : 0;
+#endif
     }
 }
 